@@ -0,0 +1,202 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Replay of a capture file.
+ *
+ * The packets of a pcap file are read by a pcap_reader port in bursts,
+ * optionally written to another capture file by a pcap_writer port, and
+ * freed. The packet and bit rates reached, and the cycles spent per
+ * packet, are printed at the end of the replay.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <getopt.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_debug.h>
+#include <rte_cycles.h>
+#include <rte_mempool.h>
+#include <rte_mbuf.h>
+#include <rte_port_pcap.h>
+
+#define NB_MBUF         8191
+#define MBUF_CACHE_SIZE 256
+#define MBUF_SIZE       (RTE_MBUF_DEFAULT_BUF_SIZE + sizeof(struct rte_mbuf))
+
+static const char *in_file;
+static const char *out_file;
+static unsigned nb_loops = 1;
+static unsigned burst_size = 32;
+static uint32_t reader_flags;
+
+static void
+usage(const char *prgname)
+{
+	printf("%s [EAL options] -- -r FILE [-w FILE] [-l LOOPS] [-b BURST]"
+		" [-z] [-p]\n"
+		"  -r FILE: capture file to replay\n"
+		"  -w FILE: capture file to write the packets to\n"
+		"  -l LOOPS: number of replays of the file, 0 for no limit"
+		" (default %u)\n"
+		"  -b BURST: packets per burst (default %u, max %u)\n"
+		"  -z: zero copy, the packets point into the file mapping\n"
+		"  -p: paced, the packets are replayed at the capture rate\n",
+		prgname, nb_loops, burst_size, RTE_PORT_IN_BURST_SIZE_MAX);
+}
+
+static int
+parse_args(int argc, char **argv)
+{
+	int opt;
+
+	while ((opt = getopt(argc, argv, "r:w:l:b:zp")) != EOF) {
+		switch (opt) {
+		case 'r':
+			in_file = optarg;
+			break;
+		case 'w':
+			out_file = optarg;
+			break;
+		case 'l':
+			nb_loops = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			burst_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'z':
+			reader_flags |= RTE_PORT_PCAP_READER_F_ZERO_COPY;
+			break;
+		case 'p':
+			reader_flags |= RTE_PORT_PCAP_READER_F_PACED;
+			break;
+		default:
+			return -1;
+		}
+	}
+
+	if (in_file == NULL || burst_size == 0 ||
+	    burst_size > RTE_PORT_IN_BURST_SIZE_MAX)
+		return -1;
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct rte_port_pcap_reader_params reader_params;
+	struct rte_port_pcap_writer_params writer_params;
+	struct rte_mbuf *pkts[RTE_PORT_IN_BURST_SIZE_MAX];
+	struct rte_mempool *mp;
+	void *reader, *writer = NULL;
+	uint64_t nb_pkts = 0, nb_bytes = 0, start, cycles;
+	double secs;
+	int i, n, ret;
+
+	ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_panic("Cannot init EAL\n");
+	argc -= ret;
+	argv += ret;
+
+	if (parse_args(argc, argv) != 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	/* without hugepages, keep the mbufs in anonymous memory, where they
+	 * are not padded to a page and their physical address is known */
+	mp = rte_mempool_create("pcap_replay", NB_MBUF, MBUF_SIZE,
+		MBUF_CACHE_SIZE, sizeof(struct rte_pktmbuf_pool_private),
+		rte_pktmbuf_pool_init, NULL, rte_pktmbuf_init, NULL,
+		rte_socket_id(),
+		rte_eal_has_hugepages() ? 0 : MEMPOOL_F_ANON);
+	if (mp == NULL)
+		rte_panic("Cannot create mbuf pool\n");
+
+	memset(&reader_params, 0, sizeof(reader_params));
+	reader_params.mempool = mp;
+	reader_params.file_name = in_file;
+	reader_params.n_loops = nb_loops;
+	reader_params.flags = reader_flags;
+	reader = rte_port_pcap_reader_ops.f_create(&reader_params,
+		rte_socket_id());
+	if (reader == NULL)
+		rte_panic("Cannot open %s\n", in_file);
+
+	if (out_file != NULL) {
+		memset(&writer_params, 0, sizeof(writer_params));
+		writer_params.file_name = out_file;
+		writer = rte_port_pcap_writer_ops.f_create(&writer_params,
+			rte_socket_id());
+		if (writer == NULL)
+			rte_panic("Cannot create %s\n", out_file);
+	}
+
+	start = rte_rdtsc();
+	while (!rte_port_pcap_reader_eof(reader)) {
+		n = rte_port_pcap_reader_ops.f_rx(reader, pkts, burst_size);
+		if (n <= 0)
+			continue;
+
+		nb_pkts += n;
+		for (i = 0; i < n; i++)
+			nb_bytes += pkts[i]->pkt_len;
+
+		if (writer != NULL)
+			rte_port_pcap_writer_ops.f_tx_bulk(writer, pkts,
+				RTE_LEN2MASK(n, uint64_t));
+		else
+			rte_pktmbuf_free_bulk(pkts, n);
+	}
+	cycles = rte_rdtsc() - start;
+
+	if (writer != NULL)
+		rte_port_pcap_writer_ops.f_free(writer);
+	rte_port_pcap_reader_ops.f_free(reader);
+
+	secs = (double)cycles / rte_get_tsc_hz();
+	printf("packets=%"PRIu64" bytes=%"PRIu64" secs=%.3f mpps=%.3f"
+		" gbps=%.3f cycles_per_pkt=%.1f\n",
+		nb_pkts, nb_bytes, secs, nb_pkts / secs / 1e6,
+		nb_bytes * 8 / secs / 1e9,
+		nb_pkts ? (double)cycles / nb_pkts : 0.);
+
+	return 0;
+}
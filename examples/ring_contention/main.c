@@ -0,0 +1,272 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Ring contention benchmark.
+ *
+ * Several threads per lcore dequeue a burst of objects from a shared ring
+ * and enqueue it back, so that producers and consumers are preempted in
+ * the middle of their operations. The latency of each dequeue/enqueue
+ * pair is recorded for the default multi-producers/consumers mode, and
+ * for the RTS and HTS modes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_debug.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_ring.h>
+
+#define MAX_THREADS 1024
+#define MAX_BURST 256
+#define HIST_SIZE 64
+
+struct thread_conf {
+	pthread_t id;
+	unsigned lcore_id;
+	struct rte_ring *r;
+	uint64_t ops;
+	uint64_t max_cycles;
+	uint64_t hist[HIST_SIZE]; /* log2 of the cycles per operation */
+} __rte_cache_aligned;
+
+static const struct {
+	const char *name;
+	unsigned flags;
+} modes[] = {
+	{ "mt", 0 },
+	{ "rts", RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ },
+	{ "hts", RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ },
+};
+
+static struct thread_conf threads[MAX_THREADS];
+static unsigned nb_threads;
+
+static unsigned threads_per_lcore = 4;
+static unsigned burst = 8;
+static unsigned duration = 2;
+static unsigned ring_size = 1024;
+
+static volatile int start;
+static volatile int stop;
+static rte_atomic32_t ready;
+
+static void *
+worker(void *arg)
+{
+	struct thread_conf *tc = arg;
+	void *objs[MAX_BURST];
+	uint64_t t0, cycles;
+	unsigned n;
+
+	rte_thread_set_affinity(&lcore_config[tc->lcore_id].cpuset);
+	rte_atomic32_inc(&ready);
+	while (start == 0)
+		sched_yield();
+
+	while (stop == 0) {
+		t0 = rte_rdtsc();
+		n = rte_ring_dequeue_burst(tc->r, objs, burst);
+		/* there is always room for the objects we just took */
+		if (n != 0)
+			rte_ring_enqueue_bulk(tc->r, objs, n);
+		cycles = rte_rdtsc() - t0;
+
+		tc->hist[cycles == 0 ? 0 : 63 - __builtin_clzll(cycles)]++;
+		if (cycles > tc->max_cycles)
+			tc->max_cycles = cycles;
+		tc->ops++;
+	}
+	return NULL;
+}
+
+/* upper bound of the cycles of the given percentile of operations */
+static uint64_t
+hist_percentile(const uint64_t *hist, uint64_t total, double pct)
+{
+	uint64_t sum = 0, limit = (uint64_t)(total * pct / 100.0);
+	unsigned i;
+
+	for (i = 0; i < HIST_SIZE - 1; i++) {
+		sum += hist[i];
+		if (sum > limit)
+			break;
+	}
+	return (uint64_t)2 << i;
+}
+
+static void
+run_mode(unsigned m)
+{
+	char name[RTE_RING_NAMESIZE];
+	uint64_t hist[HIST_SIZE];
+	uint64_t ops = 0, max_cycles = 0, hz = rte_get_tsc_hz();
+	struct rte_ring *r;
+	unsigned i, j, lcore_id;
+
+	snprintf(name, sizeof(name), "contention_%s", modes[m].name);
+	r = rte_ring_create(name, ring_size, rte_socket_id(), modes[m].flags);
+	if (r == NULL)
+		rte_exit(EXIT_FAILURE, "Cannot create ring %s\n", name);
+
+	/* half of the ring is in flight between the threads */
+	for (i = 0; i < ring_size / 2; i++)
+		rte_ring_enqueue(r, (void *)(uintptr_t)(i + 1));
+
+	memset(threads, 0, sizeof(threads));
+	rte_atomic32_set(&ready, 0);
+	start = 0;
+	stop = 0;
+	nb_threads = 0;
+	RTE_LCORE_FOREACH(lcore_id) {
+		for (j = 0; j < threads_per_lcore; j++) {
+			struct thread_conf *tc = &threads[nb_threads++];
+
+			tc->lcore_id = lcore_id;
+			tc->r = r;
+			if (pthread_create(&tc->id, NULL, worker, tc) != 0)
+				rte_exit(EXIT_FAILURE, "Cannot create thread\n");
+		}
+	}
+
+	while (rte_atomic32_read(&ready) != (int32_t)nb_threads)
+		sched_yield();
+	start = 1;
+	sleep(duration);
+	stop = 1;
+
+	memset(hist, 0, sizeof(hist));
+	for (i = 0; i < nb_threads; i++) {
+		pthread_join(threads[i].id, NULL);
+		ops += threads[i].ops;
+		if (threads[i].max_cycles > max_cycles)
+			max_cycles = threads[i].max_cycles;
+		for (j = 0; j < HIST_SIZE; j++)
+			hist[j] += threads[i].hist[j];
+	}
+
+	if (rte_ring_count(r) != ring_size / 2)
+		rte_exit(EXIT_FAILURE, "Ring %s lost objects: %u instead of %u\n",
+			name, rte_ring_count(r), ring_size / 2);
+
+	printf("mode=%s threads=%u burst=%u size=%u ops=%"PRIu64
+		" mops=%.3f p50_cycles=%"PRIu64" p99_cycles=%"PRIu64
+		" p999_cycles=%"PRIu64" max_cycles=%"PRIu64" max_us=%.1f\n",
+		modes[m].name, nb_threads, burst, ring_size, ops,
+		(double)ops / duration / 1e6,
+		hist_percentile(hist, ops, 50.0),
+		hist_percentile(hist, ops, 99.0),
+		hist_percentile(hist, ops, 99.9),
+		max_cycles, hz ? (double)max_cycles * 1e6 / hz : 0.0);
+}
+
+static void
+usage(const char *prgname)
+{
+	printf("%s [EAL options] -- [-t THREADS] [-b BURST] [-d SECONDS]"
+		" [-s SIZE]\n"
+		"  -t THREADS: number of threads per lcore (default 4)\n"
+		"  -b BURST: objects per dequeue/enqueue (default 8)\n"
+		"  -d SECONDS: duration of each test (default 2)\n"
+		"  -s SIZE: ring size, power of 2 (default 1024)\n",
+		prgname);
+}
+
+static int
+parse_args(int argc, char **argv)
+{
+	int opt;
+
+	while ((opt = getopt(argc, argv, "t:b:d:s:")) != EOF) {
+		switch (opt) {
+		case 't':
+			threads_per_lcore = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			burst = strtoul(optarg, NULL, 0);
+			break;
+		case 'd':
+			duration = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			ring_size = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			return -1;
+		}
+	}
+
+	if (threads_per_lcore == 0 ||
+	    threads_per_lcore * rte_lcore_count() > MAX_THREADS ||
+	    burst == 0 || burst > MAX_BURST || duration == 0 ||
+	    !rte_is_power_of_2(ring_size) || ring_size < 4)
+		return -1;
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	unsigned m;
+	int ret;
+
+	ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_panic("Cannot init EAL\n");
+	argc -= ret;
+	argv += ret;
+
+	if (parse_args(argc, argv) < 0) {
+		usage(argv[0]);
+		rte_exit(EXIT_FAILURE, "Invalid arguments\n");
+	}
+
+	for (m = 0; m < RTE_DIM(modes); m++)
+		run_mode(m);
+
+	return 0;
+}
@@ -0,0 +1,716 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Hash tests: for each kind of table, insert random 16-byte keys until
+ * the first failure and report the load reached, then measure the cycles
+ * per key of the lookups (one by one and in bulks) and of a delete
+ * followed by an add, on the table at that load. The bulk lookups are
+ * also measured in random order with the fetch of the user data of each
+ * key, stored with the key or in an array indexed by position.
+ *
+ * The concurrency tests then run 1 to N reader lcores doing bulk lookups
+ * while the master lcore keeps deleting keys and adding others, with the
+ * table either protected by a rwlock or created lock-free for readers,
+ * and report the lookup throughput of the readers. Part of the keys are
+ * never deleted: a reader that misses one of them counts an error.
+ *
+ * The multi-writer tests run 1 to N lcores adding, then deleting,
+ * separate sets of keys in the same table, either protected by a global
+ * spinlock or created for several writers, and report the throughput of
+ * the adds and the deletes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_rwlock.h>
+#include <rte_spinlock.h>
+#include <rte_hash.h>
+
+#include "perf.h"
+
+#define HASH_PERF_ENTRIES (1 << 18)
+#define HASH_PERF_KEY_LEN 16
+
+/* Concurrency tests: keys never deleted, and keys deleted and added back,
+ * half of which are in the table at a time, for a load of 87.5% */
+#define HASH_RW_ENTRIES (1 << 16)
+#define HASH_RW_STABLE (HASH_RW_ENTRIES / 8 * 5)
+#define HASH_RW_CHURN (HASH_RW_ENTRIES / 2)
+
+/* Positions deleted before the writer waits for the readers to free them */
+#define HASH_RW_PENDING_MAX 1024
+
+/* Multi-writer tests: keys added by all the writers, for a load of 87.5% */
+#define HASH_MW_KEYS (HASH_PERF_ENTRIES / 8 * 7)
+
+struct hash_perf_key {
+	uint32_t w[HASH_PERF_KEY_LEN / sizeof(uint32_t)];
+};
+
+struct hash_rw_reader {
+	volatile uint64_t nb_bulks;	/* Also the quiescent state counter. */
+	uint64_t cycles;
+	uint64_t errors;
+	uint32_t seed;
+} __rte_cache_aligned;
+
+struct hash_rw_writer {
+	uint64_t nb_updates;
+	uint64_t cycles;
+	uint64_t errors;
+};
+
+static struct {
+	struct rte_hash *h;
+	int lock_free;
+	rte_rwlock_t lock;
+	volatile int stop;
+	const struct hash_perf_key *keys;	/* Stable keys, then churn. */
+	const int32_t *stable_pos;
+	uint32_t present[HASH_RW_CHURN / 2];	/* Churn keys in the table. */
+	uint32_t absent[HASH_RW_CHURN / 2];
+	int32_t pending[HASH_RW_PENDING_MAX];	/* Deleted, not freed. */
+	unsigned nb_pending;
+	struct hash_rw_reader readers[RTE_MAX_LCORE];
+	unsigned nb_readers;
+} hash_rw;
+
+struct hash_mw_writer {
+	uint32_t first;			/* Keys of this writer. */
+	uint32_t nb_keys;
+	uint64_t cycles;
+	uint64_t errors;
+} __rte_cache_aligned;
+
+static struct {
+	struct rte_hash *h;
+	int locked;
+	rte_spinlock_t lock;
+	const struct hash_perf_key *keys;
+	int32_t *pos;
+	struct hash_mw_writer writers[RTE_MAX_LCORE];
+} hash_mw;
+
+/* Kinds of tables under test */
+static const struct hash_perf_type {
+	const char *name;
+	uint32_t bucket_entries;
+	uint8_t extra_flag;
+	uint32_t stash_entries;
+} hash_perf_types[] = {
+	{ "bucket4", 4, 0, 0 },
+	{ "bucket16", 16, 0, 0 },
+	{ "cuckoo", 0, RTE_HASH_EXTRA_FLAGS_CUCKOO, 0 },
+	{ "cuckoo_stash", 0, RTE_HASH_EXTRA_FLAGS_CUCKOO, 16 },
+	{ "cuckoo_data", 0,
+	  RTE_HASH_EXTRA_FLAGS_CUCKOO | RTE_HASH_EXTRA_FLAGS_KEY_DATA, 0 },
+};
+
+static inline uint32_t
+hash_perf_rand(uint32_t *seed)
+{
+	/* xorshift32 */
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 17;
+	*seed ^= *seed << 5;
+	return *seed;
+}
+
+static int
+hash_perf_run(const struct hash_perf_type *type, struct hash_perf_key *keys,
+	int32_t *pos, void **values)
+{
+	struct rte_hash_parameters params;
+	struct rte_hash *h;
+	const void *bulk_keys[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t bulk_pos[RTE_HASH_LOOKUP_BULK_MAX];
+	void *data[RTE_HASH_LOOKUP_BULK_MAX];
+	uint64_t t0, lookup_cycles, bulk_cycles, data_cycles, update_cycles;
+	uint64_t hits;
+	uint32_t n, i, j, seed = 1;
+	int with_data = !!(type->extra_flag & RTE_HASH_EXTRA_FLAGS_KEY_DATA);
+	int ret = 0;
+
+	memset(&params, 0, sizeof(params));
+	params.name = type->name;
+	params.entries = HASH_PERF_ENTRIES;
+	params.bucket_entries = type->bucket_entries;
+	params.key_len = HASH_PERF_KEY_LEN;
+	params.socket_id = rte_socket_id();
+	params.extra_flag = type->extra_flag;
+	params.stash_entries = type->stash_entries;
+	h = rte_hash_create(&params);
+	if (h == NULL) {
+		printf("# cannot create hash %s\n", type->name);
+		return -1;
+	}
+
+	for (n = 0; n < HASH_PERF_ENTRIES; n++) {
+		pos[n] = rte_hash_add_key(h, &keys[n]);
+		if (pos[n] < 0)
+			break;
+	}
+	if (n < RTE_HASH_LOOKUP_BULK_MAX) {
+		printf("# hash %s: only %u keys added\n", type->name, n);
+		rte_hash_free(h);
+		return -1;
+	}
+	n -= n % RTE_HASH_LOOKUP_BULK_MAX;
+
+	/* the user data of a key is a pointer to it */
+	for (i = 0; i < n; i++) {
+		if (with_data)
+			rte_hash_add_key_data(h, &keys[i], &keys[i]);
+		else
+			values[pos[i]] = &keys[i];
+	}
+
+	t0 = rte_rdtsc();
+	for (i = 0; i < n; i++) {
+		if (rte_hash_lookup(h, &keys[i]) != pos[i])
+			ret = -1;
+	}
+	lookup_cycles = rte_rdtsc() - t0;
+
+	t0 = rte_rdtsc();
+	for (i = 0; i < n; i += RTE_HASH_LOOKUP_BULK_MAX) {
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+			bulk_keys[j] = &keys[i + j];
+		rte_hash_lookup_bulk(h, bulk_keys, RTE_HASH_LOOKUP_BULK_MAX,
+			bulk_pos);
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++) {
+			if (bulk_pos[j] != pos[i + j])
+				ret = -1;
+		}
+	}
+	bulk_cycles = rte_rdtsc() - t0;
+
+	t0 = rte_rdtsc();
+	for (i = 0; i < n; i += RTE_HASH_LOOKUP_BULK_MAX) {
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+			bulk_keys[j] = &keys[hash_perf_rand(&seed) % n];
+		if (with_data) {
+			if (rte_hash_lookup_bulk_data(h, bulk_keys,
+					RTE_HASH_LOOKUP_BULK_MAX, &hits,
+					data) != RTE_HASH_LOOKUP_BULK_MAX)
+				ret = -1;
+		} else {
+			rte_hash_lookup_bulk(h, bulk_keys,
+				RTE_HASH_LOOKUP_BULK_MAX, bulk_pos);
+			for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+				data[j] = values[bulk_pos[j]];
+		}
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++) {
+			if (data[j] != bulk_keys[j])
+				ret = -1;
+		}
+	}
+	data_cycles = rte_rdtsc() - t0;
+
+	t0 = rte_rdtsc();
+	for (i = 0; i < n; i++) {
+		rte_hash_del_key(h, &keys[i]);
+		if (rte_hash_add_key(h, &keys[i]) < 0)
+			ret = -1;
+	}
+	update_cycles = rte_rdtsc() - t0;
+
+	rte_hash_free(h);
+	if (ret != 0) {
+		printf("# hash %s: lookup or update failed\n", type->name);
+		return -1;
+	}
+
+	printf("test=hash_perf table=%s entries=%u load=%.2f lookup=%.2f"
+		" lookup_bulk=%.2f lookup_bulk_data=%.2f del_add=%.2f\n",
+		type->name, HASH_PERF_ENTRIES, 100. * n / HASH_PERF_ENTRIES,
+		(double)lookup_cycles / n, (double)bulk_cycles / n,
+		(double)data_cycles / n, (double)update_cycles / n);
+	return 0;
+}
+
+static int
+hash_rw_read(void *arg)
+{
+	struct hash_rw_reader *r = arg;
+	const void *keys[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t pos[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t idx[RTE_HASH_LOOKUP_BULK_MAX];
+	uint64_t t0;
+	unsigned i;
+
+	perf_sync_start();
+	t0 = rte_rdtsc();
+	while (!hash_rw.stop) {
+		/* stable keys at even indexes, churn keys at odd ones */
+		for (i = 0; i < RTE_HASH_LOOKUP_BULK_MAX; i++) {
+			idx[i] = hash_perf_rand(&r->seed);
+			if (i & 1)
+				idx[i] = HASH_RW_STABLE + idx[i] % HASH_RW_CHURN;
+			else
+				idx[i] %= HASH_RW_STABLE;
+			keys[i] = &hash_rw.keys[idx[i]];
+		}
+
+		if (!hash_rw.lock_free)
+			rte_rwlock_read_lock(&hash_rw.lock);
+		rte_hash_lookup_bulk(hash_rw.h, keys, RTE_HASH_LOOKUP_BULK_MAX,
+			pos);
+		if (!hash_rw.lock_free)
+			rte_rwlock_read_unlock(&hash_rw.lock);
+
+		/* no reference into the table is held from here */
+		r->nb_bulks++;
+
+		for (i = 0; i < RTE_HASH_LOOKUP_BULK_MAX; i += 2) {
+			if (pos[i] != hash_rw.stable_pos[idx[i]])
+				r->errors++;
+		}
+	}
+	r->cycles = rte_rdtsc() - t0;
+	return 0;
+}
+
+/* Free the positions deleted until now. */
+static void
+hash_rw_free_pending(void)
+{
+	unsigned i;
+
+	for (i = 0; i < hash_rw.nb_pending; i++)
+		rte_hash_free_key_with_position(hash_rw.h, hash_rw.pending[i]);
+	hash_rw.nb_pending = 0;
+}
+
+/* Wait until every reader went through a quiescent state, then free the
+ * positions deleted until now. The readers must still be running. */
+static void
+hash_rw_reclaim(void)
+{
+	uint64_t seen[RTE_MAX_LCORE];
+	unsigned i;
+
+	for (i = 0; i < hash_rw.nb_readers; i++)
+		seen[i] = hash_rw.readers[i].nb_bulks;
+	for (i = 0; i < hash_rw.nb_readers; i++) {
+		while (hash_rw.readers[i].nb_bulks == seen[i])
+			rte_pause();
+	}
+
+	hash_rw_free_pending();
+}
+
+static int
+hash_rw_write(void *arg)
+{
+	struct hash_rw_writer *w = arg;
+	uint32_t seed = 1, p, a, tmp;
+	uint64_t n, t0;
+	int32_t pos;
+	int ret;
+
+	perf_sync_start();
+	t0 = rte_rdtsc();
+	for (n = 0; n < w->nb_updates; n++) {
+		p = hash_perf_rand(&seed) % RTE_DIM(hash_rw.present);
+		a = hash_perf_rand(&seed) % RTE_DIM(hash_rw.absent);
+
+		if (!hash_rw.lock_free)
+			rte_rwlock_write_lock(&hash_rw.lock);
+		pos = rte_hash_del_key(hash_rw.h,
+			&hash_rw.keys[hash_rw.present[p]]);
+		ret = rte_hash_add_key(hash_rw.h,
+			&hash_rw.keys[hash_rw.absent[a]]);
+		if (!hash_rw.lock_free)
+			rte_rwlock_write_unlock(&hash_rw.lock);
+
+		if (pos < 0 || ret < 0)
+			w->errors++;
+		tmp = hash_rw.present[p];
+		hash_rw.present[p] = hash_rw.absent[a];
+		hash_rw.absent[a] = tmp;
+
+		if (hash_rw.lock_free && pos >= 0) {
+			hash_rw.pending[hash_rw.nb_pending++] = pos;
+			if (hash_rw.nb_pending == HASH_RW_PENDING_MAX)
+				hash_rw_reclaim();
+		}
+	}
+	w->cycles = rte_rdtsc() - t0;
+
+	/* a reader may stop before its next bulk: the positions still
+	 * pending are freed once the readers are joined */
+	hash_rw.stop = 1;
+	return 0;
+}
+
+static int
+hash_rw_run(int lock_free, const unsigned *lcores, unsigned nb_readers,
+	struct hash_perf_key *keys, int32_t *pos)
+{
+	struct rte_hash_parameters params;
+	lcore_function_t *f[RTE_MAX_LCORE];
+	void *args[RTE_MAX_LCORE];
+	struct hash_rw_writer w;
+	uint64_t nb_lookups = 0, reader_cycles = 0, errors;
+	double seconds;
+	unsigned i;
+	int ret = 0;
+
+	memset(&params, 0, sizeof(params));
+	params.name = lock_free ? "rw_lf" : "rw_lock";
+	params.entries = HASH_RW_ENTRIES;
+	params.key_len = HASH_PERF_KEY_LEN;
+	params.socket_id = rte_socket_id();
+	params.extra_flag = RTE_HASH_EXTRA_FLAGS_CUCKOO;
+	if (lock_free)
+		params.extra_flag |= RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF;
+	hash_rw.h = rte_hash_create(&params);
+	if (hash_rw.h == NULL) {
+		printf("# cannot create hash %s\n", params.name);
+		return -1;
+	}
+
+	for (i = 0; i < HASH_RW_STABLE; i++) {
+		pos[i] = rte_hash_add_key(hash_rw.h, &keys[i]);
+		if (pos[i] < 0)
+			ret = -1;
+	}
+	for (i = 0; i < RTE_DIM(hash_rw.present); i++) {
+		hash_rw.present[i] = HASH_RW_STABLE + 2 * i;
+		hash_rw.absent[i] = HASH_RW_STABLE + 2 * i + 1;
+		if (rte_hash_add_key(hash_rw.h,
+				&keys[hash_rw.present[i]]) < 0)
+			ret = -1;
+	}
+	if (ret != 0) {
+		printf("# hash %s: cannot add keys\n", params.name);
+		rte_hash_free(hash_rw.h);
+		return -1;
+	}
+
+	hash_rw.lock_free = lock_free;
+	rte_rwlock_init(&hash_rw.lock);
+	hash_rw.stop = 0;
+	hash_rw.keys = keys;
+	hash_rw.stable_pos = pos;
+	hash_rw.nb_pending = 0;
+	hash_rw.nb_readers = nb_readers;
+
+	memset(&w, 0, sizeof(w));
+	w.nb_updates = perf_nb_objs / RTE_HASH_LOOKUP_BULK_MAX;
+	f[0] = hash_rw_write;
+	args[0] = &w;
+	for (i = 0; i < nb_readers; i++) {
+		memset(&hash_rw.readers[i], 0, sizeof(hash_rw.readers[i]));
+		hash_rw.readers[i].seed = i + 1;
+		f[i + 1] = hash_rw_read;
+		args[i + 1] = &hash_rw.readers[i];
+	}
+	if (perf_launch(lcores, nb_readers + 1, f, args) != 0) {
+		rte_hash_free(hash_rw.h);
+		return -1;
+	}
+	/* no reader is left, no grace period is needed */
+	hash_rw_free_pending();
+	rte_hash_free(hash_rw.h);
+
+	errors = w.errors;
+	for (i = 0; i < nb_readers; i++) {
+		nb_lookups += hash_rw.readers[i].nb_bulks *
+			RTE_HASH_LOOKUP_BULK_MAX;
+		reader_cycles += hash_rw.readers[i].cycles;
+		errors += hash_rw.readers[i].errors;
+	}
+	seconds = (double)w.cycles / rte_get_tsc_hz();
+
+	printf("test=hash_rw mode=%s readers=%u updates=%"PRIu64
+		" lookups=%"PRIu64" lookup_cycles=%.2f mlookups_per_s=%.2f"
+		" update_cycles=%.2f errors=%"PRIu64"\n",
+		lock_free ? "lf" : "rwlock", nb_readers, w.nb_updates,
+		nb_lookups,
+		(double)reader_cycles / RTE_MAX(nb_lookups, UINT64_C(1)),
+		nb_lookups / seconds / 1e6, (double)w.cycles / w.nb_updates,
+		errors);
+	return errors == 0 ? 0 : -1;
+}
+
+static int
+hash_rw_perf(struct hash_perf_key *keys, int32_t *pos)
+{
+	unsigned lcores[RTE_MAX_LCORE];
+	unsigned lcore_id, nb_lcores = 0, n;
+	int lock_free;
+
+	lcores[nb_lcores++] = rte_get_master_lcore();
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		lcores[nb_lcores++] = lcore_id;
+	if (nb_lcores < 2) {
+		printf("# hash_rw: no lcores for the readers\n");
+		return 0;
+	}
+
+	for (lock_free = 0; lock_free <= 1; lock_free++) {
+		for (n = 1; n < nb_lcores; n++) {
+			if (hash_rw_run(lock_free, lcores, n, keys, pos) != 0)
+				return -1;
+		}
+	}
+	return 0;
+}
+
+
+static int
+hash_mw_add(void *arg)
+{
+	struct hash_mw_writer *w = arg;
+	uint32_t i, end = w->first + w->nb_keys;
+	uint64_t t0;
+
+	perf_sync_start();
+	t0 = rte_rdtsc();
+	for (i = w->first; i < end; i++) {
+		if (hash_mw.locked)
+			rte_spinlock_lock(&hash_mw.lock);
+		hash_mw.pos[i] = rte_hash_add_key(hash_mw.h, &hash_mw.keys[i]);
+		if (hash_mw.locked)
+			rte_spinlock_unlock(&hash_mw.lock);
+		if (hash_mw.pos[i] < 0)
+			w->errors++;
+	}
+	w->cycles = rte_rdtsc() - t0;
+	return 0;
+}
+
+static int
+hash_mw_del(void *arg)
+{
+	struct hash_mw_writer *w = arg;
+	uint32_t i, end = w->first + w->nb_keys;
+	uint64_t t0;
+	int32_t pos;
+
+	perf_sync_start();
+	t0 = rte_rdtsc();
+	for (i = w->first; i < end; i++) {
+		if (hash_mw.locked)
+			rte_spinlock_lock(&hash_mw.lock);
+		pos = rte_hash_del_key(hash_mw.h, &hash_mw.keys[i]);
+		if (hash_mw.locked)
+			rte_spinlock_unlock(&hash_mw.lock);
+		if (pos != hash_mw.pos[i])
+			w->errors++;
+	}
+	w->cycles = rte_rdtsc() - t0;
+	return 0;
+}
+
+/* Run one phase on all the writers; return the cycles of the slowest. */
+static int
+hash_mw_launch(lcore_function_t *phase, const unsigned *lcores,
+	unsigned nb_writers, uint64_t *cycles)
+{
+	lcore_function_t *f[RTE_MAX_LCORE];
+	void *args[RTE_MAX_LCORE];
+	unsigned i;
+
+	for (i = 0; i < nb_writers; i++) {
+		hash_mw.writers[i].cycles = 0;
+		f[i] = phase;
+		args[i] = &hash_mw.writers[i];
+	}
+	if (perf_launch(lcores, nb_writers, f, args) != 0)
+		return -1;
+
+	*cycles = 0;
+	for (i = 0; i < nb_writers; i++)
+		*cycles = RTE_MAX(*cycles, hash_mw.writers[i].cycles);
+	return 0;
+}
+
+/* Check that the positions of the keys are all different and found by
+ * lookups; return the number of errors. */
+static uint64_t
+hash_mw_check(void)
+{
+	uint8_t *used;
+	uint64_t errors = 0;
+	uint32_t i;
+
+	used = rte_zmalloc(NULL, HASH_PERF_ENTRIES, 0);
+	if (used == NULL)
+		return 1;
+	for (i = 0; i < HASH_MW_KEYS; i++) {
+		if (hash_mw.pos[i] < 0)
+			continue;
+		if (used[hash_mw.pos[i]]++ != 0 ||
+		    rte_hash_lookup(hash_mw.h, &hash_mw.keys[i]) !=
+		    hash_mw.pos[i])
+			errors++;
+	}
+	rte_free(used);
+	return errors;
+}
+
+static int
+hash_mw_run(int locked, const unsigned *lcores, unsigned nb_writers,
+	struct hash_perf_key *keys, int32_t *pos)
+{
+	struct rte_hash_parameters params;
+	uint64_t add_cycles, del_cycles, errors;
+	double hz = rte_get_tsc_hz();
+	unsigned i;
+
+	memset(&params, 0, sizeof(params));
+	params.name = locked ? "mw_lock" : "mw";
+	params.entries = HASH_PERF_ENTRIES;
+	params.key_len = HASH_PERF_KEY_LEN;
+	params.socket_id = rte_socket_id();
+	params.extra_flag = RTE_HASH_EXTRA_FLAGS_CUCKOO;
+	if (!locked)
+		params.extra_flag |= RTE_HASH_EXTRA_FLAGS_MULTI_WRITER;
+	hash_mw.h = rte_hash_create(&params);
+	if (hash_mw.h == NULL) {
+		printf("# cannot create hash %s\n", params.name);
+		return -1;
+	}
+
+	hash_mw.locked = locked;
+	rte_spinlock_init(&hash_mw.lock);
+	hash_mw.keys = keys;
+	hash_mw.pos = pos;
+	for (i = 0; i < nb_writers; i++) {
+		hash_mw.writers[i].first = HASH_MW_KEYS / nb_writers * i;
+		hash_mw.writers[i].nb_keys = HASH_MW_KEYS / nb_writers;
+		hash_mw.writers[i].errors = 0;
+	}
+	hash_mw.writers[nb_writers - 1].nb_keys +=
+		HASH_MW_KEYS % nb_writers;
+
+	if (hash_mw_launch(hash_mw_add, lcores, nb_writers,
+			&add_cycles) != 0)
+		goto fail;
+	errors = hash_mw_check();
+	if (hash_mw_launch(hash_mw_del, lcores, nb_writers,
+			&del_cycles) != 0)
+		goto fail;
+	for (i = 0; i < HASH_MW_KEYS; i++) {
+		if (rte_hash_lookup(hash_mw.h, &keys[i]) != -ENOENT)
+			errors++;
+	}
+	for (i = 0; i < nb_writers; i++)
+		errors += hash_mw.writers[i].errors;
+	rte_hash_free(hash_mw.h);
+
+	printf("test=hash_mw mode=%s writers=%u keys=%u add_cycles=%.2f"
+		" del_cycles=%.2f madds_per_s=%.2f mdels_per_s=%.2f"
+		" errors=%"PRIu64"\n",
+		locked ? "lock" : "mw", nb_writers, HASH_MW_KEYS,
+		(double)add_cycles * nb_writers / HASH_MW_KEYS,
+		(double)del_cycles * nb_writers / HASH_MW_KEYS,
+		HASH_MW_KEYS / (add_cycles / hz) / 1e6,
+		HASH_MW_KEYS / (del_cycles / hz) / 1e6, errors);
+	return errors == 0 ? 0 : -1;
+
+fail:
+	rte_hash_free(hash_mw.h);
+	return -1;
+}
+
+static int
+hash_mw_perf(struct hash_perf_key *keys, int32_t *pos)
+{
+	unsigned lcores[RTE_MAX_LCORE];
+	unsigned lcore_id, nb_lcores = 0, n;
+	int locked;
+
+	lcores[nb_lcores++] = rte_get_master_lcore();
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		lcores[nb_lcores++] = lcore_id;
+
+	for (locked = 1; locked >= 0; locked--) {
+		for (n = 1; n <= nb_lcores; n++) {
+			if (hash_mw_run(locked, lcores, n, keys, pos) != 0)
+				return -1;
+		}
+	}
+	return 0;
+}
+
+int
+hash_perf(void)
+{
+	struct hash_perf_key *keys;
+	int32_t *pos;
+	void **values;
+	unsigned i, j;
+	int ret = 0;
+
+	keys = rte_malloc(NULL, HASH_PERF_ENTRIES * sizeof(*keys), 0);
+	pos = rte_malloc(NULL, HASH_PERF_ENTRIES * sizeof(*pos), 0);
+	values = rte_malloc(NULL, HASH_PERF_ENTRIES * sizeof(*values), 0);
+	if (keys == NULL || pos == NULL || values == NULL) {
+		printf("# cannot allocate keys\n");
+		rte_free(keys);
+		rte_free(pos);
+		rte_free(values);
+		return -1;
+	}
+
+	srand(1);
+	for (i = 0; i < HASH_PERF_ENTRIES; i++) {
+		for (j = 0; j < RTE_DIM(keys[i].w); j++)
+			keys[i].w[j] = rand();
+	}
+
+	for (i = 0; i < RTE_DIM(hash_perf_types) && ret == 0; i++)
+		ret = hash_perf_run(&hash_perf_types[i], keys, pos, values);
+	if (ret == 0)
+		ret = hash_rw_perf(keys, pos);
+	if (ret == 0)
+		ret = hash_mw_perf(keys, pos);
+
+	rte_free(keys);
+	rte_free(pos);
+	rte_free(values);
+	return ret;
+}
@@ -0,0 +1,241 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Ring and mempool micro-benchmarks.
+ *
+ * The tests measure the cycles per object of the ring enqueue/dequeue
+ * and mempool get/put functions, for bulk sizes from 1 to 256, on one
+ * lcore and on pairs of lcores that are hyperthreads of the same core,
+ * cores of the same socket, or cores of different sockets. The mbuf
+ * tests measure the cycles per packet of the multi-segment helpers, and
+ * the hash tests the load reached and the cycles per key of each kind of
+ * hash table.
+ *
+ * Each result is printed on one line of "key=value" fields, lines that
+ * start with '#' are comments.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <getopt.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_debug.h>
+#include <rte_atomic.h>
+#include <rte_mempool.h>
+
+#include "perf.h"
+
+const char *perf_placement_names[PERF_NB_PLACEMENTS] = {
+	[PERF_SINGLE] = "single",
+	[PERF_HT] = "ht",
+	[PERF_SOCKET] = "socket",
+	[PERF_CROSS] = "cross",
+};
+
+const unsigned perf_bulk_sizes[] = { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+const unsigned perf_nb_bulk_sizes = RTE_DIM(perf_bulk_sizes);
+
+uint64_t perf_nb_objs = 1 << 20;
+unsigned perf_cache_size = 256;
+const char *perf_mempool_ops = RTE_MEMPOOL_OPS_RING_MP_MC;
+
+static rte_atomic32_t nb_ready;
+static unsigned nb_launched;
+
+static int
+placement_match(enum perf_placement pl, unsigned a, unsigned b)
+{
+	const struct lcore_config *ca = &lcore_config[a];
+	const struct lcore_config *cb = &lcore_config[b];
+
+	switch (pl) {
+	case PERF_HT:
+		return ca->socket_id == cb->socket_id &&
+			ca->core_id == cb->core_id;
+	case PERF_SOCKET:
+		return ca->socket_id == cb->socket_id &&
+			ca->core_id != cb->core_id;
+	case PERF_CROSS:
+		return ca->socket_id != cb->socket_id;
+	default:
+		return 0;
+	}
+}
+
+unsigned
+perf_find_lcores(enum perf_placement pl, unsigned lcores[PERF_MAX_LCORES])
+{
+	unsigned a, b;
+
+	if (pl == PERF_SINGLE) {
+		lcores[0] = rte_get_master_lcore();
+		return 1;
+	}
+
+	RTE_LCORE_FOREACH(a) {
+		RTE_LCORE_FOREACH(b) {
+			if (b <= a || !placement_match(pl, a, b))
+				continue;
+			lcores[0] = a;
+			lcores[1] = b;
+			return 2;
+		}
+	}
+	return 0;
+}
+
+const char *
+perf_lcores_str(char *buf, unsigned len, const unsigned *lcores, unsigned nb)
+{
+	unsigned i, off = 0;
+
+	buf[0] = '\0';
+	for (i = 0; i < nb && off < len; i++)
+		off += snprintf(buf + off, len - off, "%s%u",
+			i == 0 ? "" : ",", lcores[i]);
+	return buf;
+}
+
+void
+perf_sync_start(void)
+{
+	rte_atomic32_inc(&nb_ready);
+	while (rte_atomic32_read(&nb_ready) != (int32_t)nb_launched)
+		rte_pause();
+}
+
+int
+perf_launch(const unsigned *lcores, unsigned nb, lcore_function_t **f,
+	void **args)
+{
+	unsigned i, master = rte_get_master_lcore();
+	int ret = 0, on_master = -1;
+
+	rte_atomic32_set(&nb_ready, 0);
+	nb_launched = nb;
+	for (i = 0; i < nb; i++) {
+		if (lcores[i] == master)
+			on_master = i;
+		else if (rte_eal_remote_launch(f[i], args[i], lcores[i]) != 0)
+			rte_panic("Cannot launch on lcore %u\n", lcores[i]);
+	}
+
+	if (on_master >= 0)
+		ret = f[on_master](args[on_master]);
+
+	for (i = 0; i < nb; i++) {
+		if (lcores[i] != master && rte_eal_wait_lcore(lcores[i]) != 0)
+			ret = -1;
+	}
+	return ret;
+}
+
+static void
+usage(const char *prgname)
+{
+	printf("%s [EAL options] -- [-t ring|mempool|mbuf|hash|port]"
+		" [-n OBJS] [-C CACHE] [-m OPS]\n"
+		"  -t TEST: run only the ring, mempool, mbuf, hash or port"
+		" tests\n"
+		"  -n OBJS: objects moved by each lcore per test"
+		" (default %"PRIu64")\n"
+		"  -C CACHE: mempool cache size (default %u, max %u)\n"
+		"  -m OPS: mempool backend, e.g. ring_mp_mc or stack"
+		" (default %s)\n",
+		prgname, perf_nb_objs, perf_cache_size,
+		RTE_MEMPOOL_CACHE_MAX_SIZE, perf_mempool_ops);
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *test = NULL;
+	int opt, ret;
+
+	ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_panic("Cannot init EAL\n");
+	argc -= ret;
+	argv += ret;
+
+	while ((opt = getopt(argc, argv, "t:n:C:m:")) != EOF) {
+		switch (opt) {
+		case 't':
+			test = optarg;
+			break;
+		case 'n':
+			perf_nb_objs = strtoull(optarg, NULL, 0);
+			break;
+		case 'C':
+			perf_cache_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'm':
+			perf_mempool_ops = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			rte_exit(EXIT_FAILURE, "Invalid arguments\n");
+		}
+	}
+	if (perf_nb_objs < PERF_MAX_BULK ||
+	    perf_cache_size > RTE_MEMPOOL_CACHE_MAX_SIZE ||
+	    (test != NULL && strcmp(test, "ring") != 0 &&
+	     strcmp(test, "mempool") != 0 && strcmp(test, "mbuf") != 0 &&
+	     strcmp(test, "hash") != 0 && strcmp(test, "port") != 0)) {
+		usage(argv[0]);
+		rte_exit(EXIT_FAILURE, "Invalid arguments\n");
+	}
+
+	ret = 0;
+	if (test == NULL || strcmp(test, "ring") == 0)
+		ret |= ring_perf();
+	if (test == NULL || strcmp(test, "mempool") == 0)
+		ret |= mempool_perf();
+	if (test == NULL || strcmp(test, "mbuf") == 0)
+		ret |= mbuf_perf();
+	if (test == NULL || strcmp(test, "hash") == 0)
+		ret |= hash_perf();
+	if (test == NULL || strcmp(test, "port") == 0)
+		ret |= port_perf();
+
+	return ret == 0 ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,365 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Mbuf tests: on packets of 1 to 8 segments, measure the cycles to read
+ * the whole packet into a buffer with rte_pktmbuf_read(), to linearize
+ * it in place and to deep copy it with rte_pktmbuf_copy(). Building and
+ * freeing the packets is not counted.
+ *
+ * The alloc tests compare rte_pktmbuf_alloc_bulk() with a loop of
+ * rte_pktmbuf_alloc() for bursts of packets, in cycles per packet.
+ * The free tests compare rte_pktmbuf_free_bulk() with a loop of
+ * rte_pktmbuf_free() on bursts of one-segment packets from one mempool
+ * or spread over more mempools than a bulk free batches at a time, of
+ * two-segment packets, and of indirect packets that release their
+ * direct mbuf.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_mempool.h>
+#include <rte_mbuf.h>
+
+#include "perf.h"
+
+#define MBUF_PERF_MAX_SEGS 8
+#define MBUF_PERF_SEG_LEN 200
+#define MBUF_PERF_NB_MBUFS 1023
+
+static const unsigned mbuf_alloc_bursts[] = { 32, 64 };
+
+/* more than the mempools batched by rte_pktmbuf_free_bulk() */
+#define MBUF_FREE_NB_POOLS 8
+
+enum mbuf_free_case {
+	MBUF_FREE_DIRECT,
+	MBUF_FREE_POOLS,
+	MBUF_FREE_CHAIN,
+	MBUF_FREE_INDIRECT,
+	MBUF_FREE_NB_CASES
+};
+
+static const char *mbuf_free_case_names[MBUF_FREE_NB_CASES] = {
+	[MBUF_FREE_DIRECT] = "direct",
+	[MBUF_FREE_POOLS] = "pools",
+	[MBUF_FREE_CHAIN] = "chain",
+	[MBUF_FREE_INDIRECT] = "indirect",
+};
+
+static const unsigned mbuf_free_bursts[] = { 32, 64, 128, 256 };
+
+enum mbuf_perf_op {
+	MBUF_PERF_READ,
+	MBUF_PERF_LINEARIZE,
+	MBUF_PERF_COPY,
+	MBUF_PERF_NB_OPS
+};
+
+static const char *mbuf_perf_op_names[MBUF_PERF_NB_OPS] = {
+	[MBUF_PERF_READ] = "read",
+	[MBUF_PERF_LINEARIZE] = "linearize",
+	[MBUF_PERF_COPY] = "copy",
+};
+
+/* build a packet of nb_segs segments of MBUF_PERF_SEG_LEN bytes */
+static struct rte_mbuf *
+mbuf_perf_build(struct rte_mempool *mp, unsigned nb_segs)
+{
+	struct rte_mbuf *m, *seg;
+	unsigned i;
+
+	m = rte_pktmbuf_alloc(mp);
+	if (m == NULL)
+		return NULL;
+	seg = m;
+	for (i = 0; i < nb_segs; i++) {
+		if (i != 0) {
+			seg->next = rte_pktmbuf_alloc(mp);
+			if (seg->next == NULL) {
+				rte_pktmbuf_free(m);
+				return NULL;
+			}
+			seg = seg->next;
+			m->nb_segs++;
+		}
+		memset(rte_pktmbuf_mtod(seg, char *), i, MBUF_PERF_SEG_LEN);
+		seg->data_len = MBUF_PERF_SEG_LEN;
+		m->pkt_len += MBUF_PERF_SEG_LEN;
+	}
+	return m;
+}
+
+static int
+mbuf_perf_run(struct rte_mempool *mp, enum mbuf_perf_op op,
+	unsigned nb_segs)
+{
+	static uint8_t buf[MBUF_PERF_MAX_SEGS * MBUF_PERF_SEG_LEN];
+	struct rte_mbuf *m, *mc = NULL;
+	uint64_t i, nb_iter, t0, cycles = 0;
+	const void *data;
+	int ret = 0;
+
+	nb_iter = perf_nb_objs / 16;
+	for (i = 0; i < nb_iter && ret == 0; i++) {
+		m = mbuf_perf_build(mp, nb_segs);
+		if (m == NULL) {
+			printf("# cannot build a packet of %u segments\n",
+				nb_segs);
+			return -1;
+		}
+
+		t0 = rte_rdtsc();
+		switch (op) {
+		case MBUF_PERF_READ:
+			data = rte_pktmbuf_read(m, 0, m->pkt_len, buf);
+			if (data == NULL)
+				ret = -1;
+			break;
+		case MBUF_PERF_LINEARIZE:
+			ret = rte_pktmbuf_linearize(m);
+			break;
+		case MBUF_PERF_COPY:
+			mc = rte_pktmbuf_copy(m, mp, 0, UINT32_MAX);
+			if (mc == NULL)
+				ret = -1;
+			break;
+		default:
+			ret = -1;
+			break;
+		}
+		cycles += rte_rdtsc() - t0;
+
+		rte_pktmbuf_free(mc);
+		mc = NULL;
+		rte_pktmbuf_free(m);
+	}
+	if (ret != 0) {
+		printf("# mbuf_perf: %s of %u segments failed\n",
+			mbuf_perf_op_names[op], nb_segs);
+		return -1;
+	}
+
+	printf("test=mbuf_perf op=%s segs=%u len=%u iter=%"PRIu64
+		" cycles=%.2f\n",
+		mbuf_perf_op_names[op], nb_segs,
+		nb_segs * MBUF_PERF_SEG_LEN, nb_iter,
+		(double)cycles / nb_iter);
+	return 0;
+}
+
+static int
+mbuf_alloc_run(struct rte_mempool *mp, unsigned burst, int bulk)
+{
+	struct rte_mbuf *mbufs[PERF_MAX_BULK];
+	uint64_t i, nb_iter, t0, cycles = 0;
+	unsigned j;
+	int ret = 0;
+
+	nb_iter = perf_nb_objs / burst;
+	for (i = 0; i < nb_iter && ret == 0; i++) {
+		t0 = rte_rdtsc();
+		if (bulk) {
+			ret = rte_pktmbuf_alloc_bulk(mp, mbufs, burst);
+		} else {
+			for (j = 0; j < burst; j++) {
+				mbufs[j] = rte_pktmbuf_alloc(mp);
+				if (mbufs[j] == NULL)
+					break;
+			}
+			if (j != burst) {
+				while (j != 0)
+					rte_pktmbuf_free(mbufs[--j]);
+				ret = -1;
+			}
+		}
+		cycles += rte_rdtsc() - t0;
+
+		if (ret == 0) {
+			for (j = 0; j < burst; j++)
+				rte_pktmbuf_free(mbufs[j]);
+		}
+	}
+	if (ret != 0) {
+		printf("# mbuf_perf: alloc of %u packets failed\n", burst);
+		return -1;
+	}
+
+	printf("test=mbuf_alloc op=%s burst=%u iter=%"PRIu64" cycles=%.2f\n",
+		bulk ? "bulk" : "loop", burst, nb_iter,
+		(double)cycles / (nb_iter * burst));
+	return 0;
+}
+
+/* build the packet number idx of a burst to free */
+static struct rte_mbuf *
+mbuf_free_build(struct rte_mempool **pools, enum mbuf_free_case c,
+	unsigned idx)
+{
+	struct rte_mbuf *md, *mi;
+
+	switch (c) {
+	case MBUF_FREE_DIRECT:
+		return mbuf_perf_build(pools[0], 1);
+	case MBUF_FREE_POOLS:
+		return mbuf_perf_build(pools[idx % MBUF_FREE_NB_POOLS], 1);
+	case MBUF_FREE_CHAIN:
+		return mbuf_perf_build(pools[0], 2);
+	case MBUF_FREE_INDIRECT:
+		md = mbuf_perf_build(pools[0], 1);
+		if (md == NULL)
+			return NULL;
+		/* the clone holds the last reference to md */
+		mi = rte_pktmbuf_clone(md, pools[0]);
+		rte_pktmbuf_free(md);
+		return mi;
+	default:
+		return NULL;
+	}
+}
+
+static int
+mbuf_free_run(struct rte_mempool **pools, enum mbuf_free_case c,
+	unsigned burst, int bulk)
+{
+	struct rte_mbuf *mbufs[PERF_MAX_BULK];
+	uint64_t i, nb_iter, t0, cycles = 0;
+	unsigned j;
+
+	nb_iter = perf_nb_objs / burst;
+	for (i = 0; i < nb_iter; i++) {
+		for (j = 0; j < burst; j++) {
+			mbufs[j] = mbuf_free_build(pools, c, j);
+			if (mbufs[j] == NULL) {
+				rte_pktmbuf_free_bulk(mbufs, j);
+				printf("# mbuf_perf: cannot build %s packets\n",
+					mbuf_free_case_names[c]);
+				return -1;
+			}
+		}
+
+		t0 = rte_rdtsc();
+		if (bulk) {
+			rte_pktmbuf_free_bulk(mbufs, burst);
+		} else {
+			for (j = 0; j < burst; j++)
+				rte_pktmbuf_free(mbufs[j]);
+		}
+		cycles += rte_rdtsc() - t0;
+	}
+
+	for (j = 0; j < MBUF_FREE_NB_POOLS; j++) {
+		if (rte_mempool_full(pools[j]) == 0) {
+			printf("# mbuf_perf: %s free of %s packets leaks"
+				" mbufs\n", bulk ? "bulk" : "loop",
+				mbuf_free_case_names[c]);
+			return -1;
+		}
+	}
+
+	printf("test=mbuf_free op=%s case=%s burst=%u iter=%"PRIu64
+		" cycles=%.2f\n",
+		bulk ? "bulk" : "loop", mbuf_free_case_names[c], burst,
+		nb_iter, (double)cycles / (nb_iter * burst));
+	return 0;
+}
+
+static int
+mbuf_free_perf(struct rte_mempool *mp)
+{
+	struct rte_mempool *pools[MBUF_FREE_NB_POOLS];
+	char name[RTE_MEMPOOL_NAMESIZE];
+	unsigned c, i;
+	int bulk;
+
+	pools[0] = mp;
+	for (i = 1; i < MBUF_FREE_NB_POOLS; i++) {
+		snprintf(name, sizeof(name), "perf_mbuf_%u", i);
+		pools[i] = rte_pktmbuf_pool_create(name, MBUF_PERF_NB_MBUFS,
+			perf_cache_size, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			rte_socket_id());
+		if (pools[i] == NULL) {
+			printf("# cannot create mbuf pool %s\n", name);
+			return -1;
+		}
+	}
+
+	for (c = 0; c < MBUF_FREE_NB_CASES; c++) {
+		for (i = 0; i < RTE_DIM(mbuf_free_bursts); i++) {
+			for (bulk = 0; bulk <= 1; bulk++) {
+				if (mbuf_free_run(pools, c,
+						mbuf_free_bursts[i], bulk) != 0)
+					return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+int
+mbuf_perf(void)
+{
+	struct rte_mempool *mp;
+	unsigned op, nb_segs, i;
+	int bulk;
+
+	mp = rte_pktmbuf_pool_create("perf_mbuf", MBUF_PERF_NB_MBUFS,
+		perf_cache_size, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+		rte_socket_id());
+	if (mp == NULL) {
+		printf("# cannot create mbuf pool\n");
+		return -1;
+	}
+
+	for (op = 0; op < MBUF_PERF_NB_OPS; op++) {
+		for (nb_segs = 1; nb_segs <= MBUF_PERF_MAX_SEGS; nb_segs++) {
+			if (mbuf_perf_run(mp, op, nb_segs) != 0)
+				return -1;
+		}
+	}
+
+	for (i = 0; i < RTE_DIM(mbuf_alloc_bursts); i++) {
+		for (bulk = 0; bulk <= 1; bulk++) {
+			if (mbuf_alloc_run(mp, mbuf_alloc_bursts[i], bulk) != 0)
+				return -1;
+		}
+	}
+	return mbuf_free_perf(mp);
+}
@@ -0,0 +1,179 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Mempool tests: each lcore gets a chunk of objects from the pool in
+ * bulks of the tested size, then puts them back. The pool is shared by
+ * the lcores of the placement. The tests are run on a pool without
+ * cache, and on a pool with a per-lcore cache.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_mempool.h>
+
+#include "perf.h"
+
+#define MEMPOOL_PERF_CHUNK 512
+#define MEMPOOL_PERF_ELT_SIZE 64
+
+struct mempool_perf_args {
+	struct rte_mempool *mp;
+	unsigned size;
+	uint64_t get_cycles;
+	uint64_t put_cycles;
+	uint64_t nb_objs;
+} __rte_cache_aligned;
+
+static int
+mempool_perf_worker(void *arg)
+{
+	struct mempool_perf_args *a = arg;
+	void *objs[MEMPOOL_PERF_CHUNK];
+	unsigned chunk = MEMPOOL_PERF_CHUNK / a->size * a->size;
+	uint64_t done, t0, t1, t2;
+	unsigned i;
+
+	a->get_cycles = a->put_cycles = 0;
+	perf_sync_start();
+	for (done = 0; done < perf_nb_objs; done += chunk) {
+		t0 = rte_rdtsc();
+		for (i = 0; i < chunk; i += a->size) {
+			if (rte_mempool_get_bulk(a->mp, &objs[i],
+					a->size) < 0) {
+				printf("# cannot get objects from %s\n",
+					a->mp->name);
+				rte_mempool_put_bulk(a->mp, objs, i);
+				return -1;
+			}
+		}
+		t1 = rte_rdtsc();
+		for (i = 0; i < chunk; i += a->size)
+			rte_mempool_put_bulk(a->mp, &objs[i], a->size);
+		t2 = rte_rdtsc();
+		a->get_cycles += t1 - t0;
+		a->put_cycles += t2 - t1;
+	}
+	a->nb_objs = done;
+	return 0;
+}
+
+static int
+mempool_perf_run(struct rte_mempool *mp, enum perf_placement pl,
+	const unsigned *lcores, unsigned nb_lcores)
+{
+	struct mempool_perf_args args[PERF_MAX_LCORES];
+	lcore_function_t *f[PERF_MAX_LCORES];
+	void *pargs[PERF_MAX_LCORES];
+	uint64_t get_cycles, put_cycles, nb_objs;
+	char buf[32];
+	unsigned s, i;
+
+	for (s = 0; s < perf_nb_bulk_sizes; s++) {
+		for (i = 0; i < nb_lcores; i++) {
+			args[i].mp = mp;
+			args[i].size = perf_bulk_sizes[s];
+			f[i] = mempool_perf_worker;
+			pargs[i] = &args[i];
+		}
+		if (perf_launch(lcores, nb_lcores, f, pargs) != 0)
+			return -1;
+
+		get_cycles = put_cycles = nb_objs = 0;
+		for (i = 0; i < nb_lcores; i++) {
+			get_cycles += args[i].get_cycles;
+			put_cycles += args[i].put_cycles;
+			nb_objs += args[i].nb_objs;
+		}
+
+		printf("test=mempool_perf ops=%s cache=%u placement=%s"
+			" lcores=%s size=%u objs=%"PRIu64
+			" get_cycles=%.2f put_cycles=%.2f\n",
+			perf_mempool_ops, mp->cache_size,
+			perf_placement_names[pl],
+			perf_lcores_str(buf, sizeof(buf), lcores, nb_lcores),
+			perf_bulk_sizes[s], nb_objs,
+			(double)get_cycles / nb_objs,
+			(double)put_cycles / nb_objs);
+	}
+	return 0;
+}
+
+int
+mempool_perf(void)
+{
+	char name[RTE_MEMPOOL_NAMESIZE];
+	unsigned lcores[PERF_MAX_LCORES];
+	const unsigned cache_sizes[] = { 0, perf_cache_size };
+	unsigned c, pl, nb_lcores, n;
+	struct rte_mempool *mp;
+
+	for (c = 0; c < RTE_DIM(cache_sizes); c++) {
+		if (c != 0 && cache_sizes[c] == 0)
+			break;
+
+		/* each lcore holds a chunk, and its cache may hold up to
+		 * 1.5 times the cache size: keep twice that */
+		n = rte_align32pow2(PERF_MAX_LCORES * (MEMPOOL_PERF_CHUNK +
+			cache_sizes[c] * 2)) - 1;
+		snprintf(name, sizeof(name), "perf_cache%u", cache_sizes[c]);
+		mp = rte_mempool_create_with_ops(name, n,
+			MEMPOOL_PERF_ELT_SIZE, cache_sizes[c], 0,
+			NULL, NULL, NULL, NULL, rte_socket_id(), 0,
+			perf_mempool_ops);
+		if (mp == NULL) {
+			printf("# cannot create mempool %s\n", name);
+			return -1;
+		}
+
+		for (pl = 0; pl < PERF_NB_PLACEMENTS; pl++) {
+			nb_lcores = perf_find_lcores(pl, lcores);
+			if (nb_lcores == 0) {
+				if (c == 0)
+					printf("# mempool_perf: no lcores for"
+						" placement %s\n",
+						perf_placement_names[pl]);
+				continue;
+			}
+			if (mempool_perf_run(mp, pl, lcores, nb_lcores) != 0)
+				return -1;
+		}
+	}
+	return 0;
+}
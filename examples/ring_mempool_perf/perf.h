@@ -0,0 +1,101 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _PERF_H_
+#define _PERF_H_
+
+#include <stdint.h>
+#include <rte_launch.h>
+
+#define PERF_MAX_BULK 256  /**< Largest bulk size tested. */
+#define PERF_MAX_LCORES 2  /**< Lcores of a placement. */
+
+/** Where the lcores of a test run, relative to each other. */
+enum perf_placement {
+	PERF_SINGLE,  /**< One lcore. */
+	PERF_HT,      /**< Two hyperthreads of the same core. */
+	PERF_SOCKET,  /**< Two cores of the same socket. */
+	PERF_CROSS,   /**< Two cores on different sockets. */
+	PERF_NB_PLACEMENTS
+};
+
+/** Name of each placement, as printed in the results. */
+extern const char *perf_placement_names[PERF_NB_PLACEMENTS];
+
+/** Bulk sizes tested, from 1 to PERF_MAX_BULK. */
+extern const unsigned perf_bulk_sizes[];
+extern const unsigned perf_nb_bulk_sizes;
+
+/** Number of objects moved by each lcore in each test. */
+extern uint64_t perf_nb_objs;
+
+/** Cache size of the mempool tests that use a cache. */
+extern unsigned perf_cache_size;
+
+/** Backend of the mempools under test. */
+extern const char *perf_mempool_ops;
+
+/**
+ * Find lcores for a placement.
+ *
+ * @return
+ *   The number of lcores written in *lcores*, 0 if there are no such
+ *   lcores.
+ */
+unsigned perf_find_lcores(enum perf_placement pl,
+	unsigned lcores[PERF_MAX_LCORES]);
+
+/** Format a list of lcores as "a,b" in *buf*. */
+const char *perf_lcores_str(char *buf, unsigned len,
+	const unsigned *lcores, unsigned nb);
+
+/**
+ * Run f[i](args[i]) on lcores[i] and wait for all of them. The master
+ * lcore may be one of them.
+ *
+ * @return
+ *   0 if all functions returned 0.
+ */
+int perf_launch(const unsigned *lcores, unsigned nb, lcore_function_t **f,
+	void **args);
+
+/** Wait until all the lcores of perf_launch() are ready to start. */
+void perf_sync_start(void);
+
+int ring_perf(void);
+int mempool_perf(void);
+int mbuf_perf(void);
+int hash_perf(void);
+int port_perf(void);
+
+#endif /* _PERF_H_ */
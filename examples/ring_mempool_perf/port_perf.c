@@ -0,0 +1,402 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Ring port tests: packets go through a ring between a ring writer and a
+ * ring reader port, and the tests check how they are batched and counted.
+ *
+ * - batch: the reader batches bursts of PORT_PERF_BURST packets; it must
+ *   only deliver full bursts, and deliver the last partial burst once it
+ *   waited for the timeout.
+ * - drop: the writer fills a ring nobody reads; it must drop and free
+ *   exactly the packets that did not fit.
+ * - nodrop: on two lcores, a nodrop writer without retry limit feeds a
+ *   reader through a small ring; the backpressure must not lose any
+ *   packet. The cycles per packet of the consumer are printed.
+ *
+ * The port counters are checked when RTE_PORT_STATS_COLLECT is enabled.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_ring.h>
+#include <rte_mempool.h>
+#include <rte_mbuf.h>
+#include <rte_port_ring.h>
+
+#include "perf.h"
+
+#define PORT_PERF_NB_MBUFS 4095
+#define PORT_PERF_RING_SIZE 1024
+#define PORT_PERF_NODROP_RING_SIZE 64
+#define PORT_PERF_BURST 32
+#define PORT_PERF_FEED_BURST 7      /* packets given to the writer at once */
+#define PORT_PERF_BATCH_BURSTS 8
+#define PORT_PERF_BATCH_PARTIAL 13
+#define PORT_PERF_DROP_PKTS 2048
+#define PORT_PERF_MAX_WAIT_MS 1000  /* bound of the partial burst delay */
+
+static struct rte_mempool *port_perf_mp;
+
+/* compare the counters of a port with the expected ones */
+static int
+port_perf_check_stats(const char *name, uint64_t n_in, uint64_t n_drop,
+	uint64_t exp_in, uint64_t exp_drop)
+{
+#ifdef RTE_PORT_STATS_COLLECT
+	if (n_in != exp_in || n_drop != exp_drop) {
+		printf("# port_perf: %s counted in=%"PRIu64" drop=%"PRIu64
+			", expected in=%"PRIu64" drop=%"PRIu64"\n",
+			name, n_in, n_drop, exp_in, exp_drop);
+		return -1;
+	}
+#else
+	RTE_SET_USED(name);
+	RTE_SET_USED(n_in);
+	RTE_SET_USED(n_drop);
+	RTE_SET_USED(exp_in);
+	RTE_SET_USED(exp_drop);
+#endif
+	return 0;
+}
+
+static int
+port_perf_check_in(struct rte_port_in_ops *ops, void *port,
+	const char *name, uint64_t exp_in, uint64_t exp_drop)
+{
+	struct rte_port_in_stats stats;
+
+	ops->f_stats(port, &stats, 1);
+	return port_perf_check_stats(name, stats.n_pkts_in,
+		stats.n_pkts_drop, exp_in, exp_drop);
+}
+
+static int
+port_perf_check_out(struct rte_port_out_ops *ops, void *port,
+	const char *name, uint64_t exp_in, uint64_t exp_drop)
+{
+	struct rte_port_out_stats stats;
+
+	ops->f_stats(port, &stats, 1);
+	return port_perf_check_stats(name, stats.n_pkts_in,
+		stats.n_pkts_drop, exp_in, exp_drop);
+}
+
+/* allocate n packets and give them to a writer by small bursts */
+static int
+port_perf_feed(struct rte_port_out_ops *ops, void *port, uint64_t n)
+{
+	struct rte_mbuf *pkts[PORT_PERF_FEED_BURST];
+	unsigned b;
+
+	while (n != 0) {
+		b = RTE_MIN(n, (uint64_t)PORT_PERF_FEED_BURST);
+		if (rte_pktmbuf_alloc_bulk(port_perf_mp, pkts, b) != 0) {
+			printf("# port_perf: cannot allocate packets\n");
+			return -1;
+		}
+		ops->f_tx_bulk(port, pkts, (UINT64_C(1) << b) - 1);
+		n -= b;
+	}
+	ops->f_flush(port);
+	return 0;
+}
+
+/* free the packets left in a ring */
+static void
+port_perf_drain(struct rte_ring *r)
+{
+	struct rte_mbuf *pkts[PORT_PERF_BURST];
+	unsigned n;
+
+	do {
+		n = rte_ring_dequeue_burst(r, (void **)pkts, PORT_PERF_BURST);
+		rte_pktmbuf_free_bulk(pkts, n);
+	} while (n != 0);
+}
+
+static int
+port_perf_batch(struct rte_ring *r)
+{
+	struct rte_port_ring_writer_params wp = {
+		.ring = r,
+		.tx_burst_sz = PORT_PERF_BURST,
+	};
+	struct rte_port_ring_reader_params rp = {
+		.ring = r,
+		.rx_burst_sz = PORT_PERF_BURST,
+		.rx_timeout = rte_get_tsc_hz() / 1000,
+	};
+	struct rte_mbuf *pkts[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t max_wait, t0, t = 0;
+	unsigned nb_pkts, done = 0;
+	void *writer, *reader;
+	int n = 0, ret = -1;
+
+	nb_pkts = PORT_PERF_BATCH_BURSTS * PORT_PERF_BURST +
+		PORT_PERF_BATCH_PARTIAL;
+	writer = rte_port_ring_writer_ops.f_create(&wp, rte_socket_id());
+	reader = rte_port_ring_reader_ops.f_create(&rp, rte_socket_id());
+	if (writer == NULL || reader == NULL) {
+		printf("# port_perf: cannot create the ports\n");
+		goto out;
+	}
+	if (port_perf_feed(&rte_port_ring_writer_ops, writer, nb_pkts) != 0)
+		goto out;
+
+	/* the full bursts are delivered as soon as they are dequeued */
+	while (done < PORT_PERF_BATCH_BURSTS * PORT_PERF_BURST) {
+		n = rte_port_ring_reader_ops.f_rx(reader, pkts,
+			RTE_PORT_IN_BURST_SIZE_MAX);
+		if (n != PORT_PERF_BURST) {
+			printf("# port_perf: partial burst of %d packets\n",
+				n);
+			goto out;
+		}
+		rte_pktmbuf_free_bulk(pkts, n);
+		done += n;
+	}
+
+	/* the partial burst waits for the timeout */
+	max_wait = rte_get_tsc_hz() / 1000 * PORT_PERF_MAX_WAIT_MS;
+	t0 = rte_rdtsc();
+	do {
+		n = rte_port_ring_reader_ops.f_rx(reader, pkts,
+			RTE_PORT_IN_BURST_SIZE_MAX);
+		t = rte_rdtsc() - t0;
+	} while (n == 0 && t < max_wait);
+	rte_pktmbuf_free_bulk(pkts, n);
+	done += n;
+	if (n != PORT_PERF_BATCH_PARTIAL || t < rp.rx_timeout) {
+		printf("# port_perf: partial burst of %d packets after %"PRIu64
+			" cycles, expected %u after %"PRIu64"\n",
+			n, t, PORT_PERF_BATCH_PARTIAL, rp.rx_timeout);
+		goto out;
+	}
+
+	if (port_perf_check_out(&rte_port_ring_writer_ops, writer,
+			"ring_writer", nb_pkts, 0) != 0 ||
+	    port_perf_check_in(&rte_port_ring_reader_ops, reader,
+			"ring_reader", nb_pkts, 0) != 0)
+		goto out;
+
+	printf("test=port_batch burst=%u pkts=%u timeout=%"PRIu64
+		" flush_cycles=%"PRIu64"\n",
+		PORT_PERF_BURST, done, rp.rx_timeout, t);
+	ret = 0;
+out:
+	if (writer != NULL)
+		rte_port_ring_writer_ops.f_free(writer);
+	if (reader != NULL)
+		rte_port_ring_reader_ops.f_free(reader);
+	port_perf_drain(r);
+	return ret;
+}
+
+static int
+port_perf_drop(struct rte_ring *r)
+{
+	struct rte_port_ring_writer_params wp = {
+		.ring = r,
+		.tx_burst_sz = PORT_PERF_BURST,
+	};
+	unsigned in_use, nb_queued, nb_dropped;
+	void *writer;
+	int ret = -1;
+
+	writer = rte_port_ring_writer_ops.f_create(&wp, rte_socket_id());
+	if (writer == NULL) {
+		printf("# port_perf: cannot create the port\n");
+		return -1;
+	}
+	if (port_perf_feed(&rte_port_ring_writer_ops, writer,
+			PORT_PERF_DROP_PKTS) != 0)
+		goto out;
+
+	/* the ring is full, and the dropped packets are back in the pool */
+	nb_queued = rte_ring_count(r);
+	nb_dropped = PORT_PERF_DROP_PKTS - nb_queued;
+	in_use = PORT_PERF_NB_MBUFS - rte_mempool_count(port_perf_mp);
+	if (nb_queued != PORT_PERF_RING_SIZE - 1 || in_use != nb_queued) {
+		printf("# port_perf: %u packets in the ring, %u in use\n",
+			nb_queued, in_use);
+		goto out;
+	}
+	if (port_perf_check_out(&rte_port_ring_writer_ops, writer,
+			"ring_writer", PORT_PERF_DROP_PKTS, nb_dropped) != 0)
+		goto out;
+
+	printf("test=port_drop pkts=%u queued=%u dropped=%u\n",
+		PORT_PERF_DROP_PKTS, nb_queued, nb_dropped);
+	ret = 0;
+out:
+	rte_port_ring_writer_ops.f_free(writer);
+	port_perf_drain(r);
+	return ret;
+}
+
+struct port_perf_nodrop_args {
+	void *port;
+	uint64_t cycles;
+} __rte_cache_aligned;
+
+static int
+port_perf_nodrop_producer(void *arg)
+{
+	struct port_perf_nodrop_args *a = arg;
+
+	perf_sync_start();
+	return port_perf_feed(&rte_port_ring_writer_nodrop_ops, a->port,
+		perf_nb_objs);
+}
+
+static int
+port_perf_nodrop_consumer(void *arg)
+{
+	struct port_perf_nodrop_args *a = arg;
+	struct rte_mbuf *pkts[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t done = 0, t0;
+	int n;
+
+	perf_sync_start();
+	t0 = rte_rdtsc();
+	while (done < perf_nb_objs) {
+		n = rte_port_ring_reader_ops.f_rx(a->port, pkts,
+			RTE_PORT_IN_BURST_SIZE_MAX);
+		rte_pktmbuf_free_bulk(pkts, n);
+		done += n;
+	}
+	a->cycles = rte_rdtsc() - t0;
+	return 0;
+}
+
+static int
+port_perf_nodrop(struct rte_ring *r, enum perf_placement pl,
+	const unsigned *lcores)
+{
+	struct rte_port_ring_writer_nodrop_params wp = {
+		.ring = r,
+		.tx_burst_sz = PORT_PERF_BURST,
+		.n_retries = 0,
+	};
+	struct rte_port_ring_reader_params rp = {
+		.ring = r,
+		.rx_burst_sz = PORT_PERF_BURST,
+		.rx_timeout = rte_get_tsc_hz() / 1000,
+	};
+	struct port_perf_nodrop_args args[2];
+	lcore_function_t *f[2] = { port_perf_nodrop_producer,
+		port_perf_nodrop_consumer };
+	void *pargs[2] = { &args[0], &args[1] };
+	char buf[32];
+	int ret = -1;
+
+	args[0].port = rte_port_ring_writer_nodrop_ops.f_create(&wp,
+		rte_socket_id());
+	args[1].port = rte_port_ring_reader_ops.f_create(&rp,
+		rte_socket_id());
+	if (args[0].port == NULL || args[1].port == NULL) {
+		printf("# port_perf: cannot create the ports\n");
+		goto out;
+	}
+	if (perf_launch(lcores, 2, f, pargs) != 0)
+		goto out;
+
+	if (rte_ring_count(r) != 0 ||
+	    rte_mempool_count(port_perf_mp) != PORT_PERF_NB_MBUFS) {
+		printf("# port_perf: packets left after the nodrop test\n");
+		goto out;
+	}
+	if (port_perf_check_out(&rte_port_ring_writer_nodrop_ops,
+			args[0].port, "ring_writer_nodrop", perf_nb_objs,
+			0) != 0 ||
+	    port_perf_check_in(&rte_port_ring_reader_ops, args[1].port,
+			"ring_reader", perf_nb_objs, 0) != 0)
+		goto out;
+
+	printf("test=port_nodrop placement=%s lcores=%s ring=%u pkts=%"PRIu64
+		" cycles=%.2f\n",
+		perf_placement_names[pl],
+		perf_lcores_str(buf, sizeof(buf), lcores, 2),
+		PORT_PERF_NODROP_RING_SIZE, perf_nb_objs,
+		(double)args[1].cycles / perf_nb_objs);
+	ret = 0;
+out:
+	if (args[0].port != NULL)
+		rte_port_ring_writer_nodrop_ops.f_free(args[0].port);
+	if (args[1].port != NULL)
+		rte_port_ring_reader_ops.f_free(args[1].port);
+	port_perf_drain(r);
+	return ret;
+}
+
+int
+port_perf(void)
+{
+	unsigned lcores[PERF_MAX_LCORES];
+	struct rte_ring *r, *r_nodrop;
+	unsigned pl;
+
+	port_perf_mp = rte_pktmbuf_pool_create("perf_port",
+		PORT_PERF_NB_MBUFS, perf_cache_size, 0,
+		RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	r = rte_ring_create("perf_port", PORT_PERF_RING_SIZE,
+		rte_socket_id(), RING_F_SP_ENQ | RING_F_SC_DEQ);
+	r_nodrop = rte_ring_create("perf_port_nodrop",
+		PORT_PERF_NODROP_RING_SIZE, rte_socket_id(),
+		RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (port_perf_mp == NULL || r == NULL || r_nodrop == NULL) {
+		printf("# cannot create the port test pool or rings\n");
+		return -1;
+	}
+
+	if (port_perf_batch(r) != 0 || port_perf_drop(r) != 0)
+		return -1;
+
+	for (pl = PERF_HT; pl < PERF_NB_PLACEMENTS; pl++) {
+		if (perf_find_lcores(pl, lcores) == 0) {
+			printf("# port_perf: no lcores for placement %s\n",
+				perf_placement_names[pl]);
+			continue;
+		}
+		if (port_perf_nodrop(r_nodrop, pl, lcores) != 0)
+			return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,368 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Ring tests: on one lcore, chunks of objects are enqueued then dequeued
+ * in bulks of the tested size; on two lcores, one lcore enqueues and the
+ * other one dequeues. The cycles spent on each side are divided by the
+ * number of objects moved.
+ *
+ * The notify test checks the eventfd wakeup of a consumer that sleeps on
+ * an empty ring: a producer enqueues one object per round, either once
+ * the consumer is armed and asleep or while it is arming, and the
+ * consumer must be woken up before its timeout expires.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_ring.h>
+
+#include "perf.h"
+
+#define RING_PERF_SIZE 4096
+
+#define RING_NOTIFY_SIZE 64
+#define RING_NOTIFY_ROUNDS 256
+#define RING_NOTIFY_TIMEOUT_MS 1000 /* bound of a wakeup */
+#define RING_NOTIFY_SLEEP_US 100    /* let the consumer enter poll() */
+
+static const struct {
+	const char *name;
+	unsigned flags;
+} ring_modes[] = {
+	{ "sp_sc", RING_F_SP_ENQ | RING_F_SC_DEQ },
+	{ "mp_mc", 0 },
+	{ "rts", RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ },
+	{ "hts", RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ },
+};
+
+struct ring_perf_args {
+	struct rte_ring *r;
+	unsigned size;
+	int burst;
+	uint64_t cycles;
+} __rte_cache_aligned;
+
+/* the objects are never dereferenced */
+static void *ring_perf_objs[PERF_MAX_BULK];
+
+static inline unsigned
+ring_perf_enqueue(struct rte_ring *r, unsigned n, int burst)
+{
+	int ret;
+
+	if (burst)
+		return rte_ring_enqueue_burst(r, ring_perf_objs, n);
+	ret = rte_ring_enqueue_bulk(r, ring_perf_objs, n);
+	return (ret == 0 || ret == -EDQUOT) ? n : 0;
+}
+
+static inline unsigned
+ring_perf_dequeue(struct rte_ring *r, void **objs, unsigned n, int burst)
+{
+	if (burst)
+		return rte_ring_dequeue_burst(r, objs, n);
+	return (rte_ring_dequeue_bulk(r, objs, n) == 0) ? n : 0;
+}
+
+static int
+ring_perf_producer(void *arg)
+{
+	struct ring_perf_args *a = arg;
+	uint64_t done = 0, t0;
+
+	perf_sync_start();
+	t0 = rte_rdtsc();
+	while (done < perf_nb_objs)
+		done += ring_perf_enqueue(a->r,
+			RTE_MIN(a->size, perf_nb_objs - done), a->burst);
+	a->cycles = rte_rdtsc() - t0;
+	return 0;
+}
+
+static int
+ring_perf_consumer(void *arg)
+{
+	struct ring_perf_args *a = arg;
+	void *objs[PERF_MAX_BULK];
+	uint64_t done = 0, t0;
+
+	perf_sync_start();
+	t0 = rte_rdtsc();
+	while (done < perf_nb_objs)
+		done += ring_perf_dequeue(a->r, objs,
+			RTE_MIN(a->size, perf_nb_objs - done), a->burst);
+	a->cycles = rte_rdtsc() - t0;
+	return 0;
+}
+
+/* enqueue half a ring of objects, then dequeue them; return the number
+ * of objects moved */
+static uint64_t
+ring_perf_single(struct ring_perf_args *enq, struct ring_perf_args *deq)
+{
+	void *objs[PERF_MAX_BULK];
+	unsigned size = enq->size;
+	unsigned chunk = RING_PERF_SIZE / 2 / size * size;
+	uint64_t done, t0, t1, t2;
+	unsigned i;
+
+	enq->cycles = deq->cycles = 0;
+	for (done = 0; done < perf_nb_objs; done += chunk) {
+		t0 = rte_rdtsc();
+		for (i = 0; i < chunk; i += size)
+			ring_perf_enqueue(enq->r, size, enq->burst);
+		t1 = rte_rdtsc();
+		for (i = 0; i < chunk; i += size)
+			ring_perf_dequeue(deq->r, objs, size, deq->burst);
+		t2 = rte_rdtsc();
+		enq->cycles += t1 - t0;
+		deq->cycles += t2 - t1;
+	}
+	return done;
+}
+
+static int
+ring_perf_run(struct rte_ring *r, unsigned m, enum perf_placement pl,
+	const unsigned *lcores, unsigned nb_lcores)
+{
+	struct ring_perf_args args[2];
+	lcore_function_t *f[2] = { ring_perf_producer, ring_perf_consumer };
+	void *pargs[2] = { &args[0], &args[1] };
+	uint64_t nb_objs;
+	char buf[32];
+	unsigned s;
+	int burst;
+
+	for (burst = 0; burst <= 1; burst++) {
+		for (s = 0; s < perf_nb_bulk_sizes; s++) {
+			args[0].r = args[1].r = r;
+			args[0].size = args[1].size = perf_bulk_sizes[s];
+			args[0].burst = args[1].burst = burst;
+
+			if (nb_lcores == 1) {
+				nb_objs = ring_perf_single(&args[0], &args[1]);
+			} else {
+				if (perf_launch(lcores, 2, f, pargs) != 0)
+					return -1;
+				nb_objs = perf_nb_objs;
+			}
+
+			if (rte_ring_count(r) != 0) {
+				printf("# ring %s is not empty after the test\n",
+					r->name);
+				return -1;
+			}
+
+			printf("test=ring_perf mode=%s op=%s placement=%s"
+				" lcores=%s size=%u objs=%"PRIu64
+				" enq_cycles=%.2f deq_cycles=%.2f\n",
+				ring_modes[m].name, burst ? "burst" : "bulk",
+				perf_placement_names[pl],
+				perf_lcores_str(buf, sizeof(buf), lcores,
+					nb_lcores),
+				args[0].size, nb_objs,
+				(double)args[0].cycles / nb_objs,
+				(double)args[1].cycles / nb_objs);
+		}
+	}
+	return 0;
+}
+
+struct ring_notify_args {
+	struct rte_ring *r;
+	volatile unsigned ready;    /* rounds started by the consumer */
+	volatile uint64_t enq_tsc;  /* when the producer enqueued */
+	unsigned lost;              /* timeouts with a non-empty ring */
+	uint64_t cycles;            /* sum of the wakeup latencies */
+	uint64_t max_cycles;
+} __rte_cache_aligned;
+
+static int
+ring_notify_producer(void *arg)
+{
+	struct ring_notify_args *a = arg;
+	unsigned i;
+
+	perf_sync_start();
+	for (i = 0; i < RING_NOTIFY_ROUNDS; i++) {
+		while (a->ready != i + 1)
+			rte_pause();
+		/* on even rounds, enqueue once the consumer sleeps; on odd
+		 * rounds, race with the consumer that arms the wakeup */
+		if ((i & 1) == 0) {
+			while (a->r->notify.armed == 0)
+				rte_pause();
+			rte_delay_us(RING_NOTIFY_SLEEP_US);
+		}
+		a->enq_tsc = rte_rdtsc();
+		if (rte_ring_enqueue(a->r, ring_perf_objs) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+static int
+ring_notify_consumer(void *arg)
+{
+	struct ring_notify_args *a = arg;
+	uint64_t t;
+	unsigned i;
+	void *obj;
+	int ret;
+
+	perf_sync_start();
+	for (i = 0; i < RING_NOTIFY_ROUNDS; i++) {
+		a->ready = i + 1;
+		for (;;) {
+			ret = rte_ring_notify_wait(a->r,
+				RING_NOTIFY_TIMEOUT_MS);
+			t = rte_rdtsc();
+			if (ret != 0 && ret != -ETIMEDOUT)
+				return -1;
+			if (rte_ring_dequeue(a->r, &obj) == 0)
+				break;
+		}
+		/* the object was there when the timeout expired */
+		if (ret == -ETIMEDOUT)
+			a->lost++;
+		t -= a->enq_tsc;
+		a->cycles += t;
+		a->max_cycles = RTE_MAX(a->max_cycles, t);
+	}
+	return 0;
+}
+
+static int
+ring_notify_run(struct rte_ring *r, enum perf_placement pl,
+	const unsigned *lcores)
+{
+	struct ring_notify_args args;
+	lcore_function_t *f[2] = { ring_notify_producer,
+		ring_notify_consumer };
+	void *pargs[2] = { &args, &args };
+	char buf[32];
+	int fd;
+
+	fd = eventfd(0, 0);
+	if (fd < 0) {
+		printf("# cannot create eventfd\n");
+		return -1;
+	}
+	memset(&args, 0, sizeof(args));
+	args.r = r;
+	rte_ring_notify_register(r, fd);
+	if (perf_launch(lcores, 2, f, pargs) != 0) {
+		printf("# ring_notify: enqueue or wait failed\n");
+		args.lost = RING_NOTIFY_ROUNDS;
+	}
+	rte_ring_notify_unregister(r);
+	close(fd);
+
+	printf("test=ring_notify placement=%s lcores=%s rounds=%u lost=%u"
+		" wake_cycles=%.2f max_wake_cycles=%"PRIu64"\n",
+		perf_placement_names[pl],
+		perf_lcores_str(buf, sizeof(buf), lcores, 2),
+		RING_NOTIFY_ROUNDS, args.lost,
+		(double)args.cycles / RING_NOTIFY_ROUNDS, args.max_cycles);
+	return args.lost == 0 ? 0 : -1;
+}
+
+static int
+ring_notify(void)
+{
+	unsigned lcores[PERF_MAX_LCORES];
+	struct rte_ring *r;
+	unsigned pl;
+	int ret = 0;
+
+	r = rte_ring_create("perf_notify", RING_NOTIFY_SIZE, rte_socket_id(),
+		RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (r == NULL) {
+		printf("# cannot create ring perf_notify\n");
+		return -1;
+	}
+
+	for (pl = PERF_HT; pl < PERF_NB_PLACEMENTS; pl++) {
+		if (perf_find_lcores(pl, lcores) == 0) {
+			printf("# ring_notify: no lcores for placement %s\n",
+				perf_placement_names[pl]);
+			continue;
+		}
+		ret |= ring_notify_run(r, pl, lcores);
+	}
+	return ret;
+}
+
+int
+ring_perf(void)
+{
+	char name[RTE_RING_NAMESIZE];
+	unsigned lcores[PERF_MAX_LCORES];
+	unsigned m, pl, nb_lcores;
+	struct rte_ring *r;
+
+	for (m = 0; m < RTE_DIM(ring_modes); m++) {
+		snprintf(name, sizeof(name), "perf_%s", ring_modes[m].name);
+		r = rte_ring_create(name, RING_PERF_SIZE, rte_socket_id(),
+			ring_modes[m].flags);
+		if (r == NULL) {
+			printf("# cannot create ring %s\n", name);
+			return -1;
+		}
+
+		for (pl = 0; pl < PERF_NB_PLACEMENTS; pl++) {
+			nb_lcores = perf_find_lcores(pl, lcores);
+			if (nb_lcores == 0) {
+				if (m == 0)
+					printf("# ring_perf: no lcores for"
+						" placement %s\n",
+						perf_placement_names[pl]);
+				continue;
+			}
+			if (ring_perf_run(r, m, pl, lcores, nb_lcores) != 0)
+				return -1;
+		}
+	}
+	return ring_notify();
+}
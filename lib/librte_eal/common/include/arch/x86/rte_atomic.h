@@ -53,6 +53,13 @@ extern "C" {
 
 #define	rte_rmb() _mm_lfence()
 
+/* stores are not reordered with other stores, nor loads with other loads */
+#define rte_smp_mb() rte_mb()
+
+#define rte_smp_wmb() rte_compiler_barrier()
+
+#define rte_smp_rmb() rte_compiler_barrier()
+
 /*------------------------- 16 bit atomic operations -------------------------*/
 
 #ifndef RTE_FORCE_INTRINSICS
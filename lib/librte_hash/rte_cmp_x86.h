@@ -0,0 +1,177 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_CMP_X86_H_
+#define _RTE_CMP_X86_H_
+
+/*
+ * Comparison of keys of common lengths, and of a signature with all the
+ * signatures of a bucket, with SSE2 or AVX2 instructions.
+ *
+ * The key comparison functions return 0 if the keys are equal, like
+ * memcmp(); the keys may be unaligned.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_vect.h>
+
+static inline uint32_t
+rte_hash_load32(const void *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint64_t
+rte_hash_load64(const void *p)
+{
+	uint64_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline int
+rte_hash_k4_cmp_eq(const void *key1, const void *key2)
+{
+	return rte_hash_load32(key1) != rte_hash_load32(key2);
+}
+
+static inline int
+rte_hash_k8_cmp_eq(const void *key1, const void *key2)
+{
+	return rte_hash_load64(key1) != rte_hash_load64(key2);
+}
+
+/* IPv4 5-tuple: two 8-byte words overlapping on 3 bytes */
+static inline int
+rte_hash_k13_cmp_eq(const void *key1, const void *key2)
+{
+	const uint8_t *k1 = key1, *k2 = key2;
+
+	return ((rte_hash_load64(k1) ^ rte_hash_load64(k2)) |
+		(rte_hash_load64(k1 + 5) ^ rte_hash_load64(k2 + 5))) != 0;
+}
+
+static inline int
+rte_hash_k16_cmp_eq(const void *key1, const void *key2)
+{
+	const __m128i k1 = _mm_loadu_si128((const __m128i *)key1);
+	const __m128i k2 = _mm_loadu_si128((const __m128i *)key2);
+
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(k1, k2)) != 0xffff;
+}
+
+static inline int
+rte_hash_k32_cmp_eq(const void *key1, const void *key2)
+{
+	const uint8_t *k1 = key1, *k2 = key2;
+
+	return rte_hash_k16_cmp_eq(k1, k2) |
+		rte_hash_k16_cmp_eq(k1 + 16, k2 + 16);
+}
+
+/* IPv6 5-tuple padded to 40 bytes */
+static inline int
+rte_hash_k40_cmp_eq(const void *key1, const void *key2)
+{
+	const uint8_t *k1 = key1, *k2 = key2;
+
+	return rte_hash_k32_cmp_eq(k1, k2) |
+		rte_hash_k8_cmp_eq(k1 + 32, k2 + 32);
+}
+
+static inline int
+rte_hash_k64_cmp_eq(const void *key1, const void *key2)
+{
+	const uint8_t *k1 = key1, *k2 = key2;
+
+	return rte_hash_k32_cmp_eq(k1, k2) |
+		rte_hash_k32_cmp_eq(k1 + 32, k2 + 32);
+}
+
+/*
+ * Bitmask of the signatures of a bucket equal to sig. The bucket is 16-byte
+ * aligned and padded to a multiple of 4 signatures, nb_sigs is at most 16.
+ */
+static inline uint32_t
+rte_hash_sig_match_sse2(const uint32_t *sigs, uint32_t nb_sigs, uint32_t sig)
+{
+	const __m128i s = _mm_set1_epi32(sig);
+	uint32_t i, mask = 0;
+
+	for (i = 0; i < nb_sigs; i += 4)
+		mask |= (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(
+			_mm_cmpeq_epi32(s, _mm_load_si128(
+				(const __m128i *)&sigs[i])))) << i;
+	return mask & ((1U << nb_sigs) - 1);
+}
+
+#ifdef __AVX2__
+/* Same as rte_hash_sig_match_sse2(), for buckets of 8 or 16 signatures. */
+static inline uint32_t
+rte_hash_sig_match_avx2(const uint32_t *sigs, uint32_t nb_sigs, uint32_t sig)
+{
+	const __m256i s = _mm256_set1_epi32(sig);
+	uint32_t i, mask = 0;
+
+	for (i = 0; i < nb_sigs; i += 8)
+		mask |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(
+			_mm256_cmpeq_epi32(s, _mm256_loadu_si256(
+				(const __m256i *)&sigs[i])))) << i;
+	return mask;
+}
+#endif
+
+/*
+ * Bitmask of the 4 entries of a cuckoo bucket whose current and
+ * alternative signatures are both equal to the given ones. Both arrays are
+ * 16-byte aligned.
+ */
+static inline uint32_t
+rte_hash_sig_pair_match_sse2(const uint32_t *sigs_current,
+	const uint32_t *sigs_alt, uint32_t sig_current, uint32_t sig_alt)
+{
+	const __m128i cur = _mm_cmpeq_epi32(_mm_set1_epi32(sig_current),
+		_mm_load_si128((const __m128i *)sigs_current));
+	const __m128i alt = _mm_cmpeq_epi32(_mm_set1_epi32(sig_alt),
+		_mm_load_si128((const __m128i *)sigs_alt));
+
+	return _mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(cur, alt)));
+}
+
+#endif /* _RTE_CMP_X86_H_ */
@@ -49,14 +49,19 @@
 #include <rte_eal.h>
 #include <rte_eal_memconfig.h>
 #include <rte_per_lcore.h>
+#include <rte_lcore.h>
 #include <rte_errno.h>
 #include <rte_string_fns.h>
 #include <rte_cpuflags.h>
 #include <rte_log.h>
 #include <rte_rwlock.h>
 #include <rte_spinlock.h>
+#include <rte_ring.h>
 
 #include "rte_hash.h"
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_I686)
+#include "rte_cmp_x86.h"
+#endif
 
 TAILQ_HEAD(rte_hash_list, rte_tailq_entry);
 
@@ -115,6 +120,21 @@ get_key_from_bucket(const struct rte_hash *h, uint8_t *bkt, uint32_t pos)
 	return RTE_PTR_ADD(bkt, pos * h->key_tbl_key_size);
 }
 
+/* Sets the user data stored with a key; lookups may be reading it. */
+static inline void
+set_key_data(const struct rte_hash *h, void *stored_key, void *data)
+{
+	*(void * volatile *)RTE_PTR_ADD(stored_key, h->key_data_offset) =
+		data;
+}
+
+static inline void *
+get_key_data(const struct rte_hash *h, const void *stored_key)
+{
+	return *(void * const volatile *)RTE_PTR_ADD(stored_key,
+		h->key_data_offset);
+}
+
 /* Does integer division with rounding-up of result. */
 static inline uint32_t
 div_roundup(uint32_t numerator, uint32_t denominator)
@@ -129,18 +149,1048 @@ align_size(uint32_t val, uint32_t alignment)
 	return alignment * div_roundup(val, alignment);
 }
 
-/* Returns the index into the bucket of the first occurrence of a signature. */
+/* Key comparison functions, chosen from the key length */
+enum {
+	KEY_CMP_MEMCMP = 0,
+	KEY_CMP_4,
+	KEY_CMP_8,
+	KEY_CMP_13,
+	KEY_CMP_16,
+	KEY_CMP_32,
+	KEY_CMP_40,
+	KEY_CMP_64,
+};
+
+/* Signature comparison instructions, chosen from the CPU flags */
+enum {
+	SIG_CMP_SCALAR = 0,
+	SIG_CMP_SSE2,
+	SIG_CMP_AVX2,
+};
+
+/* Compares two keys, returns 0 if they are equal. */
 static inline int
-find_first(uint32_t sig, const uint32_t *sig_bucket, uint32_t num_sigs)
+rte_hash_cmp_eq(const struct rte_hash *h, const void *key1, const void *key2)
+{
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_I686)
+	switch (h->key_cmp) {
+	case KEY_CMP_4:
+		return rte_hash_k4_cmp_eq(key1, key2);
+	case KEY_CMP_8:
+		return rte_hash_k8_cmp_eq(key1, key2);
+	case KEY_CMP_13:
+		return rte_hash_k13_cmp_eq(key1, key2);
+	case KEY_CMP_16:
+		return rte_hash_k16_cmp_eq(key1, key2);
+	case KEY_CMP_32:
+		return rte_hash_k32_cmp_eq(key1, key2);
+	case KEY_CMP_40:
+		return rte_hash_k40_cmp_eq(key1, key2);
+	case KEY_CMP_64:
+		return rte_hash_k64_cmp_eq(key1, key2);
+	default:
+		break;
+	}
+#endif
+	return memcmp(key1, key2, h->key_len);
+}
+
+/* Returns a bitmask of the entries of a bucket equal to a signature. */
+static inline uint32_t
+sig_match(const struct rte_hash *h, const hash_sig_t *sig_bucket,
+	hash_sig_t sig)
+{
+	uint32_t i, mask = 0;
+
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_I686)
+	switch (h->sig_cmp) {
+#ifdef __AVX2__
+	case SIG_CMP_AVX2:
+		return rte_hash_sig_match_avx2(sig_bucket, h->bucket_entries,
+			sig);
+#endif
+	case SIG_CMP_SSE2:
+		return rte_hash_sig_match_sse2(sig_bucket, h->bucket_entries,
+			sig);
+	default:
+		break;
+	}
+#endif
+	for (i = 0; i < h->bucket_entries; i++)
+		mask |= (uint32_t)(sig_bucket[i] == sig) << i;
+	return mask;
+}
+
+/* Choose the comparison functions of a new table. */
+static void
+rte_hash_cmp_init(struct rte_hash *h)
+{
+	switch (h->key_len) {
+	case 4:
+		h->key_cmp = KEY_CMP_4;
+		break;
+	case 8:
+		h->key_cmp = KEY_CMP_8;
+		break;
+	case 13:
+		h->key_cmp = KEY_CMP_13;
+		break;
+	case 16:
+		h->key_cmp = KEY_CMP_16;
+		break;
+	case 32:
+		h->key_cmp = KEY_CMP_32;
+		break;
+	case 40:
+		h->key_cmp = KEY_CMP_40;
+		break;
+	case 64:
+		h->key_cmp = KEY_CMP_64;
+		break;
+	default:
+		h->key_cmp = KEY_CMP_MEMCMP;
+		break;
+	}
+
+	h->sig_cmp = SIG_CMP_SCALAR;
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_I686)
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE2) > 0)
+		h->sig_cmp = SIG_CMP_SSE2;
+#ifdef __AVX2__
+	/* 8 signatures at once */
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) > 0 &&
+	    h->bucket_entries >= 8)
+		h->sig_cmp = SIG_CMP_AVX2;
+#endif
+#endif
+}
+
+/*
+ * Cuckoo hash tables.
+ *
+ * The keys are copied in a key store, at an index taken from a ring of
+ * free indexes. That index minus one is the position returned by the API,
+ * so it does not change when the key moves between its buckets. Each
+ * bucket entry holds the index of a key and two hash values: the current
+ * one, which selects the bucket the entry is in, and the alternative one,
+ * which selects the other candidate bucket of the key.
+ *
+ * Lookups need no lock against the thread adding and deleting keys. A
+ * bucket entry is published by writing its key index last, and a key
+ * being moved is written at its new place before its old place is
+ * overwritten. A lookup may still miss a key that moves behind it, so
+ * each move increments a change counter, and a lookup that finds
+ * nothing searches again if the counter changed meanwhile.
+ *
+ * With several writers, each bucket is protected by one of a set of
+ * striped locks. An insert that finds an empty entry in one of its two
+ * buckets only locks these buckets. Otherwise, the path of keys to move
+ * is searched without lock, then the buckets along it are locked and the
+ * path is checked again before the keys are moved; only an insert in the
+ * stash, or a path changed too many times by other writers, needs all
+ * the locks. A delete locks the two buckets of its key, and a stash lock
+ * if the stash is used. When the CPU has transactional memory, a single
+ * lock is elided instead, so that writers only serialize when they touch
+ * the same buckets. Free key indexes are cached per lcore.
+ */
+
+/* Key index of an empty bucket entry: entry 0 of the key store is unused */
+#define EMPTY_SLOT              0
+
+/* Maximum number of buckets visited when searching room for a key */
+#define RTE_HASH_BFS_QUEUE_MAX_LEN      512
+
+/* Maximum length of a path of keys moved to make room for a key */
+#define RTE_HASH_BFS_PATH_MAX_LEN       8
+
+/* Number of bucket locks of a table with several writers */
+#define RTE_HASH_LOCK_STRIPES           64
+
+/* Searches of a path invalidated by other writers before locking all */
+#define RTE_HASH_PATH_RETRIES           4
+
+/* Free key indexes moved at once between an lcore cache and the ring */
+#define LCORE_CACHE_SIZE                64
+
+struct rte_hash_bucket {
+	hash_sig_t sig_current[RTE_HASH_CUCKOO_BUCKET_ENTRIES];
+	hash_sig_t sig_alt[RTE_HASH_CUCKOO_BUCKET_ENTRIES];
+	uint32_t key_idx[RTE_HASH_CUCKOO_BUCKET_ENTRIES];
+} __rte_cache_aligned;
+
+/* Key that did not fit in its buckets, with its primary hash value */
+struct rte_hash_stash_entry {
+	hash_sig_t sig;
+	uint32_t key_idx;
+};
+
+struct rte_hash_lock {
+	rte_spinlock_t sl;
+} __rte_cache_aligned;
+
+struct lcore_cache {
+	unsigned len;
+	void *objs[LCORE_CACHE_SIZE * 2];
+} __rte_cache_aligned;
+
+struct rte_hash_cuckoo {
+	struct rte_hash_bucket *buckets;	/* Table of buckets. */
+	uint8_t *key_store;		/* Keys, by key index. */
+	uint32_t key_entry_size;	/* Size of a key in the key store. */
+	struct rte_ring *free_slots;	/* Free key indexes. */
+	struct lcore_cache *local_free_slots;	/* Free key indexes cached
+					   by each lcore, or NULL. */
+	struct rte_hash_lock *locks;	/* Bucket locks, NULL if there is
+					   a single writer. */
+	uint32_t lock_mask;		/* Lock of a bucket index. */
+	int use_tm;			/* Elide locks[0] instead of using
+					   the bucket locks. */
+	int rw_concurrency_lf;		/* Deleted key indexes are freed
+					   by the application. */
+	volatile uint32_t tbl_chng_cnt;	/* Number of keys moved. */
+	uint32_t stash_entries;		/* Size of the stash. */
+	volatile uint32_t stash_count;	/* Number of keys in the stash. */
+	rte_spinlock_t stash_lock;	/* Stash lock of the deletes, taken
+					   after bucket locks. */
+	struct rte_hash_stash_entry stash[0];
+};
+
+/* Node of the breadth-first search of room for a key */
+struct cuckoo_queue_node {
+	struct rte_hash_bucket *bkt;
+	int prev;		/* Parent node, -1 for a candidate bucket. */
+	unsigned prev_slot;	/* Entry of the parent that would move here. */
+};
+
+/* Keys to move to make room for a key: the key in entry slot[i] of
+ * bkt[i] moves to bkt[i + 1], and slot[len] of bkt[len] is empty. */
+struct cuckoo_path {
+	unsigned len;
+	struct rte_hash_bucket *bkt[RTE_HASH_BFS_PATH_MAX_LEN + 1];
+	unsigned slot[RTE_HASH_BFS_PATH_MAX_LEN + 1];
+};
+
+/* Hash value selecting the alternative bucket of a key */
+static inline hash_sig_t
+rte_hash_secondary_hash(const hash_sig_t primary_hash)
+{
+	static const unsigned all_bits_shift = 12;
+	static const unsigned alt_bits_xor = 0x5bd1e995;
+
+	uint32_t tag = primary_hash >> all_bits_shift;
+
+	return primary_hash ^ ((tag + 1) * alt_bits_xor);
+}
+
+static inline struct rte_hash_bucket *
+cuckoo_bucket(const struct rte_hash *h, hash_sig_t sig)
+{
+	return &h->cuckoo->buckets[sig & h->bucket_bitmask];
+}
+
+static inline void *
+cuckoo_key(const struct rte_hash_cuckoo *c, uint32_t key_idx)
+{
+	return c->key_store + (size_t)key_idx * c->key_entry_size;
+}
+
+/* Take a free key index, or return EMPTY_SLOT if there is none. */
+static inline uint32_t
+cuckoo_alloc_key_idx(struct rte_hash_cuckoo *c)
+{
+	unsigned lcore_id = rte_lcore_id();
+	struct lcore_cache *cache;
+	void *obj;
+
+	if (c->local_free_slots == NULL || lcore_id >= RTE_MAX_LCORE) {
+		if (rte_ring_dequeue(c->free_slots, &obj) != 0)
+			return EMPTY_SLOT;
+		return (uint32_t)(uintptr_t)obj;
+	}
+
+	cache = &c->local_free_slots[lcore_id];
+	if (cache->len == 0) {
+		cache->len = rte_ring_dequeue_burst(c->free_slots, cache->objs,
+			LCORE_CACHE_SIZE);
+		if (cache->len == 0)
+			return EMPTY_SLOT;
+	}
+	return (uint32_t)(uintptr_t)cache->objs[--cache->len];
+}
+
+static inline void
+cuckoo_free_key_idx(struct rte_hash_cuckoo *c, uint32_t key_idx)
+{
+	unsigned lcore_id = rte_lcore_id();
+	struct lcore_cache *cache;
+	void *obj = (void *)(uintptr_t)key_idx;
+
+	if (c->local_free_slots == NULL || lcore_id >= RTE_MAX_LCORE) {
+		rte_ring_enqueue(c->free_slots, obj);
+		return;
+	}
+
+	/* the ring has room for all the indexes */
+	cache = &c->local_free_slots[lcore_id];
+	cache->objs[cache->len++] = obj;
+	if (cache->len == RTE_DIM(cache->objs))
+		cache->len -= rte_ring_enqueue_burst(c->free_slots,
+			&cache->objs[LCORE_CACHE_SIZE], LCORE_CACHE_SIZE);
+}
+
+/* Lock the buckets of a key, or all of them if there is a single lock. */
+static inline void
+cuckoo_lock(const struct rte_hash *h, hash_sig_t sig, hash_sig_t alt)
+{
+	const struct rte_hash_cuckoo *c = h->cuckoo;
+	uint32_t l1, l2;
+
+	if (c->use_tm) {
+		rte_spinlock_lock_tm(&c->locks[0].sl);
+		return;
+	}
+
+	/* always in the same order, not to deadlock */
+	l1 = sig & h->bucket_bitmask & c->lock_mask;
+	l2 = alt & h->bucket_bitmask & c->lock_mask;
+	rte_spinlock_lock(&c->locks[RTE_MIN(l1, l2)].sl);
+	if (l1 != l2)
+		rte_spinlock_lock(&c->locks[RTE_MAX(l1, l2)].sl);
+}
+
+static inline void
+cuckoo_unlock(const struct rte_hash *h, hash_sig_t sig, hash_sig_t alt)
+{
+	const struct rte_hash_cuckoo *c = h->cuckoo;
+	uint32_t l1, l2;
+
+	if (c->use_tm) {
+		rte_spinlock_unlock_tm(&c->locks[0].sl);
+		return;
+	}
+
+	l1 = sig & h->bucket_bitmask & c->lock_mask;
+	l2 = alt & h->bucket_bitmask & c->lock_mask;
+	if (l1 != l2)
+		rte_spinlock_unlock(&c->locks[RTE_MAX(l1, l2)].sl);
+	rte_spinlock_unlock(&c->locks[RTE_MIN(l1, l2)].sl);
+}
+
+/* Lock all the buckets, to move keys or use the stash. */
+static void
+cuckoo_lock_all(const struct rte_hash_cuckoo *c)
 {
 	uint32_t i;
-	for (i = 0; i < num_sigs; i++) {
-		if (sig == sig_bucket[i])
+
+	for (i = 0; i <= c->lock_mask; i++)
+		rte_spinlock_lock(&c->locks[i].sl);
+}
+
+static void
+cuckoo_unlock_all(const struct rte_hash_cuckoo *c)
+{
+	uint32_t i;
+
+	for (i = 0; i <= c->lock_mask; i++)
+		rte_spinlock_unlock(&c->locks[i].sl);
+}
+
+/* Read a key index once, it may be changed by the writer meanwhile. */
+static inline uint32_t
+cuckoo_read_idx(const uint32_t *key_idx)
+{
+	return *(const volatile uint32_t *)key_idx;
+}
+
+static inline void
+cuckoo_bucket_set(struct rte_hash_bucket *bkt, unsigned i,
+	hash_sig_t sig_current, hash_sig_t sig_alt, uint32_t key_idx)
+{
+	bkt->sig_current[i] = sig_current;
+	bkt->sig_alt[i] = sig_alt;
+	rte_smp_wmb();
+	*(volatile uint32_t *)&bkt->key_idx[i] = key_idx;
+}
+
+/* A key was written at its new place, its old place is overwritten next. */
+static inline void
+cuckoo_key_moved(struct rte_hash_cuckoo *c)
+{
+	rte_smp_wmb();
+	c->tbl_chng_cnt++;
+	rte_smp_wmb();
+}
+
+/* Returns a bitmask of the entries of a bucket with the given hash
+ * values. */
+static inline uint32_t
+cuckoo_sig_match(const struct rte_hash *h, const struct rte_hash_bucket *bkt,
+	hash_sig_t sig_current, hash_sig_t sig_alt)
+{
+	uint32_t i, mask = 0;
+
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_I686)
+	if (h->sig_cmp != SIG_CMP_SCALAR)
+		return rte_hash_sig_pair_match_sse2(bkt->sig_current,
+			bkt->sig_alt, sig_current, sig_alt);
+#endif
+	for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES; i++)
+		mask |= (uint32_t)(bkt->sig_current[i] == sig_current &&
+				   bkt->sig_alt[i] == sig_alt) << i;
+	return mask;
+}
+
+/* Returns the entry of a bucket holding a key and sets its key index, or
+ * returns -1. */
+static inline int
+cuckoo_bucket_find(const struct rte_hash *h, const struct rte_hash_bucket *bkt,
+	const void *key, hash_sig_t sig_current, hash_sig_t sig_alt,
+	uint32_t *key_idx)
+{
+	uint32_t idx, mask;
+	unsigned i;
+
+	mask = cuckoo_sig_match(h, bkt, sig_current, sig_alt);
+	for (; mask != 0; mask &= mask - 1) {
+		i = __builtin_ctz(mask);
+		idx = cuckoo_read_idx(&bkt->key_idx[i]);
+		if (idx != EMPTY_SLOT &&
+		    likely(rte_hash_cmp_eq(h, key,
+					   cuckoo_key(h->cuckoo, idx)) == 0)) {
+			*key_idx = idx;
+			return i;
+		}
+	}
+	return -1;
+}
+
+/* Returns the first empty entry of a bucket, or -1. */
+static inline int
+cuckoo_bucket_find_empty(const struct rte_hash_bucket *bkt)
+{
+	unsigned i;
+
+	for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES; i++) {
+		if (bkt->key_idx[i] == EMPTY_SLOT)
+			return i;
+	}
+	return -1;
+}
+
+/* Returns the stash entry holding a key and sets its key index, or
+ * returns -1. */
+static inline int
+cuckoo_stash_find(const struct rte_hash *h, const void *key, hash_sig_t sig,
+	uint32_t *key_idx)
+{
+	const struct rte_hash_cuckoo *c = h->cuckoo;
+	unsigned i, n = c->stash_count;
+	uint32_t idx;
+
+	rte_smp_rmb();
+	for (i = 0; i < n; i++) {
+		if (c->stash[i].sig != sig)
+			continue;
+		idx = cuckoo_read_idx(&c->stash[i].key_idx);
+		if (rte_hash_cmp_eq(h, key, cuckoo_key(c, idx)) == 0) {
+			*key_idx = idx;
 			return i;
+		}
 	}
 	return -1;
 }
 
+/* Remove an entry of the stash, moving the last one in its place. */
+static inline void
+cuckoo_stash_remove(struct rte_hash_cuckoo *c, unsigned i)
+{
+	unsigned last = c->stash_count - 1;
+
+	if (i != last) {
+		c->stash[i].sig = c->stash[last].sig;
+		rte_smp_wmb();
+		c->stash[i].key_idx = c->stash[last].key_idx;
+		cuckoo_key_moved(c);
+	}
+	c->stash_count = last;
+}
+
+static inline int32_t
+cuckoo_lookup(const struct rte_hash *h, const void *key, hash_sig_t sig,
+	hash_sig_t alt)
+{
+	const struct rte_hash_cuckoo *c = h->cuckoo;
+	uint32_t chng_cnt, key_idx;
+
+	do {
+		chng_cnt = c->tbl_chng_cnt;
+		rte_smp_rmb();
+
+		if (cuckoo_bucket_find(h, cuckoo_bucket(h, sig), key, sig,
+				       alt, &key_idx) >= 0 ||
+		    cuckoo_bucket_find(h, cuckoo_bucket(h, alt), key, alt,
+				       sig, &key_idx) >= 0)
+			return key_idx - 1;
+
+		if (unlikely(c->stash_count != 0) &&
+		    cuckoo_stash_find(h, key, sig, &key_idx) >= 0)
+			return key_idx - 1;
+
+		/* the key may have moved behind us: search again */
+		rte_smp_rmb();
+	} while (unlikely(chng_cnt != c->tbl_chng_cnt));
+
+	return -ENOENT;
+}
+
+static inline int32_t
+__rte_hash_cuckoo_lookup_with_hash(const struct rte_hash *h,
+	const void *key, hash_sig_t sig)
+{
+	return cuckoo_lookup(h, key, sig, rte_hash_secondary_hash(sig));
+}
+
+/*
+ * Search room in one of two full buckets, moving keys to their
+ * alternative bucket. The search is breadth-first, so that the path of
+ * keys to move is the shortest. Returns 0 and sets the path, or returns
+ * -ENOSPC.
+ */
+static int
+cuckoo_find_path(const struct rte_hash *h, struct rte_hash_bucket *prim_bkt,
+	struct rte_hash_bucket *sec_bkt, struct cuckoo_path *p)
+{
+	struct cuckoo_queue_node queue[RTE_HASH_BFS_QUEUE_MAX_LEN];
+	struct cuckoo_queue_node *node;
+	struct rte_hash_bucket *bkt, *tmp_bkt;
+	unsigned head = 0, tail = 0, len, i, j, tmp_slot;
+	int slot, dup;
+
+	queue[tail].bkt = prim_bkt;
+	queue[tail++].prev = -1;
+	queue[tail].bkt = sec_bkt;
+	queue[tail++].prev = -1;
+
+	for (; head < tail; head++) {
+		node = &queue[head];
+		bkt = node->bkt;
+
+		slot = cuckoo_bucket_find_empty(bkt);
+		if (slot < 0) {
+			for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES &&
+			     tail < RTE_HASH_BFS_QUEUE_MAX_LEN; i++) {
+				queue[tail].bkt = cuckoo_bucket(h,
+					bkt->sig_alt[i]);
+				queue[tail].prev = head;
+				queue[tail++].prev_slot = i;
+			}
+			continue;
+		}
+
+		/* Walk back to a candidate bucket. A path going twice
+		 * through a bucket would move a key already moved: look
+		 * for another one */
+		p->bkt[0] = bkt;
+		p->slot[0] = slot;
+		for (len = 0, dup = 0; node->prev >= 0 && !dup; len++) {
+			if (len == RTE_HASH_BFS_PATH_MAX_LEN) {
+				dup = 1;
+				break;
+			}
+			i = node->prev_slot;
+			node = &queue[node->prev];
+			for (j = 0; j <= len; j++)
+				dup |= (p->bkt[j] == node->bkt);
+			p->bkt[len + 1] = node->bkt;
+			p->slot[len + 1] = i;
+		}
+		if (dup)
+			continue;
+
+		/* Start the path from the candidate bucket */
+		for (j = 0; j < (len + 1) / 2; j++) {
+			tmp_bkt = p->bkt[j];
+			p->bkt[j] = p->bkt[len - j];
+			p->bkt[len - j] = tmp_bkt;
+			tmp_slot = p->slot[j];
+			p->slot[j] = p->slot[len - j];
+			p->slot[len - j] = tmp_slot;
+		}
+		p->len = len;
+		return 0;
+	}
+
+	return -ENOSPC;
+}
+
+/* Check that a path found without lock can still be used: its keys
+ * still move to the next bucket, and its last entry is still empty. */
+static int
+cuckoo_path_valid(const struct rte_hash *h, const struct cuckoo_path *p)
+{
+	const struct rte_hash_bucket *bkt;
+	unsigned i, slot;
+
+	for (i = 0; i < p->len; i++) {
+		bkt = p->bkt[i];
+		slot = p->slot[i];
+		if (bkt->key_idx[slot] == EMPTY_SLOT ||
+		    cuckoo_bucket(h, bkt->sig_alt[slot]) != p->bkt[i + 1])
+			return 0;
+	}
+	return p->bkt[p->len]->key_idx[p->slot[p->len]] == EMPTY_SLOT;
+}
+
+/* Move the keys of a path, from its end backwards, so that each of them
+ * is always in one of its buckets. The first entry of the path is then
+ * free. */
+static void
+cuckoo_move_path(const struct rte_hash *h, const struct cuckoo_path *p)
+{
+	const struct rte_hash_bucket *from;
+	unsigned i, slot;
+
+	for (i = p->len; i > 0; i--) {
+		from = p->bkt[i - 1];
+		slot = p->slot[i - 1];
+		cuckoo_bucket_set(p->bkt[i], p->slot[i], from->sig_alt[slot],
+			from->sig_current[slot], from->key_idx[slot]);
+		cuckoo_key_moved(h->cuckoo);
+	}
+}
+
+/*
+ * Make room in one of two full buckets. Returns the free entry and sets
+ * the bucket it is in, or returns -ENOSPC.
+ */
+static int
+cuckoo_make_space(const struct rte_hash *h, struct rte_hash_bucket *prim_bkt,
+	struct rte_hash_bucket *sec_bkt, struct rte_hash_bucket **root)
+{
+	struct cuckoo_path p;
+
+	if (cuckoo_find_path(h, prim_bkt, sec_bkt, &p) != 0)
+		return -ENOSPC;
+	cuckoo_move_path(h, &p);
+	*root = p.bkt[0];
+	return p.slot[0];
+}
+
+/*
+ * Insert the key at key_idx of the key store, which is not in the table.
+ * Keys are only moved, and the stash only used, if slow is set. Returns
+ * the position of the key, -EAGAIN if there was no empty entry in its
+ * buckets and slow is not set, or -ENOSPC.
+ */
+static int32_t
+cuckoo_insert(const struct rte_hash *h, hash_sig_t sig, hash_sig_t alt,
+	uint32_t key_idx, int slow)
+{
+	struct rte_hash_cuckoo *c = h->cuckoo;
+	struct rte_hash_bucket *prim_bkt, *sec_bkt, *bkt;
+	int slot;
+
+	/* Free entry in one of the buckets of the key */
+	prim_bkt = cuckoo_bucket(h, sig);
+	slot = cuckoo_bucket_find_empty(prim_bkt);
+	if (slot >= 0) {
+		cuckoo_bucket_set(prim_bkt, slot, sig, alt, key_idx);
+		return key_idx - 1;
+	}
+	sec_bkt = cuckoo_bucket(h, alt);
+	slot = cuckoo_bucket_find_empty(sec_bkt);
+	if (slot >= 0) {
+		cuckoo_bucket_set(sec_bkt, slot, alt, sig, key_idx);
+		return key_idx - 1;
+	}
+	if (!slow)
+		return -EAGAIN;
+
+	/* Room made by moving other keys */
+	slot = cuckoo_make_space(h, prim_bkt, sec_bkt, &bkt);
+	if (slot >= 0) {
+		if (bkt == prim_bkt)
+			cuckoo_bucket_set(bkt, slot, sig, alt, key_idx);
+		else
+			cuckoo_bucket_set(bkt, slot, alt, sig, key_idx);
+		return key_idx - 1;
+	}
+
+	/* Last resort: the stash */
+	if (c->stash_count < c->stash_entries) {
+		c->stash[c->stash_count].sig = sig;
+		c->stash[c->stash_count].key_idx = key_idx;
+		rte_smp_wmb();
+		c->stash_count++;
+		return key_idx - 1;
+	}
+
+	return -ENOSPC;
+}
+
+/*
+ * Insert the key at key_idx of the key store, unless the key is already
+ * in the table: then update its data if set_data is set. Returns the
+ * position of the key or a cuckoo_insert() error.
+ */
+static inline int32_t
+cuckoo_add(const struct rte_hash *h, const void *key, hash_sig_t sig,
+	hash_sig_t alt, uint32_t key_idx, int slow, int set_data, void *data)
+{
+	int32_t ret;
+
+	ret = cuckoo_lookup(h, key, sig, alt);
+	if (ret < 0)
+		return cuckoo_insert(h, sig, alt, key_idx, slow);
+	if (set_data && h->key_data_offset != 0)
+		set_key_data(h, cuckoo_key(h->cuckoo, ret + 1), data);
+	return ret;
+}
+
+/* Bucket locks of a path and of the buckets of a key, in lock order,
+ * without duplicates; returns their number. */
+static unsigned
+cuckoo_path_locks(const struct rte_hash *h, const struct cuckoo_path *p,
+	hash_sig_t sig, hash_sig_t alt,
+	uint32_t locks[RTE_HASH_BFS_PATH_MAX_LEN + 3])
+{
+	const struct rte_hash_cuckoo *c = h->cuckoo;
+	uint32_t l;
+	unsigned i, j, n = 0;
+
+	for (i = 0; i < p->len + 3; i++) {
+		if (i <= p->len)
+			l = (uint32_t)(p->bkt[i] - c->buckets);
+		else
+			l = (i == p->len + 1) ? sig : alt;
+		l &= h->bucket_bitmask & c->lock_mask;
+
+		for (j = n; j > 0 && locks[j - 1] > l; j--)
+			;
+		if (j > 0 && locks[j - 1] == l)
+			continue;
+		memmove(&locks[j + 1], &locks[j], (n - j) * sizeof(locks[0]));
+		locks[j] = l;
+		n++;
+	}
+	return n;
+}
+
+/*
+ * Add a key, with several writers, when its buckets were full: a path of
+ * keys to move is searched without lock, then the buckets of the path
+ * and of the key are locked and the path is used if no other writer
+ * changed it. The stash, or a path changed too many times, need all the
+ * locks. Returns like cuckoo_add().
+ */
+static int32_t
+cuckoo_add_path(const struct rte_hash *h, const void *key, hash_sig_t sig,
+	hash_sig_t alt, uint32_t key_idx, int set_data, void *data)
+{
+	struct rte_hash_cuckoo *c = h->cuckoo;
+	struct rte_hash_bucket *prim_bkt = cuckoo_bucket(h, sig);
+	struct rte_hash_bucket *sec_bkt = cuckoo_bucket(h, alt);
+	uint32_t locks[RTE_HASH_BFS_PATH_MAX_LEN + 3];
+	struct cuckoo_path p;
+	unsigned retry, i, nb_locks;
+	int32_t ret;
+
+	for (retry = 0; retry < RTE_HASH_PATH_RETRIES; retry++) {
+		if (cuckoo_find_path(h, prim_bkt, sec_bkt, &p) != 0)
+			break;
+
+		nb_locks = cuckoo_path_locks(h, &p, sig, alt, locks);
+		for (i = 0; i < nb_locks; i++)
+			rte_spinlock_lock(&c->locks[locks[i]].sl);
+
+		/* the key may have been added, or room made, meanwhile */
+		ret = cuckoo_add(h, key, sig, alt, key_idx, 0, set_data, data);
+		if (ret == -EAGAIN && cuckoo_path_valid(h, &p)) {
+			cuckoo_move_path(h, &p);
+			if (p.bkt[0] == prim_bkt)
+				cuckoo_bucket_set(p.bkt[0], p.slot[0], sig,
+					alt, key_idx);
+			else
+				cuckoo_bucket_set(p.bkt[0], p.slot[0], alt,
+					sig, key_idx);
+			ret = key_idx - 1;
+		}
+
+		for (i = nb_locks; i > 0; i--)
+			rte_spinlock_unlock(&c->locks[locks[i - 1]].sl);
+		if (ret != -EAGAIN)
+			return ret;
+	}
+
+	cuckoo_lock_all(c);
+	ret = cuckoo_add(h, key, sig, alt, key_idx, 1, set_data, data);
+	cuckoo_unlock_all(c);
+	return ret;
+}
+
+static int32_t
+__rte_hash_cuckoo_add_key_with_hash(const struct rte_hash *h,
+	const void *key, hash_sig_t sig, int set_data, void *data)
+{
+	struct rte_hash_cuckoo *c = h->cuckoo;
+	hash_sig_t alt = rte_hash_secondary_hash(sig);
+	uint32_t key_idx;
+	int32_t ret;
+
+	/* Check if key is already present in the hash */
+	if (c->locks == NULL) {
+		ret = cuckoo_lookup(h, key, sig, alt);
+		if (ret >= 0) {
+			if (set_data && h->key_data_offset != 0)
+				set_key_data(h, cuckoo_key(c, ret + 1), data);
+			return ret;
+		}
+	}
+
+	/* the key and its data are ready before lookups can find them */
+	key_idx = cuckoo_alloc_key_idx(c);
+	if (key_idx == EMPTY_SLOT)
+		return -ENOSPC;
+	rte_memcpy(cuckoo_key(c, key_idx), key, h->key_len);
+	if (h->key_data_offset != 0)
+		set_key_data(h, cuckoo_key(c, key_idx), set_data ? data : NULL);
+
+	if (c->locks == NULL) {
+		ret = cuckoo_insert(h, sig, alt, key_idx, 1);
+	} else {
+		/* another writer may be adding the same key */
+		cuckoo_lock(h, sig, alt);
+		ret = cuckoo_add(h, key, sig, alt, key_idx, c->use_tm,
+			set_data, data);
+		cuckoo_unlock(h, sig, alt);
+
+		if (ret == -EAGAIN)
+			ret = cuckoo_add_path(h, key, sig, alt, key_idx,
+				set_data, data);
+	}
+
+	if (ret != (int32_t)key_idx - 1)
+		cuckoo_free_key_idx(c, key_idx);
+	return ret;
+}
+
+/* Move a key of the stash to a bucket entry that was just freed. */
+static void
+cuckoo_stash_reinsert(const struct rte_hash *h, struct rte_hash_bucket *bkt,
+	unsigned slot)
+{
+	struct rte_hash_cuckoo *c = h->cuckoo;
+	hash_sig_t sig, alt;
+	unsigned i;
+
+	for (i = 0; i < c->stash_count; i++) {
+		sig = c->stash[i].sig;
+		alt = rte_hash_secondary_hash(sig);
+		if (cuckoo_bucket(h, sig) == bkt)
+			cuckoo_bucket_set(bkt, slot, sig, alt,
+				c->stash[i].key_idx);
+		else if (cuckoo_bucket(h, alt) == bkt)
+			cuckoo_bucket_set(bkt, slot, alt, sig,
+				c->stash[i].key_idx);
+		else
+			continue;
+
+		cuckoo_key_moved(c);
+		cuckoo_stash_remove(c, i);
+		return;
+	}
+}
+
+/*
+ * Remove a key from the table. With several writers, the locks of the
+ * buckets of the key are held, and the stash is changed under the stash
+ * lock if lock_stash is set: the other writers only change it while
+ * holding all the bucket locks. Returns the key index of the key, or
+ * -ENOENT.
+ */
+static int32_t
+cuckoo_remove(const struct rte_hash *h, const void *key, hash_sig_t sig,
+	hash_sig_t alt, int lock_stash)
+{
+	struct rte_hash_cuckoo *c = h->cuckoo;
+	struct rte_hash_bucket *bkt;
+	uint32_t key_idx;
+	int i;
+
+	bkt = cuckoo_bucket(h, sig);
+	i = cuckoo_bucket_find(h, bkt, key, sig, alt, &key_idx);
+	if (i < 0) {
+		bkt = cuckoo_bucket(h, alt);
+		i = cuckoo_bucket_find(h, bkt, key, alt, sig, &key_idx);
+	}
+	if (i >= 0)
+		cuckoo_bucket_set(bkt, i, 0, 0, EMPTY_SLOT);
+	if (likely(c->stash_count == 0))
+		return (i >= 0) ? (int32_t)key_idx : -ENOENT;
+
+	if (lock_stash)
+		rte_spinlock_lock(&c->stash_lock);
+	if (i >= 0) {
+		cuckoo_stash_reinsert(h, bkt, i);
+	} else {
+		i = cuckoo_stash_find(h, key, sig, &key_idx);
+		if (i >= 0)
+			cuckoo_stash_remove(c, i);
+	}
+	if (lock_stash)
+		rte_spinlock_unlock(&c->stash_lock);
+
+	return (i >= 0) ? (int32_t)key_idx : -ENOENT;
+}
+
+static int32_t
+__rte_hash_cuckoo_del_key_with_hash(const struct rte_hash *h,
+	const void *key, hash_sig_t sig)
+{
+	struct rte_hash_cuckoo *c = h->cuckoo;
+	hash_sig_t alt = rte_hash_secondary_hash(sig);
+	int32_t ret;
+
+	if (c->locks == NULL) {
+		ret = cuckoo_remove(h, key, sig, alt, 0);
+	} else {
+		cuckoo_lock(h, sig, alt);
+		ret = cuckoo_remove(h, key, sig, alt, !c->use_tm);
+		cuckoo_unlock(h, sig, alt);
+	}
+	if (ret < 0)
+		return ret;
+
+	/* lookups may still be reading the key */
+	if (!c->rw_concurrency_lf)
+		cuckoo_free_key_idx(c, ret);
+	return ret - 1;
+}
+
+static void
+__rte_hash_cuckoo_lookup_bulk(const struct rte_hash *h, const void **keys,
+	uint32_t num_keys, int32_t *positions)
+{
+	const struct rte_hash_cuckoo *c = h->cuckoo;
+	hash_sig_t sigs[RTE_HASH_LOOKUP_BULK_MAX];
+	hash_sig_t alts[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t key_idx[RTE_HASH_LOOKUP_BULK_MAX];
+	const struct rte_hash_bucket *bkt;
+	uint32_t i, mask;
+
+	/* Compute the hash values and prefetch both buckets */
+	for (i = 0; i < num_keys; i++) {
+		sigs[i] = rte_hash_hash(h, keys[i]);
+		alts[i] = rte_hash_secondary_hash(sigs[i]);
+		rte_prefetch0(cuckoo_bucket(h, sigs[i]));
+		rte_prefetch0(cuckoo_bucket(h, alts[i]));
+	}
+
+	/* Find the first entry with matching hash values, prefetch its key */
+	for (i = 0; i < num_keys; i++) {
+		bkt = cuckoo_bucket(h, sigs[i]);
+		mask = cuckoo_sig_match(h, bkt, sigs[i], alts[i]);
+		if (mask == 0) {
+			bkt = cuckoo_bucket(h, alts[i]);
+			mask = cuckoo_sig_match(h, bkt, alts[i], sigs[i]);
+		}
+		key_idx[i] = EMPTY_SLOT;
+		if (mask != 0)
+			key_idx[i] = cuckoo_read_idx(
+				&bkt->key_idx[__builtin_ctz(mask)]);
+		rte_prefetch0(cuckoo_key(c, key_idx[i]));
+	}
+
+	/* Compare the keys, falling back to a full lookup on mismatch */
+	for (i = 0; i < num_keys; i++) {
+		if (likely(key_idx[i] != EMPTY_SLOT &&
+			   rte_hash_cmp_eq(h, keys[i],
+					   cuckoo_key(c, key_idx[i])) == 0))
+			positions[i] = key_idx[i] - 1;
+		else
+			positions[i] = cuckoo_lookup(h, keys[i], sigs[i],
+				alts[i]);
+	}
+}
+
+/* Allocate the tables of a cuckoo hash. */
+static int
+rte_hash_cuckoo_create(struct rte_hash *h,
+	const struct rte_hash_parameters *params)
+{
+	struct rte_hash_cuckoo *c;
+	uint32_t ring_size, i;
+	unsigned ring_flags = RING_F_SP_ENQ | RING_F_SC_DEQ;
+
+	c = rte_zmalloc_socket(h->name, sizeof(*c) +
+		params->stash_entries * sizeof(c->stash[0]),
+		RTE_CACHE_LINE_SIZE, params->socket_id);
+	if (c == NULL)
+		return -ENOMEM;
+	h->cuckoo = c;
+
+	c->stash_entries = params->stash_entries;
+	c->rw_concurrency_lf = !!(params->extra_flag &
+		RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF);
+	c->key_entry_size = h->key_tbl_key_size;
+	c->buckets = rte_zmalloc_socket(h->name,
+		h->num_buckets * sizeof(struct rte_hash_bucket),
+		RTE_CACHE_LINE_SIZE, params->socket_id);
+	c->key_store = rte_zmalloc_socket(h->name,
+		(size_t)(h->entries + 1) * c->key_entry_size,
+		RTE_CACHE_LINE_SIZE, params->socket_id);
+
+	/* the ring is private, it is not registered in the list of rings */
+	ring_size = rte_align32pow2(h->entries + 1);
+	c->free_slots = rte_zmalloc_socket(h->name,
+		rte_ring_get_memsize(ring_size), RTE_CACHE_LINE_SIZE,
+		params->socket_id);
+	if (c->buckets == NULL || c->key_store == NULL ||
+	    c->free_slots == NULL)
+		return -ENOMEM;
+
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_MULTI_WRITER) {
+		c->lock_mask = RTE_MIN(h->num_buckets,
+			(uint32_t)RTE_HASH_LOCK_STRIPES) - 1;
+		c->use_tm = rte_tm_supported();
+		c->locks = rte_zmalloc_socket(h->name,
+			(c->lock_mask + 1) * sizeof(c->locks[0]),
+			RTE_CACHE_LINE_SIZE, params->socket_id);
+		c->local_free_slots = rte_zmalloc_socket(h->name,
+			RTE_MAX_LCORE * sizeof(c->local_free_slots[0]),
+			RTE_CACHE_LINE_SIZE, params->socket_id);
+		if (c->locks == NULL || c->local_free_slots == NULL)
+			return -ENOMEM;
+		for (i = 0; i <= c->lock_mask; i++)
+			rte_spinlock_init(&c->locks[i].sl);
+		rte_spinlock_init(&c->stash_lock);
+		ring_flags = 0;
+	}
+
+	rte_ring_init(c->free_slots, h->name, ring_size, ring_flags);
+	for (i = 1; i <= h->entries; i++)
+		rte_ring_enqueue(c->free_slots, (void *)(uintptr_t)i);
+
+	return 0;
+}
+
+static void
+rte_hash_cuckoo_free(struct rte_hash *h)
+{
+	struct rte_hash_cuckoo *c = h->cuckoo;
+
+	if (c == NULL)
+		return;
+
+	rte_free(c->local_free_slots);
+	rte_free(c->locks);
+	rte_free(c->free_slots);
+	rte_free(c->key_store);
+	rte_free(c->buckets);
+	rte_free(c);
+	h->cuckoo = NULL;
+}
+
 struct rte_hash *
 rte_hash_find_existing(const char *name)
 {
@@ -170,22 +1220,38 @@ rte_hash_create(const struct rte_hash_parameters *params)
 {
 	struct rte_hash *h = NULL;
 	struct rte_tailq_entry *te;
-	uint32_t num_buckets, sig_bucket_size, key_size,
+	uint32_t num_buckets, sig_bucket_size, key_size, key_data_offset,
 		hash_tbl_size, sig_tbl_size, key_tbl_size, mem_size;
 	char hash_name[RTE_HASH_NAMESIZE];
 	struct rte_hash_list *hash_list;
+	uint32_t bucket_entries;
+	int cuckoo;
 
 	hash_list = RTE_TAILQ_CAST(rte_hash_tailq.head, rte_hash_list);
 
 	/* Check for valid parameters */
-	if ((params == NULL) ||
-			(params->entries > RTE_HASH_ENTRIES_MAX) ||
-			(params->bucket_entries > RTE_HASH_BUCKET_ENTRIES_MAX) ||
-			(params->entries < params->bucket_entries) ||
+	if (params == NULL) {
+		rte_errno = EINVAL;
+		RTE_LOG(ERR, HASH, "rte_hash_create has invalid parameters\n");
+		return NULL;
+	}
+
+	/* Cuckoo tables have buckets of fixed size */
+	cuckoo = !!(params->extra_flag & (RTE_HASH_EXTRA_FLAGS_CUCKOO |
+		RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF |
+		RTE_HASH_EXTRA_FLAGS_MULTI_WRITER));
+	bucket_entries = cuckoo ? RTE_HASH_CUCKOO_BUCKET_ENTRIES :
+		params->bucket_entries;
+
+	if ((params->entries > RTE_HASH_ENTRIES_MAX) ||
+			(bucket_entries > RTE_HASH_BUCKET_ENTRIES_MAX) ||
+			(params->entries < bucket_entries) ||
 			!rte_is_power_of_2(params->entries) ||
-			!rte_is_power_of_2(params->bucket_entries) ||
+			!rte_is_power_of_2(bucket_entries) ||
 			(params->key_len == 0) ||
-			(params->key_len > RTE_HASH_KEY_LENGTH_MAX)) {
+			(params->key_len > RTE_HASH_KEY_LENGTH_MAX) ||
+			(cuckoo && params->stash_entries >
+				RTE_HASH_STASH_ENTRIES_MAX)) {
 		rte_errno = EINVAL;
 		RTE_LOG(ERR, HASH, "rte_hash_create has invalid parameters\n");
 		return NULL;
@@ -194,16 +1260,30 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	snprintf(hash_name, sizeof(hash_name), "HT_%s", params->name);
 
 	/* Calculate hash dimensions */
-	num_buckets = params->entries / params->bucket_entries;
-	sig_bucket_size = align_size(params->bucket_entries *
+	num_buckets = params->entries / bucket_entries;
+	sig_bucket_size = align_size(bucket_entries *
 				     sizeof(hash_sig_t), SIG_BUCKET_ALIGNMENT);
-	key_size =  align_size(params->key_len, KEY_ALIGNMENT);
+
+	/* The user data, if any, is stored after the key */
+	key_data_offset = 0;
+	key_size = params->key_len;
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_KEY_DATA) {
+		key_data_offset = align_size(params->key_len, sizeof(void *));
+		key_size = key_data_offset + sizeof(void *);
+	}
+	key_size = align_size(key_size, KEY_ALIGNMENT);
 
 	hash_tbl_size = align_size(sizeof(struct rte_hash), RTE_CACHE_LINE_SIZE);
-	sig_tbl_size = align_size(num_buckets * sig_bucket_size,
-				  RTE_CACHE_LINE_SIZE);
-	key_tbl_size = align_size(num_buckets * key_size *
-				  params->bucket_entries, RTE_CACHE_LINE_SIZE);
+	if (cuckoo) {
+		/* the tables are allocated separately */
+		sig_tbl_size = 0;
+		key_tbl_size = 0;
+	} else {
+		sig_tbl_size = align_size(num_buckets * sig_bucket_size,
+					  RTE_CACHE_LINE_SIZE);
+		key_tbl_size = align_size(num_buckets * key_size *
+					  bucket_entries, RTE_CACHE_LINE_SIZE);
+	}
 
 	/* Total memory required for hash context */
 	mem_size = hash_tbl_size + sig_tbl_size + key_tbl_size;
@@ -236,7 +1316,7 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	/* Setup hash context */
 	snprintf(h->name, sizeof(h->name), "%s", params->name);
 	h->entries = params->entries;
-	h->bucket_entries = params->bucket_entries;
+	h->bucket_entries = bucket_entries;
 	h->key_len = params->key_len;
 	h->hash_func_init_val = params->hash_func_init_val;
 	h->num_buckets = num_buckets;
@@ -246,8 +1326,19 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	h->sig_tbl_bucket_size = sig_bucket_size;
 	h->key_tbl = h->sig_tbl + sig_tbl_size;
 	h->key_tbl_key_size = key_size;
+	h->key_data_offset = key_data_offset;
 	h->hash_func = (params->hash_func == NULL) ?
 		DEFAULT_HASH_FUNC : params->hash_func;
+	rte_hash_cmp_init(h);
+
+	if (cuckoo && rte_hash_cuckoo_create(h, params) != 0) {
+		RTE_LOG(ERR, HASH, "memory allocation failed\n");
+		rte_hash_cuckoo_free(h);
+		rte_free(h);
+		rte_free(te);
+		h = NULL;
+		goto exit;
+	}
 
 	te->data = (void *) h;
 
@@ -287,17 +1378,19 @@ rte_hash_free(struct rte_hash *h)
 
 	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
 
+	rte_hash_cuckoo_free(h);
 	rte_free(h);
 	rte_free(te);
 }
 
 static inline int32_t
 __rte_hash_add_key_with_hash(const struct rte_hash *h,
-				const void *key, hash_sig_t sig)
+				const void *key, hash_sig_t sig,
+				int set_data, void *data)
 {
 	hash_sig_t *sig_bucket;
 	uint8_t *key_bucket;
-	uint32_t bucket_index, i;
+	uint32_t bucket_index, i, mask;
 	int32_t pos;
 
 	/* Get the hash signature and bucket index */
@@ -307,23 +1400,30 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h,
 	key_bucket = get_key_tbl_bucket(h, bucket_index);
 
 	/* Check if key is already present in the hash */
-	for (i = 0; i < h->bucket_entries; i++) {
-		if ((sig == sig_bucket[i]) &&
-		    likely(memcmp(key, get_key_from_bucket(h, key_bucket, i),
-				  h->key_len) == 0)) {
+	for (mask = sig_match(h, sig_bucket, sig); mask != 0;
+	     mask &= mask - 1) {
+		i = __builtin_ctz(mask);
+		if (likely(rte_hash_cmp_eq(h, key,
+				get_key_from_bucket(h, key_bucket, i)) == 0)) {
+			if (set_data && h->key_data_offset != 0)
+				set_key_data(h, get_key_from_bucket(h,
+					key_bucket, i), data);
 			return bucket_index * h->bucket_entries + i;
 		}
 	}
 
 	/* Check if any free slot within the bucket to add the new key */
-	pos = find_first(NULL_SIGNATURE, sig_bucket, h->bucket_entries);
-
-	if (unlikely(pos < 0))
+	mask = sig_match(h, sig_bucket, NULL_SIGNATURE);
+	if (unlikely(mask == 0))
 		return -ENOSPC;
+	pos = __builtin_ctz(mask);
 
 	/* Add the new key to the bucket */
 	sig_bucket[pos] = sig;
 	rte_memcpy(get_key_from_bucket(h, key_bucket, pos), key, h->key_len);
+	if (h->key_data_offset != 0)
+		set_key_data(h, get_key_from_bucket(h, key_bucket, pos),
+			set_data ? data : NULL);
 	return bucket_index * h->bucket_entries + pos;
 }
 
@@ -332,14 +1432,47 @@ rte_hash_add_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
-	return __rte_hash_add_key_with_hash(h, key, sig);
+	if (h->cuckoo != NULL)
+		return __rte_hash_cuckoo_add_key_with_hash(h, key, sig,
+			0, NULL);
+	return __rte_hash_add_key_with_hash(h, key, sig, 0, NULL);
 }
 
 int32_t
 rte_hash_add_key(const struct rte_hash *h, const void *key)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
-	return __rte_hash_add_key_with_hash(h, key, rte_hash_hash(h, key));
+	if (h->cuckoo != NULL)
+		return __rte_hash_cuckoo_add_key_with_hash(h, key,
+			rte_hash_hash(h, key), 0, NULL);
+	return __rte_hash_add_key_with_hash(h, key, rte_hash_hash(h, key),
+		0, NULL);
+}
+
+int
+rte_hash_add_key_with_hash_data(const struct rte_hash *h,
+				const void *key, hash_sig_t sig, void *data)
+{
+	int32_t ret;
+
+	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->key_data_offset == 0)
+		return -EINVAL;
+	if (h->cuckoo != NULL)
+		ret = __rte_hash_cuckoo_add_key_with_hash(h, key, sig, 1, data);
+	else
+		ret = __rte_hash_add_key_with_hash(h, key, sig, 1, data);
+	return ret < 0 ? ret : 0;
+}
+
+int
+rte_hash_add_key_data(const struct rte_hash *h, const void *key, void *data)
+{
+	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->key_data_offset == 0)
+		return -EINVAL;
+	return rte_hash_add_key_with_hash_data(h, key, rte_hash_hash(h, key),
+		data);
 }
 
 static inline int32_t
@@ -348,7 +1481,7 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h,
 {
 	hash_sig_t *sig_bucket;
 	uint8_t *key_bucket;
-	uint32_t bucket_index, i;
+	uint32_t bucket_index, i, mask;
 
 	/* Get the hash signature and bucket index */
 	sig = sig | h->sig_msb;
@@ -357,10 +1490,11 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h,
 	key_bucket = get_key_tbl_bucket(h, bucket_index);
 
 	/* Check if key is already present in the hash */
-	for (i = 0; i < h->bucket_entries; i++) {
-		if ((sig == sig_bucket[i]) &&
-		    likely(memcmp(key, get_key_from_bucket(h, key_bucket, i),
-				  h->key_len) == 0)) {
+	for (mask = sig_match(h, sig_bucket, sig); mask != 0;
+	     mask &= mask - 1) {
+		i = __builtin_ctz(mask);
+		if (likely(rte_hash_cmp_eq(h, key,
+				get_key_from_bucket(h, key_bucket, i)) == 0)) {
 			sig_bucket[i] = NULL_SIGNATURE;
 			return bucket_index * h->bucket_entries + i;
 		}
@@ -374,6 +1508,8 @@ rte_hash_del_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->cuckoo != NULL)
+		return __rte_hash_cuckoo_del_key_with_hash(h, key, sig);
 	return __rte_hash_del_key_with_hash(h, key, sig);
 }
 
@@ -381,16 +1517,30 @@ int32_t
 rte_hash_del_key(const struct rte_hash *h, const void *key)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->cuckoo != NULL)
+		return __rte_hash_cuckoo_del_key_with_hash(h, key,
+			rte_hash_hash(h, key));
 	return __rte_hash_del_key_with_hash(h, key, rte_hash_hash(h, key));
 }
 
+int
+rte_hash_free_key_with_position(const struct rte_hash *h, int32_t position)
+{
+	RETURN_IF_TRUE(((h == NULL) || (h->cuckoo == NULL) ||
+			!h->cuckoo->rw_concurrency_lf || (position < 0) ||
+			((uint32_t)position >= h->entries)), -EINVAL);
+
+	cuckoo_free_key_idx(h->cuckoo, position + 1);
+	return 0;
+}
+
 static inline int32_t
 __rte_hash_lookup_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
 {
 	hash_sig_t *sig_bucket;
 	uint8_t *key_bucket;
-	uint32_t bucket_index, i;
+	uint32_t bucket_index, i, mask;
 
 	/* Get the hash signature and bucket index */
 	sig |= h->sig_msb;
@@ -399,10 +1549,11 @@ __rte_hash_lookup_with_hash(const struct rte_hash *h,
 	key_bucket = get_key_tbl_bucket(h, bucket_index);
 
 	/* Check if key is already present in the hash */
-	for (i = 0; i < h->bucket_entries; i++) {
-		if ((sig == sig_bucket[i]) &&
-		    likely(memcmp(key, get_key_from_bucket(h, key_bucket, i),
-				  h->key_len) == 0)) {
+	for (mask = sig_match(h, sig_bucket, sig); mask != 0;
+	     mask &= mask - 1) {
+		i = __builtin_ctz(mask);
+		if (likely(rte_hash_cmp_eq(h, key,
+				get_key_from_bucket(h, key_bucket, i)) == 0)) {
 			return bucket_index * h->bucket_entries + i;
 		}
 	}
@@ -415,6 +1566,8 @@ rte_hash_lookup_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->cuckoo != NULL)
+		return __rte_hash_cuckoo_lookup_with_hash(h, key, sig);
 	return __rte_hash_lookup_with_hash(h, key, sig);
 }
 
@@ -422,20 +1575,66 @@ int32_t
 rte_hash_lookup(const struct rte_hash *h, const void *key)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->cuckoo != NULL)
+		return __rte_hash_cuckoo_lookup_with_hash(h, key,
+			rte_hash_hash(h, key));
 	return __rte_hash_lookup_with_hash(h, key, rte_hash_hash(h, key));
 }
 
+/* Returns the stored key at a position returned by the API. */
+static inline void *
+get_key_from_position(const struct rte_hash *h, int32_t position)
+{
+	if (h->cuckoo != NULL)
+		return cuckoo_key(h->cuckoo, position + 1);
+	return RTE_PTR_ADD(h->key_tbl, (size_t)position * h->key_tbl_key_size);
+}
+
+int
+rte_hash_lookup_with_hash_data(const struct rte_hash *h,
+			const void *key, hash_sig_t sig, void **data)
+{
+	int32_t ret;
+
+	RETURN_IF_TRUE(((h == NULL) || (key == NULL) || (data == NULL)),
+		-EINVAL);
+	if (h->key_data_offset == 0)
+		return -EINVAL;
+	if (h->cuckoo != NULL)
+		ret = __rte_hash_cuckoo_lookup_with_hash(h, key, sig);
+	else
+		ret = __rte_hash_lookup_with_hash(h, key, sig);
+	if (ret >= 0)
+		*data = get_key_data(h, get_key_from_position(h, ret));
+	return ret;
+}
+
+int
+rte_hash_lookup_data(const struct rte_hash *h, const void *key, void **data)
+{
+	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->key_data_offset == 0)
+		return -EINVAL;
+	return rte_hash_lookup_with_hash_data(h, key, rte_hash_hash(h, key),
+		data);
+}
+
 int
 rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 		      uint32_t num_keys, int32_t *positions)
 {
-	uint32_t i, j, bucket_index;
+	uint32_t i, j, mask, bucket_index;
 	hash_sig_t sigs[RTE_HASH_LOOKUP_BULK_MAX];
 
 	RETURN_IF_TRUE(((h == NULL) || (keys == NULL) || (num_keys == 0) ||
 			(num_keys > RTE_HASH_LOOKUP_BULK_MAX) ||
 			(positions == NULL)), -EINVAL);
 
+	if (h->cuckoo != NULL) {
+		__rte_hash_cuckoo_lookup_bulk(h, keys, num_keys, positions);
+		return 0;
+	}
+
 	/* Get the hash signature and bucket index */
 	for (i = 0; i < num_keys; i++) {
 		sigs[i] = h->hash_func(keys[i], h->key_len,
@@ -455,11 +1654,11 @@ rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 
 		positions[i] = -ENOENT;
 
-		for (j = 0; j < h->bucket_entries; j++) {
-			if ((sigs[i] == sig_bucket[j]) &&
-			    likely(memcmp(keys[i],
-					  get_key_from_bucket(h, key_bucket, j),
-					  h->key_len) == 0)) {
+		for (mask = sig_match(h, sig_bucket, sigs[i]); mask != 0;
+		     mask &= mask - 1) {
+			j = __builtin_ctz(mask);
+			if (likely(rte_hash_cmp_eq(h, keys[i],
+				get_key_from_bucket(h, key_bucket, j)) == 0)) {
 				positions[i] = bucket_index *
 					h->bucket_entries + j;
 				break;
@@ -469,3 +1668,33 @@ rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 
 	return 0;
 }
+
+int
+rte_hash_lookup_bulk_data(const struct rte_hash *h, const void **keys,
+		      uint32_t num_keys, uint64_t *hit_mask, void *data[])
+{
+	int32_t positions[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t i;
+	uint64_t hits = 0;
+	int ret;
+
+	RETURN_IF_TRUE(((h == NULL) || (hit_mask == NULL) ||
+			(data == NULL)), -EINVAL);
+	if (h->key_data_offset == 0)
+		return -EINVAL;
+
+	ret = rte_hash_lookup_bulk(h, keys, num_keys, positions);
+	if (ret < 0)
+		return ret;
+
+	/* the data is in the cache line of the key just compared */
+	for (i = 0; i < num_keys; i++) {
+		if (positions[i] < 0)
+			continue;
+		data[i] = get_key_data(h, get_key_from_position(h,
+			positions[i]));
+		hits |= UINT64_C(1) << i;
+	}
+	*hit_mask = hits;
+	return __builtin_popcountll(hits);
+}
@@ -63,6 +63,59 @@ extern "C" {
 /** Max number of characters in hash name.*/
 #define RTE_HASH_NAMESIZE			32
 
+/** Number of entries of the buckets of a cuckoo hash table. */
+#define RTE_HASH_CUCKOO_BUCKET_ENTRIES		4
+
+/** Maximum number of stash entries of a cuckoo hash table. */
+#define RTE_HASH_STASH_ENTRIES_MAX		64
+
+/**
+ * Flag of rte_hash_parameters.extra_flag: create a cuckoo hash table.
+ *
+ * Each key has two candidate buckets of RTE_HASH_CUCKOO_BUCKET_ENTRIES
+ * entries, chosen from its hash value. When both are full, keys are moved
+ * to their alternative bucket to make room, so that the table can be
+ * filled well over 90%; a lookup still probes two buckets at most, plus
+ * the stash when it is not empty. The positions returned by the API stay
+ * the same while keys move.
+ */
+#define RTE_HASH_EXTRA_FLAGS_CUCKOO		0x01
+
+/**
+ * Flag of rte_hash_parameters.extra_flag: create a cuckoo hash table that
+ * any number of lcores can look up without a lock while one lcore adds
+ * and deletes keys. Implies RTE_HASH_EXTRA_FLAGS_CUCKOO.
+ *
+ * A lookup that races with keys moving between buckets notices it and
+ * searches again. A deleted key stays in the table memory until the
+ * application gives its position back with
+ * rte_hash_free_key_with_position(), which it must only do once no
+ * lookup started before the delete can still be running.
+ */
+#define RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF	0x02
+
+/**
+ * Flag of rte_hash_parameters.extra_flag: create a cuckoo hash table that
+ * several lcores can add keys to and delete keys from at the same time.
+ * Implies RTE_HASH_EXTRA_FLAGS_CUCKOO.
+ *
+ * Writers elide a lock through transactional memory when the CPU supports
+ * it, or else lock the two buckets of the key, and all of them only when
+ * keys must be moved or the stash used. Each lcore caches some free
+ * positions, so an add may fail with -ENOSPC while other lcores still
+ * hold free ones.
+ */
+#define RTE_HASH_EXTRA_FLAGS_MULTI_WRITER	0x04
+
+/**
+ * Flag of rte_hash_parameters.extra_flag: store a user data pointer with
+ * each key, in the same cache line when the key is small enough, so that
+ * rte_hash_lookup_data() and rte_hash_lookup_bulk_data() return it
+ * without another memory access. Keys are stored in 8 more bytes, rounded
+ * up to 16.
+ */
+#define RTE_HASH_EXTRA_FLAGS_KEY_DATA		0x08
+
 /** Signature of key that is stored internally. */
 typedef uint32_t hash_sig_t;
 
@@ -72,7 +125,8 @@ typedef uint32_t (*rte_hash_function)(const void *key, uint32_t key_len,
 
 /**
  * Parameters used when creating the hash table. The total table entries and
- * bucket entries must be a power of 2.
+ * bucket entries must be a power of 2. The bucket entries are ignored by
+ * cuckoo hash tables.
  */
 struct rte_hash_parameters {
 	const char *name;		/**< Name of the hash. */
@@ -82,8 +136,14 @@ struct rte_hash_parameters {
 	rte_hash_function hash_func;	/**< Function used to calculate hash. */
 	uint32_t hash_func_init_val;	/**< Init value used by hash_func. */
 	int socket_id;			/**< NUMA Socket ID for memory. */
+	uint8_t extra_flag;		/**< RTE_HASH_EXTRA_FLAGS_* flags. */
+	uint32_t stash_entries;		/**< Cuckoo table: number of entries
+					   of the stash holding the keys that
+					   found no room in their buckets. */
 };
 
+struct rte_hash_cuckoo;
+
 /** A hash table structure. */
 struct rte_hash {
 	char name[RTE_HASH_NAMESIZE];	/**< Name of the hash. */
@@ -104,6 +164,14 @@ struct rte_hash {
 	uint32_t key_tbl_key_size;	/**< Keys may be padded for alignment
 					   reasons, and this is the key size
 					   used	by key_tbl. */
+	struct rte_hash_cuckoo *cuckoo;	/**< Tables of a cuckoo hash, NULL
+					   if it is not one. */
+	uint32_t key_data_offset;	/**< Offset of the user data in a
+					   stored key, 0 if there is none. */
+	uint8_t key_cmp;		/**< Key comparison function, chosen
+					   from the key length. */
+	uint8_t sig_cmp;		/**< Signature comparison
+					   instructions. */
 };
 
 /**
@@ -150,7 +218,8 @@ rte_hash_free(struct rte_hash *h);
 
 /**
  * Add a key to an existing hash table. This operation is not multi-thread safe
- * and should only be called from one thread.
+ * and should only be called from one thread, unless the table was created
+ * with RTE_HASH_EXTRA_FLAGS_MULTI_WRITER.
  *
  * @param h
  *   Hash table to add the key to.
@@ -167,7 +236,8 @@ rte_hash_add_key(const struct rte_hash *h, const void *key);
 
 /**
  * Add a key to an existing hash table. This operation is not multi-thread safe
- * and should only be called from one thread.
+ * and should only be called from one thread, unless the table was created
+ * with RTE_HASH_EXTRA_FLAGS_MULTI_WRITER.
  *
  * @param h
  *   Hash table to add the key to.
@@ -185,9 +255,55 @@ int32_t
 rte_hash_add_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig);
 
+/**
+ * Add a key and its user data to a hash table created with
+ * RTE_HASH_EXTRA_FLAGS_KEY_DATA. If the key is already in the table, its
+ * data is replaced. This operation is not multi-thread safe and should
+ * only be called from one thread, unless the table was created with
+ * RTE_HASH_EXTRA_FLAGS_MULTI_WRITER.
+ *
+ * @param h
+ *   Hash table to add the key to.
+ * @param key
+ *   Key to add to the hash table.
+ * @param data
+ *   Data to store with the key.
+ * @return
+ *   - 0 if the key was added or its data replaced.
+ *   - -EINVAL if the parameters are invalid, or if the table stores no data.
+ *   - -ENOSPC if there is no space in the hash for this key.
+ */
+int
+rte_hash_add_key_data(const struct rte_hash *h, const void *key, void *data);
+
+/**
+ * Add a key and its user data to a hash table created with
+ * RTE_HASH_EXTRA_FLAGS_KEY_DATA. If the key is already in the table, its
+ * data is replaced. This operation is not multi-thread safe and should
+ * only be called from one thread, unless the table was created with
+ * RTE_HASH_EXTRA_FLAGS_MULTI_WRITER.
+ *
+ * @param h
+ *   Hash table to add the key to.
+ * @param key
+ *   Key to add to the hash table.
+ * @param sig
+ *   Hash value to add to the hash table.
+ * @param data
+ *   Data to store with the key.
+ * @return
+ *   - 0 if the key was added or its data replaced.
+ *   - -EINVAL if the parameters are invalid, or if the table stores no data.
+ *   - -ENOSPC if there is no space in the hash for this key.
+ */
+int
+rte_hash_add_key_with_hash_data(const struct rte_hash *h, const void *key,
+				hash_sig_t sig, void *data);
+
 /**
  * Remove a key from an existing hash table. This operation is not multi-thread
- * safe and should only be called from one thread.
+ * safe and should only be called from one thread, unless the table was created
+ * with RTE_HASH_EXTRA_FLAGS_MULTI_WRITER.
  *
  * @param h
  *   Hash table to remove the key from.
@@ -198,14 +314,17 @@ rte_hash_add_key_with_hash(const struct rte_hash *h,
  *   - -ENOENT if the key is not found.
  *   - A positive value that can be used by the caller as an offset into an
  *     array of user data. This value is unique for this key, and is the same
- *     value that was returned when the key was added.
+ *     value that was returned when the key was added. With
+ *     RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF, it is not given to another
+ *     key before rte_hash_free_key_with_position() is called with it.
  */
 int32_t
 rte_hash_del_key(const struct rte_hash *h, const void *key);
 
 /**
  * Remove a key from an existing hash table. This operation is not multi-thread
- * safe and should only be called from one thread.
+ * safe and should only be called from one thread, unless the table was created
+ * with RTE_HASH_EXTRA_FLAGS_MULTI_WRITER.
  *
  * @param h
  *   Hash table to remove the key from.
@@ -218,12 +337,37 @@ rte_hash_del_key(const struct rte_hash *h, const void *key);
  *   - -ENOENT if the key is not found.
  *   - A positive value that can be used by the caller as an offset into an
  *     array of user data. This value is unique for this key, and is the same
- *     value that was returned when the key was added.
+ *     value that was returned when the key was added. With
+ *     RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF, it is not given to another
+ *     key before rte_hash_free_key_with_position() is called with it.
  */
 int32_t
 rte_hash_del_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig);
 
+/**
+ * Give back the position of a key deleted from a table created with
+ * RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF, so that it can be used by a new
+ * key. The lookups running when the key was deleted may still be reading
+ * it: the caller must wait for all of them to complete first, for
+ * instance by waiting until each lcore doing lookups has gone through a
+ * point where it holds no reference into the table. This operation is
+ * not multi-thread safe and should only be called from the thread that
+ * adds and deletes keys, unless the table was created with
+ * RTE_HASH_EXTRA_FLAGS_MULTI_WRITER.
+ *
+ * @param h
+ *   Hash table the key was deleted from.
+ * @param position
+ *   Value returned by rte_hash_del_key() or rte_hash_del_key_with_hash().
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL if the parameters are invalid, or if the table was not
+ *     created with RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF.
+ */
+int
+rte_hash_free_key_with_position(const struct rte_hash *h,
+				int32_t position);
 
 /**
  * Find a key in the hash table. This operation is multi-thread safe.
@@ -262,6 +406,45 @@ int32_t
 rte_hash_lookup_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig);
 
+/**
+ * Find a key in a hash table created with RTE_HASH_EXTRA_FLAGS_KEY_DATA
+ * and get its user data. This operation is multi-thread safe.
+ *
+ * @param h
+ *   Hash table to look in.
+ * @param key
+ *   Key to find.
+ * @param data
+ *   Output with the data stored with the key, if it is found.
+ * @return
+ *   - -EINVAL if the parameters are invalid, or if the table stores no data.
+ *   - -ENOENT if the key is not found.
+ *   - The position of the key, as returned by rte_hash_lookup().
+ */
+int
+rte_hash_lookup_data(const struct rte_hash *h, const void *key, void **data);
+
+/**
+ * Find a key in a hash table created with RTE_HASH_EXTRA_FLAGS_KEY_DATA
+ * and get its user data. This operation is multi-thread safe.
+ *
+ * @param h
+ *   Hash table to look in.
+ * @param key
+ *   Key to find.
+ * @param sig
+ *   Hash value to find.
+ * @param data
+ *   Output with the data stored with the key, if it is found.
+ * @return
+ *   - -EINVAL if the parameters are invalid, or if the table stores no data.
+ *   - -ENOENT if the key is not found.
+ *   - The position of the key, as returned by rte_hash_lookup().
+ */
+int
+rte_hash_lookup_with_hash_data(const struct rte_hash *h, const void *key,
+				hash_sig_t sig, void **data);
+
 
 /**
  * Calc a hash value by key. This operation is not multi-process safe.
@@ -302,6 +485,30 @@ rte_hash_hash(const struct rte_hash *h, const void *key)
 int
 rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 		      uint32_t num_keys, int32_t *positions);
+
+/**
+ * Find multiple keys in a hash table created with
+ * RTE_HASH_EXTRA_FLAGS_KEY_DATA and get their user data. This operation
+ * is multi-thread safe.
+ *
+ * @param h
+ *   Hash table to look in.
+ * @param keys
+ *   A pointer to a list of keys to look for.
+ * @param num_keys
+ *   How many keys are in the keys list (less than RTE_HASH_LOOKUP_BULK_MAX).
+ * @param hit_mask
+ *   Output with bit i set if keys[i] was found.
+ * @param data
+ *   Output with the data stored with each key found. The entries of the
+ *   keys not found are left unchanged.
+ * @return
+ *   -EINVAL if the parameters are invalid, or if the table stores no data,
+ *   otherwise the number of keys found.
+ */
+int
+rte_hash_lookup_bulk_data(const struct rte_hash *h, const void **keys,
+		      uint32_t num_keys, uint64_t *hit_mask, void *data[]);
 #ifdef __cplusplus
 }
 #endif
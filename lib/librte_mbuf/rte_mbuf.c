@@ -52,12 +52,16 @@
 #include <rte_per_lcore.h>
 #include <rte_lcore.h>
 #include <rte_atomic.h>
+#include <rte_spinlock.h>
 #include <rte_branch_prediction.h>
 #include <rte_ring.h>
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
 #include <rte_string_fns.h>
 #include <rte_hexdump.h>
+#include <rte_malloc.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
 
 /*
  * ctrlmbuf constructor, given as a callback function to
@@ -166,6 +170,521 @@ rte_pktmbuf_pool_create(const char *name, unsigned n,
 		socket_id, 0);
 }
 
+/* number of mempools a bulk free keeps objects for at the same time */
+#define PKTMBUF_FREE_BULK_POOLS 4
+/* number of objects kept for one mempool before they are put back */
+#define PKTMBUF_FREE_BULK_SIZE  32
+
+/* segments waiting to be put back into their mempool */
+struct pktmbuf_free_batch {
+	struct rte_mempool *mp;
+	unsigned n;
+	void *objs[PKTMBUF_FREE_BULK_SIZE];
+};
+
+static inline void
+pktmbuf_free_batch_flush(struct pktmbuf_free_batch *b)
+{
+	rte_mempool_put_bulk(b->mp, b->objs, b->n);
+	b->n = 0;
+}
+
+/* free a bulk of packet mbufs, putting back segments by batches */
+void
+rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs, unsigned count)
+{
+	struct pktmbuf_free_batch batch[PKTMBUF_FREE_BULK_POOLS];
+	struct pktmbuf_free_batch *b;
+	struct rte_mbuf *m, *m_next;
+	unsigned nb_batch = 0, victim = 0;
+	unsigned i, j;
+
+	for (i = 0; i < count; i++) {
+		m = mbufs[i];
+		if (m == NULL)
+			continue;
+
+		__rte_mbuf_sanity_check(m, 1);
+
+		do {
+			m_next = m->next;
+			m = __rte_pktmbuf_prefree_seg(m);
+			if (likely(m != NULL)) {
+				m->next = NULL;
+
+				/* find the batch of the mempool of m */
+				for (j = 0; j < nb_batch; j++) {
+					if (batch[j].mp == m->pool)
+						break;
+				}
+				b = &batch[j];
+				if (unlikely(j == nb_batch)) {
+					/* no room for a new mempool: flush one */
+					if (nb_batch == PKTMBUF_FREE_BULK_POOLS) {
+						b = &batch[victim];
+						victim = (victim + 1) %
+							PKTMBUF_FREE_BULK_POOLS;
+						if (b->n != 0)
+							pktmbuf_free_batch_flush(b);
+					} else {
+						nb_batch++;
+						b->n = 0;
+					}
+					b->mp = m->pool;
+				}
+
+				rte_mbuf_history_mark(m,
+					RTE_MBUF_HISTORY_OWNER_LCORE,
+					RTE_MBUF_HISTORY_OP_FREE);
+				b->objs[b->n++] = m;
+				if (b->n == PKTMBUF_FREE_BULK_SIZE)
+					pktmbuf_free_batch_flush(b);
+			}
+			m = m_next;
+		} while (m != NULL);
+	}
+
+	for (j = 0; j < nb_batch; j++) {
+		if (batch[j].n != 0)
+			pktmbuf_free_batch_flush(&batch[j]);
+	}
+}
+
+/*
+ * History of the mbufs of a pool: one entry per object slot of the pool
+ * memory, found from the address of the mbuf.
+ */
+struct rte_mbuf_history_table {
+	uintptr_t start;   /**< Address of the first object slot. */
+	uint32_t stride;   /**< Total size of an object. */
+	uint32_t nb_slots; /**< Number of entries. */
+	struct rte_mbuf_history slots[0] __rte_cache_aligned;
+};
+
+/*
+ * History of a pool, found by the address of the pool. The entries are
+ * never removed: once a pool had a history, other lcores may still be
+ * recording events in it.
+ */
+struct mbuf_history_pool {
+	const struct rte_mempool *mp;
+	/** History of the mbufs, NULL if not enabled. */
+	struct rte_mbuf_history_table * volatile history;
+	/** Storage of the history, kept when it is disabled. */
+	struct rte_mbuf_history_table *mem;
+};
+
+static struct mbuf_history_pool mbuf_history_pools[RTE_MBUF_HISTORY_MAX_POOLS];
+static volatile uint32_t mbuf_history_nb_pools;
+static rte_spinlock_t mbuf_history_lock = RTE_SPINLOCK_INITIALIZER;
+
+volatile uint32_t rte_mbuf_history_nb_enabled;
+
+static RTE_DEFINE_PER_LCORE(uint16_t, mbuf_history_owner);
+
+/* set the owner of the events recorded by the library on this lcore */
+void
+rte_mbuf_history_set_owner(uint16_t owner)
+{
+	RTE_PER_LCORE(mbuf_history_owner) = owner & RTE_MBUF_HISTORY_OWNER_MAX;
+}
+
+/* find the history of a pool, NULL if it was never enabled */
+static inline struct mbuf_history_pool *
+mbuf_history_find(const struct rte_mempool *mp)
+{
+	uint32_t i, n = mbuf_history_nb_pools;
+
+	/* the entries are written before they are counted */
+	rte_rmb();
+	for (i = 0; i < n; i++) {
+		if (mbuf_history_pools[i].mp == mp)
+			return &mbuf_history_pools[i];
+	}
+	return NULL;
+}
+
+/* record an event in the history of an mbuf */
+void
+__rte_mbuf_history_record(struct rte_mbuf *m, uint16_t owner, unsigned op)
+{
+	struct mbuf_history_pool *hp;
+	struct rte_mbuf_history_table *t;
+	struct rte_mbuf_history *h;
+	uintptr_t idx;
+	unsigned i;
+
+	hp = mbuf_history_find(m->pool);
+	if (hp == NULL)
+		return;
+	t = hp->history;
+	if (t == NULL)
+		return;
+
+	idx = ((uintptr_t)m - t->start) / t->stride;
+	if (unlikely(idx >= t->nb_slots))
+		return;
+
+	if (owner == RTE_MBUF_HISTORY_OWNER_LCORE)
+		owner = RTE_PER_LCORE(mbuf_history_owner);
+
+	h = &t->slots[idx];
+	for (i = RTE_MBUF_HISTORY_DEPTH - 1; i > 0; i--)
+		h->ev[i] = h->ev[i - 1];
+	h->ev[0] = (rte_rdtsc() << 16) |
+		((uint64_t)(op & 0xf) << 12) |
+		(owner & RTE_MBUF_HISTORY_OWNER_MAX);
+}
+
+/* enable the history of a packet mbuf pool */
+int
+rte_mbuf_history_enable(struct rte_mempool *mp)
+{
+	struct mbuf_history_pool *hp;
+	struct rte_mbuf_history_table *t;
+	uint32_t stride, nb_slots;
+	int ret = 0;
+
+	if (mp->private_data_size < sizeof(struct rte_pktmbuf_pool_private))
+		return -EINVAL;
+
+	rte_spinlock_lock(&mbuf_history_lock);
+	hp = mbuf_history_find(mp);
+	if (hp != NULL && hp->history != NULL)
+		goto out;
+
+	if (hp == NULL) {
+		if (mbuf_history_nb_pools == RTE_MBUF_HISTORY_MAX_POOLS) {
+			ret = -ENOSPC;
+			goto out;
+		}
+
+		stride = mp->header_size + mp->elt_size + mp->trailer_size;
+		nb_slots = (mp->elt_va_end - mp->elt_va_start) / stride + 1;
+		t = rte_zmalloc_socket("MBUF_HISTORY", sizeof(*t) +
+			sizeof(t->slots[0]) * nb_slots, RTE_CACHE_LINE_SIZE,
+			mp->socket_id);
+		if (t == NULL) {
+			RTE_LOG(ERR, MBUF, "Cannot allocate history of %s\n",
+				mp->name);
+			ret = -ENOMEM;
+			goto out;
+		}
+		t->start = mp->elt_va_start;
+		t->stride = stride;
+		t->nb_slots = nb_slots;
+
+		hp = &mbuf_history_pools[mbuf_history_nb_pools];
+		hp->mp = mp;
+		hp->history = NULL;
+		hp->mem = t;
+		rte_wmb();
+		mbuf_history_nb_pools++;
+	} else {
+		t = hp->mem;
+		memset(t->slots, 0, sizeof(t->slots[0]) * t->nb_slots);
+	}
+
+	rte_wmb();
+	hp->history = t;
+	__sync_fetch_and_add(&rte_mbuf_history_nb_enabled, 1);
+out:
+	rte_spinlock_unlock(&mbuf_history_lock);
+	return ret;
+}
+
+/* disable the history of a packet mbuf pool; the storage is kept, as
+ * other lcores may still be recording events */
+void
+rte_mbuf_history_disable(struct rte_mempool *mp)
+{
+	struct mbuf_history_pool *hp;
+
+	rte_spinlock_lock(&mbuf_history_lock);
+	hp = mbuf_history_find(mp);
+	if (hp != NULL && hp->history != NULL) {
+		hp->history = NULL;
+		__sync_fetch_and_sub(&rte_mbuf_history_nb_enabled, 1);
+	}
+	rte_spinlock_unlock(&mbuf_history_lock);
+}
+
+struct mbuf_history_walk_arg {
+	const struct rte_mempool *mp;
+	const struct rte_mbuf_history_table *t;
+	rte_mbuf_history_walk_t *walk;
+	void *walk_arg;
+	int count;
+};
+
+/* call the walk function if the object is in use */
+static void
+mbuf_history_walk_obj(void *arg, void *start, __rte_unused void *end,
+	__rte_unused uint32_t idx)
+{
+	struct mbuf_history_walk_arg *wa = arg;
+	struct rte_mbuf *m = RTE_PTR_ADD(start, wa->mp->header_size);
+	const struct rte_mbuf_history *h;
+	uintptr_t slot;
+	unsigned op;
+
+	slot = ((uintptr_t)m - wa->t->start) / wa->t->stride;
+	if (slot >= wa->t->nb_slots)
+		return;
+
+	h = &wa->t->slots[slot];
+	op = RTE_MBUF_HISTORY_EV_OP(h->ev[0]);
+	if (op == RTE_MBUF_HISTORY_OP_NONE || op == RTE_MBUF_HISTORY_OP_FREE)
+		return;
+
+	wa->walk(m, h, wa->walk_arg);
+	wa->count++;
+}
+
+/* walk the mbufs in use according to their history */
+int
+rte_mbuf_history_walk(struct rte_mempool *mp, rte_mbuf_history_walk_t *walk,
+	void *arg)
+{
+	struct mbuf_history_pool *hp = mbuf_history_find(mp);
+	struct mbuf_history_walk_arg wa;
+
+	if (hp == NULL)
+		return -ENOENT;
+
+	wa.mp = mp;
+	wa.t = hp->mem;
+	wa.walk = walk;
+	wa.walk_arg = arg;
+	wa.count = 0;
+	rte_mempool_obj_iter((void *)mp->elt_va_start, mp->size,
+		mp->header_size + mp->elt_size + mp->trailer_size, 1,
+		mp->elt_pa, mp->pg_num, mp->pg_shift,
+		mbuf_history_walk_obj, &wa);
+	return wa.count;
+}
+
+/* number of distinct (owner, operation) of the summary of a dump */
+#define MBUF_HISTORY_DUMP_KEYS 64
+
+struct mbuf_history_dump_arg {
+	FILE *f;
+	uint64_t now;
+	unsigned nb_keys;
+	uint16_t key[MBUF_HISTORY_DUMP_KEYS];
+	unsigned count[MBUF_HISTORY_DUMP_KEYS];
+	unsigned others;
+};
+
+static void
+mbuf_history_dump_mbuf(struct rte_mbuf *m, const struct rte_mbuf_history *h,
+	void *arg)
+{
+	struct mbuf_history_dump_arg *da = arg;
+	uint64_t ev, age;
+	uint16_t key;
+	unsigned i;
+
+	fprintf(da->f, "  mbuf %p:", m);
+	for (i = 0; i < RTE_MBUF_HISTORY_DEPTH; i++) {
+		ev = h->ev[i];
+		if (RTE_MBUF_HISTORY_EV_OP(ev) == RTE_MBUF_HISTORY_OP_NONE)
+			break;
+		age = (da->now - RTE_MBUF_HISTORY_EV_TSC(ev)) &
+			((UINT64_C(1) << 48) - 1);
+		fprintf(da->f, " op=%u owner=%u age=%"PRIu64,
+			RTE_MBUF_HISTORY_EV_OP(ev),
+			RTE_MBUF_HISTORY_EV_OWNER(ev), age);
+	}
+	fprintf(da->f, "\n");
+
+	/* the key of the summary is the 16 low bits: owner and op */
+	key = (uint16_t)h->ev[0];
+	for (i = 0; i < da->nb_keys; i++) {
+		if (da->key[i] == key)
+			break;
+	}
+	if (i == da->nb_keys) {
+		if (i == MBUF_HISTORY_DUMP_KEYS) {
+			da->others++;
+			return;
+		}
+		da->key[i] = key;
+		da->count[i] = 0;
+		da->nb_keys++;
+	}
+	da->count[i]++;
+}
+
+/* dump the mbufs in use according to their history */
+void
+rte_mbuf_history_dump(FILE *f, struct rte_mempool *mp)
+{
+	struct mbuf_history_dump_arg da;
+	unsigned i;
+	int n;
+
+	fprintf(f, "mbuf history of <%s>@%p (age in TSC cycles)\n",
+		mp->name, mp);
+
+	da.f = f;
+	da.now = rte_rdtsc() & ((UINT64_C(1) << 48) - 1);
+	da.nb_keys = 0;
+	da.others = 0;
+	n = rte_mbuf_history_walk(mp, mbuf_history_dump_mbuf, &da);
+	if (n < 0) {
+		fprintf(f, "  no history\n");
+		return;
+	}
+
+	fprintf(f, "  in use: %d\n", n);
+	for (i = 0; i < da.nb_keys; i++)
+		fprintf(f, "    last op=%u owner=%u: %u\n",
+			RTE_MBUF_HISTORY_EV_OP(da.key[i]),
+			RTE_MBUF_HISTORY_EV_OWNER(da.key[i]), da.count[i]);
+	if (da.others != 0)
+		fprintf(f, "    others: %u\n", da.others);
+}
+
+/* read data across the segments of a packet mbuf */
+const void *
+__rte_pktmbuf_read(const struct rte_mbuf *m, uint32_t off, uint32_t len,
+	void *buf)
+{
+	const struct rte_mbuf *seg = m;
+	uint32_t buf_off = 0, copy_len;
+
+	if (off > rte_pktmbuf_pkt_len(m) ||
+			len > rte_pktmbuf_pkt_len(m) - off)
+		return NULL;
+
+	while (off >= rte_pktmbuf_data_len(seg) && seg->next != NULL) {
+		off -= rte_pktmbuf_data_len(seg);
+		seg = seg->next;
+	}
+
+	/* contiguous in a segment: no copy */
+	if (len <= rte_pktmbuf_data_len(seg) - off)
+		return rte_pktmbuf_mtod_offset(seg, const char *, off);
+
+	while (len > 0) {
+		copy_len = RTE_MIN(len,
+			(uint32_t)rte_pktmbuf_data_len(seg) - off);
+		rte_memcpy((char *)buf + buf_off,
+			rte_pktmbuf_mtod_offset(seg, const char *, off),
+			copy_len);
+		buf_off += copy_len;
+		len -= copy_len;
+		off = 0;
+		seg = seg->next;
+	}
+	return buf;
+}
+
+/* copy the data of all the segments into the first one */
+int
+__rte_pktmbuf_linearize(struct rte_mbuf *m)
+{
+	struct rte_mbuf *seg, *seg_next;
+	uint32_t copy_len;
+	char *dst;
+
+	copy_len = rte_pktmbuf_pkt_len(m) - rte_pktmbuf_data_len(m);
+	if (copy_len > rte_pktmbuf_tailroom(m) || RTE_MBUF_INDIRECT(m) ||
+			rte_mbuf_refcnt_read(m) != 1)
+		return -1;
+	/* an external buffer may be shared, or even read-only */
+	if (RTE_MBUF_HAS_EXTBUF(m) &&
+			rte_mbuf_ext_refcnt_read(m->shinfo) != 1)
+		return -1;
+
+	dst = rte_pktmbuf_mtod_offset(m, char *, rte_pktmbuf_data_len(m));
+	for (seg = m->next; seg != NULL; seg = seg_next) {
+		seg_next = seg->next;
+		rte_memcpy(dst, rte_pktmbuf_mtod(seg, const char *),
+			rte_pktmbuf_data_len(seg));
+		dst += rte_pktmbuf_data_len(seg);
+		rte_pktmbuf_free_seg(seg);
+	}
+
+	m->data_len = (uint16_t)rte_pktmbuf_pkt_len(m);
+	m->next = NULL;
+	m->nb_segs = 1;
+	__rte_mbuf_sanity_check(m, 1);
+	return 0;
+}
+
+/* deep copy a packet mbuf into new mbufs */
+struct rte_mbuf *
+rte_pktmbuf_copy(const struct rte_mbuf *m, struct rte_mempool *mp,
+	uint32_t off, uint32_t len)
+{
+	const struct rte_mbuf *seg = m;
+	struct rte_mbuf *mc, *m_last;
+	uint32_t copy_len;
+
+	__rte_mbuf_sanity_check(m, 1);
+
+	if (off > rte_pktmbuf_pkt_len(m))
+		return NULL;
+	len = RTE_MIN(len, rte_pktmbuf_pkt_len(m) - off);
+
+	mc = rte_pktmbuf_alloc(mp);
+	if (mc == NULL)
+		return NULL;
+
+	mc->port = m->port;
+	mc->vlan_tci = m->vlan_tci;
+	mc->tx_offload = m->tx_offload;
+	mc->hash = m->hash;
+	mc->packet_type = m->packet_type;
+	mc->ol_flags = m->ol_flags & ~(IND_ATTACHED_MBUF | EXT_ATTACHED_MBUF);
+	memcpy(mc->dynfield1, m->dynfield1, sizeof(mc->dynfield1));
+
+	while (off >= rte_pktmbuf_data_len(seg) && seg->next != NULL) {
+		off -= rte_pktmbuf_data_len(seg);
+		seg = seg->next;
+	}
+
+	m_last = mc;
+	while (len > 0) {
+		/* last segment of the copy is full: chain a new one */
+		if (rte_pktmbuf_tailroom(m_last) == 0) {
+			if (mc->nb_segs == UINT8_MAX)
+				goto fail;
+			m_last->next = rte_pktmbuf_alloc(mp);
+			if (m_last->next == NULL)
+				goto fail;
+			m_last = m_last->next;
+			mc->nb_segs++;
+		}
+
+		copy_len = RTE_MIN(len,
+			(uint32_t)rte_pktmbuf_data_len(seg) - off);
+		copy_len = RTE_MIN(copy_len,
+			(uint32_t)rte_pktmbuf_tailroom(m_last));
+		rte_memcpy(rte_pktmbuf_mtod_offset(m_last, char *,
+				rte_pktmbuf_data_len(m_last)),
+			rte_pktmbuf_mtod_offset(seg, const char *, off),
+			copy_len);
+		m_last->data_len = (uint16_t)(m_last->data_len + copy_len);
+		mc->pkt_len += copy_len;
+		len -= copy_len;
+		off += copy_len;
+		if (off == rte_pktmbuf_data_len(seg) && seg->next != NULL) {
+			seg = seg->next;
+			off = 0;
+		}
+	}
+
+	__rte_mbuf_sanity_check(mc, 1);
+	return mc;
+
+fail:
+	rte_pktmbuf_free(mc);
+	return NULL;
+}
+
 /* do some sanity checks on a mbuf: panic if it fails */
 void
 rte_mbuf_sanity_check(const struct rte_mbuf *m, int is_header)
@@ -57,6 +57,7 @@
 #include <rte_common.h>
 #include <rte_mempool.h>
 #include <rte_memory.h>
+#include <rte_memcpy.h>
 #include <rte_atomic.h>
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
@@ -191,6 +192,7 @@ extern "C" {
  */
 #define PKT_TX_OUTER_IPV6    (1ULL << 60)
 
+#define EXT_ATTACHED_MBUF    (1ULL << 61) /**< External buffer attached */
 #define IND_ATTACHED_MBUF    (1ULL << 62) /**< Indirect attached mbuf */
 
 /* Use final bit of flags to indicate a control mbuf */
@@ -235,6 +237,8 @@ typedef uint8_t  MARKER8[0];  /**< generic marker with 1B alignment */
 typedef uint64_t MARKER64[0]; /**< marker that allows us to overwrite 8 bytes
                                * with a single assignment */
 
+struct rte_mbuf_ext_shared_info;
+
 /**
  * The generic rte_mbuf, containing a packet mbuf.
  */
@@ -330,11 +334,37 @@ struct rte_mbuf {
 		};
 	};
 
+	/** Shared data of the external buffer, if EXT_ATTACHED_MBUF is set. */
+	struct rte_mbuf_ext_shared_info *shinfo;
+
 	/** Size of the application private data. In case of an indirect
 	 * mbuf, it stores the direct mbuf private data size. */
 	uint16_t priv_size;
+
+	/** Reserved for dynamic fields, see rte_mbuf_dyn.h. */
+	uint8_t dynfield1[22];
 } __rte_cache_aligned;
 
+/**
+ * Function called when the last mbuf attached to an external buffer
+ * is detached from it.
+ *
+ * @param addr
+ *   The address of the external buffer.
+ * @param opaque
+ *   The fcb_opaque pointer of the shared info of the buffer.
+ */
+typedef void (*rte_mbuf_extbuf_free_callback_t)(void *addr, void *opaque);
+
+/**
+ * Shared data of an external buffer attached to mbufs.
+ */
+struct rte_mbuf_ext_shared_info {
+	rte_mbuf_extbuf_free_callback_t free_cb; /**< Free callback. */
+	void *fcb_opaque;                 /**< Argument of the free callback. */
+	rte_atomic16_t refcnt_atomic;     /**< Number of attached mbufs. */
+};
+
 static inline uint16_t rte_pktmbuf_priv_size(struct rte_mempool *mp);
 
 /**
@@ -373,9 +403,17 @@ rte_mbuf_to_baddr(struct rte_mbuf *md)
 #define RTE_MBUF_INDIRECT(mb)   ((mb)->ol_flags & IND_ATTACHED_MBUF)
 
 /**
- * Returns TRUE if given mbuf is direct, or FALSE otherwise.
+ * Returns TRUE if given mbuf has an external buffer attached, or FALSE
+ * otherwise.
+ */
+#define RTE_MBUF_HAS_EXTBUF(mb) ((mb)->ol_flags & EXT_ATTACHED_MBUF)
+
+/**
+ * Returns TRUE if given mbuf is direct, or FALSE otherwise: its data is
+ * stored in its own buffer.
  */
-#define RTE_MBUF_DIRECT(mb)     (!RTE_MBUF_INDIRECT(mb))
+#define RTE_MBUF_DIRECT(mb) \
+	(!((mb)->ol_flags & (IND_ATTACHED_MBUF | EXT_ATTACHED_MBUF)))
 
 /**
  * Private data in case of pktmbuf pool.
@@ -527,6 +565,188 @@ rte_mbuf_refcnt_set(struct rte_mbuf *m, uint16_t new_value)
 void
 rte_mbuf_sanity_check(const struct rte_mbuf *m, int is_header);
 
+/**
+ * Operations recorded in the history of an mbuf. Values up to
+ * RTE_MBUF_HISTORY_OP_MAX can be used by applications from
+ * RTE_MBUF_HISTORY_OP_USER.
+ */
+enum rte_mbuf_history_op {
+	RTE_MBUF_HISTORY_OP_NONE = 0, /**< No event recorded. */
+	RTE_MBUF_HISTORY_OP_ALLOC,    /**< Allocated from its pool. */
+	RTE_MBUF_HISTORY_OP_FREE,     /**< Put back into its pool. */
+	RTE_MBUF_HISTORY_OP_ENQUEUE,  /**< Enqueued, e.g. in a ring. */
+	RTE_MBUF_HISTORY_OP_DEQUEUE,  /**< Dequeued, e.g. from a ring. */
+	RTE_MBUF_HISTORY_OP_USER,     /**< First application operation. */
+	RTE_MBUF_HISTORY_OP_MAX = 15, /**< Last application operation. */
+};
+
+/** Number of events kept in the history of each mbuf. */
+#define RTE_MBUF_HISTORY_DEPTH 4
+
+/** Largest owner identifier. */
+#define RTE_MBUF_HISTORY_OWNER_MAX 0xfff
+
+/** Number of pools whose history can be enabled during the process life. */
+#define RTE_MBUF_HISTORY_MAX_POOLS 32
+
+/** Owner used to record an event with the owner of the current lcore. */
+#define RTE_MBUF_HISTORY_OWNER_LCORE UINT16_MAX
+
+/** Owner of an event of the history of an mbuf. */
+#define RTE_MBUF_HISTORY_EV_OWNER(ev) ((uint16_t)((ev) & 0xfff))
+/** Operation of an event of the history of an mbuf. */
+#define RTE_MBUF_HISTORY_EV_OP(ev) ((unsigned)(((ev) >> 12) & 0xf))
+/** Low 48 bits of the TSC when an event of the history was recorded. */
+#define RTE_MBUF_HISTORY_EV_TSC(ev) ((ev) >> 16)
+
+/**
+ * History of an mbuf: its last events, the most recent first. Each
+ * event packs the low 48 bits of the TSC, the operation and the owner,
+ * see the RTE_MBUF_HISTORY_EV_*() macros.
+ */
+struct rte_mbuf_history {
+	uint64_t ev[RTE_MBUF_HISTORY_DEPTH]; /**< Events, 0 if none. */
+};
+
+/** Number of mempools with an enabled history, checked on the fast path. */
+extern volatile uint32_t rte_mbuf_history_nb_enabled;
+
+/**
+ * @internal Record an event in the history of an mbuf, if the history
+ * of its pool is enabled.
+ */
+void __rte_mbuf_history_record(struct rte_mbuf *m, uint16_t owner,
+	unsigned op);
+
+/**
+ * Record an event in the history of an mbuf.
+ *
+ * The library records the allocations and frees of mbufs, with the
+ * owner of the current lcore. Applications record the other events,
+ * such as enqueues and dequeues, to know where the mbufs in use are.
+ * Nothing is done if the history of the pool of the mbuf is not
+ * enabled.
+ *
+ * @param m
+ *   The mbuf.
+ * @param owner
+ *   An identifier of the module handling the mbuf, up to
+ *   RTE_MBUF_HISTORY_OWNER_MAX, or RTE_MBUF_HISTORY_OWNER_LCORE for the
+ *   owner of the current lcore (see rte_mbuf_history_set_owner()).
+ * @param op
+ *   The operation, from enum rte_mbuf_history_op.
+ */
+static inline void
+rte_mbuf_history_mark(struct rte_mbuf *m, uint16_t owner, unsigned op)
+{
+	if (unlikely(rte_mbuf_history_nb_enabled != 0))
+		__rte_mbuf_history_record(m, owner, op);
+}
+
+/**
+ * Record an event in the history of several mbufs.
+ *
+ * @param mbufs
+ *   An array of mbufs.
+ * @param count
+ *   The number of mbufs in the array.
+ * @param owner
+ *   See rte_mbuf_history_mark().
+ * @param op
+ *   See rte_mbuf_history_mark().
+ */
+static inline void
+rte_mbuf_history_mark_bulk(struct rte_mbuf * const *mbufs, unsigned count,
+	uint16_t owner, unsigned op)
+{
+	unsigned i;
+
+	if (likely(rte_mbuf_history_nb_enabled == 0))
+		return;
+	for (i = 0; i < count; i++)
+		__rte_mbuf_history_record(mbufs[i], owner, op);
+}
+
+/**
+ * Set the owner recorded by the library for the events of the current
+ * lcore, such as allocations and frees.
+ *
+ * @param owner
+ *   An identifier of the module, up to RTE_MBUF_HISTORY_OWNER_MAX. The
+ *   default owner is 0.
+ */
+void rte_mbuf_history_set_owner(uint16_t owner);
+
+/**
+ * Enable the history of the mbufs of a packet mbuf pool.
+ *
+ * A history of the last RTE_MBUF_HISTORY_DEPTH events is kept for each
+ * mbuf of the pool, in an array beside it. It costs a cache line write
+ * per event, and a single test on the fast path while disabled. Only
+ * the events recorded after the history is enabled are known.
+ *
+ * @param mp
+ *   The packet mbuf pool.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The private area of the pool is too small for a packet
+ *     mbuf pool, e.g. a ctrlmbuf pool.
+ *   - -ENOSPC: The history of RTE_MBUF_HISTORY_MAX_POOLS other pools was
+ *     already enabled.
+ *   - -ENOMEM: The history cannot be allocated.
+ */
+int rte_mbuf_history_enable(struct rte_mempool *mp);
+
+/**
+ * Disable the history of the mbufs of a packet mbuf pool.
+ *
+ * The recorded events are kept, they are still walked and dumped, and
+ * they are cleared if the history is enabled again.
+ *
+ * @param mp
+ *   The packet mbuf pool.
+ */
+void rte_mbuf_history_disable(struct rte_mempool *mp);
+
+/**
+ * Function called for each mbuf walked by rte_mbuf_history_walk().
+ */
+typedef void (rte_mbuf_history_walk_t)(struct rte_mbuf *m,
+	const struct rte_mbuf_history *h, void *arg);
+
+/**
+ * Walk the mbufs of a pool that are in use according to their history.
+ *
+ * An mbuf is considered in use if an event was recorded for it, and the
+ * last one is not a free. As the walk runs while the mbufs are used,
+ * the history of an mbuf may change while it is walked.
+ *
+ * @param mp
+ *   The packet mbuf pool.
+ * @param walk
+ *   The function called for each mbuf in use.
+ * @param arg
+ *   An argument given to the function.
+ * @return
+ *   The number of mbufs walked, or -ENOENT if the history of the pool
+ *   was never enabled.
+ */
+int rte_mbuf_history_walk(struct rte_mempool *mp,
+	rte_mbuf_history_walk_t *walk, void *arg);
+
+/**
+ * Dump the mbufs of a pool that are in use according to their history.
+ *
+ * One line is printed for each mbuf in use, with its events, then the
+ * number of mbufs in use for each last owner and operation.
+ *
+ * @param f
+ *   A pointer to a file for output.
+ * @param mp
+ *   The packet mbuf pool.
+ */
+void rte_mbuf_history_dump(FILE *f, struct rte_mempool *mp);
+
 /**
  * @internal Allocate a new mbuf from mempool *mp*.
  * The use of that function is reserved for RTE internal needs.
@@ -547,6 +767,8 @@ static inline struct rte_mbuf *__rte_mbuf_raw_alloc(struct rte_mempool *mp)
 	m = (struct rte_mbuf *)mb;
 	RTE_MBUF_ASSERT(rte_mbuf_refcnt_read(m) == 0);
 	rte_mbuf_refcnt_set(m, 1);
+	rte_mbuf_history_mark(m, RTE_MBUF_HISTORY_OWNER_LCORE,
+		RTE_MBUF_HISTORY_OP_ALLOC);
 	return m;
 }
 
@@ -562,6 +784,8 @@ static inline void __attribute__((always_inline))
 __rte_mbuf_raw_free(struct rte_mbuf *m)
 {
 	RTE_MBUF_ASSERT(rte_mbuf_refcnt_read(m) == 0);
+	rte_mbuf_history_mark(m, RTE_MBUF_HISTORY_OWNER_LCORE,
+		RTE_MBUF_HISTORY_OP_FREE);
 	rte_mempool_put(m->pool, m);
 }
 
@@ -817,6 +1041,259 @@ static inline struct rte_mbuf *rte_pktmbuf_alloc(struct rte_mempool *mp)
 	return m;
 }
 
+/**
+ * @internal Prepare a template mbuf for __rte_pktmbuf_reset_tmpl().
+ *
+ * Only the 32 bytes starting at buf_len are initialized: buf_len and
+ * the rearm data (data_off, refcnt, nb_segs, port), ol_flags, then the
+ * RX descriptor fields. They hold the values rte_pktmbuf_reset() would
+ * give to a new mbuf of the pool.
+ *
+ * @param mp
+ *   The packet mbuf pool.
+ * @param tmpl
+ *   The template mbuf to initialize.
+ */
+static inline void
+__rte_pktmbuf_tmpl_init(struct rte_mempool *mp, struct rte_mbuf *tmpl)
+{
+	uint16_t buf_len = rte_pktmbuf_data_room_size(mp);
+
+	/* the template is copied with two 16-byte stores */
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, ol_flags) !=
+		offsetof(struct rte_mbuf, buf_len) + 8);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, rx_descriptor_fields1) !=
+		offsetof(struct rte_mbuf, buf_len) + 16);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, hash) + 4 !=
+		offsetof(struct rte_mbuf, buf_len) + 32);
+
+	tmpl->buf_len = buf_len;
+	tmpl->data_off = RTE_MIN(RTE_PKTMBUF_HEADROOM, buf_len);
+	tmpl->refcnt = 1;
+	tmpl->nb_segs = 1;
+	tmpl->port = 0xff;
+	tmpl->ol_flags = 0;
+	tmpl->packet_type = 0;
+	tmpl->data_len = 0;
+	tmpl->pkt_len = 0;
+	tmpl->vlan_tci = 0;
+	tmpl->reserved = 0;
+	tmpl->hash.rss = 0;
+}
+
+/**
+ * @internal Reset a newly allocated packet mbuf from a template.
+ *
+ * This is equivalent to setting the reference counter to 1 and calling
+ * rte_pktmbuf_reset(), but the first cache line is written with two
+ * 16-byte stores from the template prepared by __rte_pktmbuf_tmpl_init().
+ * The hash field is cleared as a side effect.
+ *
+ * @param m
+ *   The mbuf to reset.
+ * @param tmpl
+ *   The template mbuf of the pool of m.
+ */
+static inline void
+__rte_pktmbuf_reset_tmpl(struct rte_mbuf *m, const struct rte_mbuf *tmpl)
+{
+	RTE_MBUF_ASSERT(rte_mbuf_refcnt_read(m) == 0);
+	RTE_MBUF_ASSERT(m->buf_len == tmpl->buf_len);
+
+	rte_mov16((uint8_t *)&m->buf_len, (const uint8_t *)&tmpl->buf_len);
+	rte_mov16((uint8_t *)m->rx_descriptor_fields1,
+		(const uint8_t *)tmpl->rx_descriptor_fields1);
+	m->next = NULL;
+	m->tx_offload = 0;
+	__rte_mbuf_sanity_check(m, 1);
+}
+
+/**
+ * Allocate a bulk of mbufs from a mempool.
+ *
+ * The mbufs are taken with a single call to rte_mempool_get_bulk(),
+ * then initialized like with rte_pktmbuf_alloc(): each contains one
+ * segment with a length of 0, and some bytes of headroom (if buffer
+ * size allows). The fields are written with wide stores from a template
+ * built once per call, which is much cheaper than allocating mbufs one
+ * at a time for bursts of packets.
+ *
+ * The mbufs of the pool must all have the data room size of the pool
+ * as buffer length, as set by rte_pktmbuf_init().
+ *
+ * @param mp
+ *   The mempool from which the mbufs are allocated.
+ * @param mbufs
+ *   Array where the pointers to the allocated mbufs are stored.
+ * @param count
+ *   The number of mbufs to allocate.
+ * @return
+ *   - 0: Success; count mbufs are allocated.
+ *   - -ENOENT: Not enough mbufs in the mempool; no mbuf is allocated.
+ */
+static inline int
+rte_pktmbuf_alloc_bulk(struct rte_mempool *mp, struct rte_mbuf **mbufs,
+	unsigned count)
+{
+	struct rte_mbuf tmpl;
+	unsigned i;
+	int ret;
+
+	ret = rte_mempool_get_bulk(mp, (void **)mbufs, count);
+	if (unlikely(ret < 0))
+		return ret;
+
+	__rte_pktmbuf_tmpl_init(mp, &tmpl);
+	for (i = 0; i < count; i++)
+		__rte_pktmbuf_reset_tmpl(mbufs[i], &tmpl);
+	rte_mbuf_history_mark_bulk(mbufs, count, RTE_MBUF_HISTORY_OWNER_LCORE,
+		RTE_MBUF_HISTORY_OP_ALLOC);
+
+	return 0;
+}
+
+/**
+ * Read the number of mbufs attached to an external buffer.
+ *
+ * @param shinfo
+ *   The shared info of the external buffer.
+ * @return
+ *   The reference counter of the external buffer.
+ */
+static inline uint16_t
+rte_mbuf_ext_refcnt_read(const struct rte_mbuf_ext_shared_info *shinfo)
+{
+	return (uint16_t)rte_atomic16_read(&shinfo->refcnt_atomic);
+}
+
+/**
+ * Set the number of mbufs attached to an external buffer.
+ *
+ * @param shinfo
+ *   The shared info of the external buffer.
+ * @param new_value
+ *   The new value of the reference counter.
+ */
+static inline void
+rte_mbuf_ext_refcnt_set(struct rte_mbuf_ext_shared_info *shinfo,
+	uint16_t new_value)
+{
+	rte_atomic16_set(&shinfo->refcnt_atomic, new_value);
+}
+
+/**
+ * Atomically add a value to the reference counter of an external buffer.
+ *
+ * @param shinfo
+ *   The shared info of the external buffer.
+ * @param value
+ *   The value to add to the reference counter.
+ * @return
+ *   The updated value of the reference counter.
+ */
+static inline uint16_t
+rte_mbuf_ext_refcnt_update(struct rte_mbuf_ext_shared_info *shinfo,
+	int16_t value)
+{
+	return (uint16_t)rte_atomic16_add_return(&shinfo->refcnt_atomic,
+		value);
+}
+
+/**
+ * Initialize the shared info of an external buffer at its end.
+ *
+ * The shared info is stored in the last bytes of the buffer, whose
+ * usable length is reduced accordingly. Its reference counter is set
+ * to 1, for the first mbuf the buffer is attached to.
+ *
+ * @param buf_addr
+ *   The address of the external buffer.
+ * @param buf_len
+ *   Pointer to the length of the external buffer. On success, it is
+ *   updated to the length that remains for data.
+ * @param free_cb
+ *   The function called when the last mbuf is detached from the buffer.
+ * @param fcb_opaque
+ *   An argument given to free_cb.
+ * @return
+ *   The pointer to the shared info, or NULL if the buffer is too small.
+ */
+static inline struct rte_mbuf_ext_shared_info *
+rte_pktmbuf_ext_shinfo_init_helper(void *buf_addr, uint16_t *buf_len,
+	rte_mbuf_extbuf_free_callback_t free_cb, void *fcb_opaque)
+{
+	struct rte_mbuf_ext_shared_info *shinfo;
+	void *buf_end = RTE_PTR_ADD(buf_addr, *buf_len);
+
+	shinfo = RTE_PTR_ALIGN_FLOOR(RTE_PTR_SUB(buf_end, sizeof(*shinfo)),
+		sizeof(uintptr_t));
+	if ((void *)shinfo <= buf_addr || (void *)shinfo > buf_end)
+		return NULL;
+
+	shinfo->free_cb = free_cb;
+	shinfo->fcb_opaque = fcb_opaque;
+	rte_mbuf_ext_refcnt_set(shinfo, 1);
+
+	*buf_len = (uint16_t)RTE_PTR_DIFF(shinfo, buf_addr);
+	return shinfo;
+}
+
+/**
+ * Attach an external buffer to a packet mbuf.
+ *
+ * The data of the mbuf are then stored in memory that does not belong
+ * to a mempool, typically application buffers, which avoids copying
+ * them. The buffer is described by a shared info, that holds the
+ * number of mbufs it is attached to and a callback to free it, called
+ * when the last of these mbufs is detached. Freeing the mbuf detaches
+ * it, and the clones made with rte_pktmbuf_clone() share the buffer.
+ *
+ * The reference counter of the shared info is not updated: it must
+ * account for this mbuf already, e.g. it is 1 after
+ * rte_pktmbuf_ext_shinfo_init_helper() for the first mbuf, and the
+ * caller increments it with rte_mbuf_ext_refcnt_update() before
+ * attaching the buffer to more mbufs.
+ *
+ * The mbuf must be direct and not shared; on return, its data offset
+ * and data length are set to 0.
+ *
+ * @param m
+ *   The packet mbuf.
+ * @param buf_addr
+ *   The address of the external buffer.
+ * @param buf_physaddr
+ *   The physical address of the external buffer, or RTE_BAD_PHYS_ADDR
+ *   if it is not used for DMA.
+ * @param buf_len
+ *   The length of the external buffer.
+ * @param shinfo
+ *   The shared info of the external buffer.
+ */
+static inline void
+rte_pktmbuf_attach_extbuf(struct rte_mbuf *m, void *buf_addr,
+	phys_addr_t buf_physaddr, uint16_t buf_len,
+	struct rte_mbuf_ext_shared_info *shinfo)
+{
+	RTE_MBUF_ASSERT(RTE_MBUF_DIRECT(m) &&
+	    rte_mbuf_refcnt_read(m) == 1);
+	RTE_MBUF_ASSERT(shinfo->free_cb != NULL);
+
+	m->buf_addr = buf_addr;
+	m->buf_physaddr = buf_physaddr;
+	m->buf_len = buf_len;
+	m->data_off = 0;
+	m->data_len = 0;
+	m->ol_flags |= EXT_ATTACHED_MBUF;
+	m->shinfo = shinfo;
+}
+
+/**
+ * Detach an external buffer from a packet mbuf.
+ *
+ * This is an alias of rte_pktmbuf_detach().
+ */
+#define rte_pktmbuf_detach_extbuf(m) rte_pktmbuf_detach(m)
+
 /**
  * Attach packet mbuf to another packet mbuf.
  *
@@ -827,6 +1304,9 @@ static inline struct rte_mbuf *rte_pktmbuf_alloc(struct rte_mempool *mp)
  *  - mbuf we trying to attach (mi) is used by someone else
  *    e.g. it's reference counter is greater then 1.
  *
+ * If m has an external buffer attached, mi is attached to the same
+ * external buffer instead, taking a reference in its shared info.
+ *
  * @param mi
  *   The indirect packet mbuf.
  * @param m
@@ -839,13 +1319,22 @@ static inline void rte_pktmbuf_attach(struct rte_mbuf *mi, struct rte_mbuf *m)
 	RTE_MBUF_ASSERT(RTE_MBUF_DIRECT(mi) &&
 	    rte_mbuf_refcnt_read(mi) == 1);
 
-	/* if m is not direct, get the mbuf that embeds the data */
-	if (RTE_MBUF_DIRECT(m))
-		md = m;
-	else
-		md = rte_mbuf_from_indirect(m);
+	if (RTE_MBUF_HAS_EXTBUF(m)) {
+		/* share the external buffer */
+		rte_mbuf_ext_refcnt_update(m->shinfo, 1);
+		mi->ol_flags = m->ol_flags;
+		mi->shinfo = m->shinfo;
+	} else {
+		/* if m is not direct, get the mbuf that embeds the data */
+		if (RTE_MBUF_DIRECT(m))
+			md = m;
+		else
+			md = rte_mbuf_from_indirect(m);
+
+		rte_mbuf_refcnt_update(md, 1);
+		mi->ol_flags = m->ol_flags | IND_ATTACHED_MBUF;
+	}
 
-	rte_mbuf_refcnt_update(md, 1);
 	mi->priv_size = m->priv_size;
 	mi->buf_physaddr = m->buf_physaddr;
 	mi->buf_addr = m->buf_addr;
@@ -862,7 +1351,6 @@ static inline void rte_pktmbuf_attach(struct rte_mbuf *mi, struct rte_mbuf *m)
 	mi->next = NULL;
 	mi->pkt_len = mi->data_len;
 	mi->nb_segs = 1;
-	mi->ol_flags = m->ol_flags | IND_ATTACHED_MBUF;
 	mi->packet_type = m->packet_type;
 
 	__rte_mbuf_sanity_check(mi, 1);
@@ -870,8 +1358,11 @@ static inline void rte_pktmbuf_attach(struct rte_mbuf *mi, struct rte_mbuf *m)
 }
 
 /**
- * Detach an indirect packet mbuf.
+ * Detach an indirect packet mbuf, or a packet mbuf from its external
+ * buffer.
  *
+ *  - drop the reference to the external buffer, if any, calling its
+ *    free callback if this was the last one.
  *  - restore original mbuf address and length values.
  *  - reset pktmbuf data and data_len to their default values.
  *  All other fields of the given packet mbuf will be left intact.
@@ -884,6 +1375,13 @@ static inline void rte_pktmbuf_detach(struct rte_mbuf *m)
 	struct rte_mempool *mp = m->pool;
 	uint32_t mbuf_size, buf_len, priv_size;
 
+	if (RTE_MBUF_HAS_EXTBUF(m)) {
+		struct rte_mbuf_ext_shared_info *shinfo = m->shinfo;
+
+		if (rte_mbuf_ext_refcnt_update(shinfo, -1) == 0)
+			shinfo->free_cb(m->buf_addr, shinfo->fcb_opaque);
+	}
+
 	priv_size = rte_pktmbuf_priv_size(mp);
 	mbuf_size = sizeof(struct rte_mbuf) + priv_size;
 	buf_len = rte_pktmbuf_data_room_size(mp);
@@ -907,12 +1405,15 @@ __rte_pktmbuf_prefree_seg(struct rte_mbuf *m)
 		/* if this is an indirect mbuf, then
 		 *  - detach mbuf
 		 *  - free attached mbuf segment
+		 * if it has an external buffer, detach it from the buffer
 		 */
 		if (RTE_MBUF_INDIRECT(m)) {
 			struct rte_mbuf *md = rte_mbuf_from_indirect(m);
 			rte_pktmbuf_detach(m);
 			if (rte_mbuf_refcnt_update(md, -1) == 0)
 				__rte_mbuf_raw_free(md);
+		} else if (RTE_MBUF_HAS_EXTBUF(m)) {
+			rte_pktmbuf_detach(m);
 		}
 		return m;
 	}
@@ -959,6 +1460,21 @@ static inline void rte_pktmbuf_free(struct rte_mbuf *m)
 	}
 }
 
+/**
+ * Free a bulk of packet mbufs back into their original mempools.
+ *
+ * Free each mbuf and all its segments like rte_pktmbuf_free(), taking
+ * care of reference counters and indirect mbufs. The segments to free
+ * are gathered by mempool and put back with rte_mempool_put_bulk(),
+ * instead of one call to the mempool per segment.
+ *
+ * @param mbufs
+ *   Array of packet mbufs to be freed. NULL entries are ignored.
+ * @param count
+ *   Number of entries in the mbufs array.
+ */
+void rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs, unsigned count);
+
 /**
  * Creates a "clone" of the given packet mbuf.
  *
@@ -1264,6 +1780,97 @@ static inline int rte_pktmbuf_is_contiguous(const struct rte_mbuf *m)
 	return !!(m->nb_segs == 1);
 }
 
+/**
+ * @internal Slow path of rte_pktmbuf_read(), when the data to read is
+ * not in the first segment.
+ */
+const void *__rte_pktmbuf_read(const struct rte_mbuf *m, uint32_t off,
+	uint32_t len, void *buf);
+
+/**
+ * Read data from a packet mbuf, possibly across segments.
+ *
+ * If the len bytes at offset off are in one segment, a pointer to them
+ * is returned and nothing is copied. Otherwise, they are copied into
+ * buf with rte_memcpy() and buf is returned.
+ *
+ * @param m
+ *   The packet mbuf.
+ * @param off
+ *   The offset of the data in the packet.
+ * @param len
+ *   The number of bytes to read.
+ * @param buf
+ *   A buffer of at least len bytes, used if the data spans several
+ *   segments.
+ * @return
+ *   A pointer to the data, in the mbuf or in buf, or NULL if the packet
+ *   is shorter than off + len bytes.
+ */
+static inline const void *
+rte_pktmbuf_read(const struct rte_mbuf *m, uint32_t off, uint32_t len,
+	void *buf)
+{
+	if (likely(off <= rte_pktmbuf_data_len(m) &&
+			len <= rte_pktmbuf_data_len(m) - off))
+		return rte_pktmbuf_mtod_offset(m, const char *, off);
+	return __rte_pktmbuf_read(m, off, len, buf);
+}
+
+/**
+ * @internal Slow path of rte_pktmbuf_linearize(), for chained mbufs.
+ */
+int __rte_pktmbuf_linearize(struct rte_mbuf *m);
+
+/**
+ * Linearize a packet mbuf in place.
+ *
+ * The data of all segments are copied at the end of the first segment,
+ * then the other segments are freed. This requires the tailroom of the
+ * first segment to be large enough for the data of the others, and the
+ * first segment not to be shared: not indirect, with a reference counter
+ * of 1 and, if it has an external buffer, with a reference counter of 1
+ * on that buffer.
+ *
+ * @param m
+ *   The packet mbuf.
+ * @return
+ *   - 0: Success, the mbuf has one segment.
+ *   - -1: Not enough tailroom, or shared first segment; the mbuf is
+ *     unchanged.
+ */
+static inline int rte_pktmbuf_linearize(struct rte_mbuf *m)
+{
+	if (rte_pktmbuf_is_contiguous(m))
+		return 0;
+	return __rte_pktmbuf_linearize(m);
+}
+
+/**
+ * Deep copy a packet mbuf into new mbufs.
+ *
+ * The bytes of the packet from offset off, at most len, are copied into
+ * mbufs allocated from mp, chained as needed. The metadata of the
+ * packet (port, offload flags and fields, hash and dynamic fields) are
+ * copied too. Unlike rte_pktmbuf_clone(), the copy does not share any
+ * data with the original packet.
+ *
+ * @param m
+ *   The packet mbuf to copy.
+ * @param mp
+ *   The mempool from which the new mbufs are allocated.
+ * @param off
+ *   The offset of the first byte to copy.
+ * @param len
+ *   The maximum number of bytes to copy, UINT32_MAX to copy up to the
+ *   end of the packet.
+ * @return
+ *   - The pointer to the new mbuf on success.
+ *   - NULL if off is beyond the end of the packet or allocation fails.
+ */
+struct rte_mbuf *rte_pktmbuf_copy(const struct rte_mbuf *m,
+	struct rte_mempool *mp, uint32_t off, uint32_t len);
+
 /**
  * Dump an mbuf structure to the console.
  *
@@ -0,0 +1,363 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_eal.h>
+#include <rte_eal_memconfig.h>
+#include <rte_memzone.h>
+#include <rte_rwlock.h>
+#include <rte_errno.h>
+
+#include "rte_mbuf.h"
+#include "rte_mbuf_dyn.h"
+
+#define RTE_MBUF_DYN_MZNAME "RTE_MBUF_DYN"
+
+/* size of the area reserved for dynamic fields */
+#define MBUF_DYNFIELD_AREA_SIZE \
+	(sizeof(((struct rte_mbuf *)0)->dynfield1))
+
+/* bits of ol_flags that are not used by static flags, between the RX
+ * flags (growing from bit 0) and the TX flags (growing from bit 55) */
+#define MBUF_DYNFLAG_FIRST 15
+#define MBUF_DYNFLAG_LAST  49
+#define MBUF_DYNFLAG_NUM   (MBUF_DYNFLAG_LAST - MBUF_DYNFLAG_FIRST + 1)
+
+struct mbuf_dynfield_elt {
+	struct rte_mbuf_dynfield params;
+	size_t offset;
+};
+
+struct mbuf_dynflag_elt {
+	struct rte_mbuf_dynflag params;
+	unsigned int bitnum;
+};
+
+/* registry, shared between processes */
+struct mbuf_dyn_shm {
+	uint8_t free_space[sizeof(struct rte_mbuf)]; /**< 1 if byte is free */
+	uint64_t free_flags;                         /**< free ol_flags bits */
+	unsigned int nb_fields;
+	unsigned int nb_flags;
+	struct mbuf_dynfield_elt fields[MBUF_DYNFIELD_AREA_SIZE];
+	struct mbuf_dynflag_elt flags[MBUF_DYNFLAG_NUM];
+};
+
+static struct mbuf_dyn_shm *shm;
+
+/* attach to the registry, creating it if needed; called with the tailq
+ * lock held for writing */
+static int
+init_shared_mem(void)
+{
+	const struct rte_memzone *mz;
+	size_t off;
+	unsigned int bit;
+
+	if (shm != NULL)
+		return 0;
+
+	mz = rte_memzone_lookup(RTE_MBUF_DYN_MZNAME);
+	if (mz == NULL && rte_eal_process_type() == RTE_PROC_PRIMARY) {
+		mz = rte_memzone_reserve_aligned(RTE_MBUF_DYN_MZNAME,
+			sizeof(struct mbuf_dyn_shm), SOCKET_ID_ANY, 0,
+			RTE_CACHE_LINE_SIZE);
+		if (mz == NULL) {
+			RTE_LOG(ERR, MBUF, "Cannot allocate dynamic field registry\n");
+			rte_errno = ENOMEM;
+			return -1;
+		}
+		memset(mz->addr, 0, sizeof(struct mbuf_dyn_shm));
+		shm = mz->addr;
+		off = offsetof(struct rte_mbuf, dynfield1);
+		memset(&shm->free_space[off], 1, MBUF_DYNFIELD_AREA_SIZE);
+		for (bit = MBUF_DYNFLAG_FIRST; bit <= MBUF_DYNFLAG_LAST; bit++)
+			shm->free_flags |= 1ULL << bit;
+		return 0;
+	}
+	if (mz == NULL) {
+		rte_errno = ENOENT;
+		return -1;
+	}
+
+	shm = mz->addr;
+	return 0;
+}
+
+/* check that a name is nul-terminated and not empty */
+static int
+check_name(const char *name)
+{
+	size_t len = strnlen(name, RTE_MBUF_DYN_NAMESIZE);
+
+	if (len == 0) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+	if (len == RTE_MBUF_DYN_NAMESIZE) {
+		rte_errno = ENAMETOOLONG;
+		return -1;
+	}
+	return 0;
+}
+
+static struct mbuf_dynfield_elt *
+dynfield_find(const char *name)
+{
+	unsigned int i;
+
+	for (i = 0; i < shm->nb_fields; i++) {
+		if (strcmp(shm->fields[i].params.name, name) == 0)
+			return &shm->fields[i];
+	}
+	return NULL;
+}
+
+static struct mbuf_dynflag_elt *
+dynflag_find(const char *name)
+{
+	unsigned int i;
+
+	for (i = 0; i < shm->nb_flags; i++) {
+		if (strcmp(shm->flags[i].params.name, name) == 0)
+			return &shm->flags[i];
+	}
+	return NULL;
+}
+
+/* return the first aligned offset where size bytes are free, or -1 */
+static int
+dynfield_find_space(size_t size, size_t align)
+{
+	size_t off, i;
+
+	for (off = 0; off + size <= sizeof(shm->free_space); off += align) {
+		for (i = 0; i < size; i++) {
+			if (shm->free_space[off + i] == 0)
+				break;
+		}
+		if (i == size)
+			return (int)off;
+	}
+	return -1;
+}
+
+/* register a dynamic field */
+int
+rte_mbuf_dynfield_register(const struct rte_mbuf_dynfield *params)
+{
+	struct mbuf_dynfield_elt *elt;
+	int offset = -1;
+
+	if (params == NULL || params->size == 0 || params->flags != 0 ||
+			params->size > MBUF_DYNFIELD_AREA_SIZE ||
+			!rte_is_power_of_2(params->align)) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+	if (check_name(params->name) < 0)
+		return -1;
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (init_shared_mem() < 0)
+		goto exit;
+
+	elt = dynfield_find(params->name);
+	if (elt != NULL) {
+		if (elt->params.size != params->size ||
+				elt->params.align != params->align ||
+				elt->params.flags != params->flags)
+			rte_errno = EEXIST;
+		else
+			offset = (int)elt->offset;
+		goto exit;
+	}
+
+	offset = dynfield_find_space(params->size, params->align);
+	if (offset < 0 || shm->nb_fields == RTE_DIM(shm->fields)) {
+		rte_errno = ENOENT;
+		offset = -1;
+		goto exit;
+	}
+
+	elt = &shm->fields[shm->nb_fields];
+	elt->params = *params;
+	elt->offset = offset;
+	memset(&shm->free_space[offset], 0, params->size);
+	shm->nb_fields++;
+
+	RTE_LOG(DEBUG, MBUF, "Registered dynamic field %s at offset %d\n",
+		params->name, offset);
+
+exit:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+	return offset;
+}
+
+/* look up a dynamic field */
+int
+rte_mbuf_dynfield_lookup(const char *name, struct rte_mbuf_dynfield *params)
+{
+	struct mbuf_dynfield_elt *elt = NULL;
+	int offset = -1;
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (init_shared_mem() == 0)
+		elt = dynfield_find(name);
+	if (elt != NULL) {
+		if (params != NULL)
+			*params = elt->params;
+		offset = (int)elt->offset;
+	}
+
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (offset < 0)
+		rte_errno = ENOENT;
+	return offset;
+}
+
+/* register a dynamic flag */
+int
+rte_mbuf_dynflag_register(const struct rte_mbuf_dynflag *params)
+{
+	struct mbuf_dynflag_elt *elt;
+	int bitnum = -1;
+
+	if (params == NULL || params->flags != 0) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+	if (check_name(params->name) < 0)
+		return -1;
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (init_shared_mem() < 0)
+		goto exit;
+
+	elt = dynflag_find(params->name);
+	if (elt != NULL) {
+		if (elt->params.flags != params->flags)
+			rte_errno = EEXIST;
+		else
+			bitnum = (int)elt->bitnum;
+		goto exit;
+	}
+
+	if (shm->free_flags == 0) {
+		rte_errno = ENOENT;
+		goto exit;
+	}
+
+	/* take the most significant free bit */
+	bitnum = 63 - __builtin_clzll(shm->free_flags);
+	elt = &shm->flags[shm->nb_flags];
+	elt->params = *params;
+	elt->bitnum = bitnum;
+	shm->free_flags &= ~(1ULL << bitnum);
+	shm->nb_flags++;
+
+	RTE_LOG(DEBUG, MBUF, "Registered dynamic flag %s at bit %d\n",
+		params->name, bitnum);
+
+exit:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+	return bitnum;
+}
+
+/* look up a dynamic flag */
+int
+rte_mbuf_dynflag_lookup(const char *name, struct rte_mbuf_dynflag *params)
+{
+	struct mbuf_dynflag_elt *elt = NULL;
+	int bitnum = -1;
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (init_shared_mem() == 0)
+		elt = dynflag_find(name);
+	if (elt != NULL) {
+		if (params != NULL)
+			*params = elt->params;
+		bitnum = (int)elt->bitnum;
+	}
+
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (bitnum < 0)
+		rte_errno = ENOENT;
+	return bitnum;
+}
+
+/* dump the registry */
+void
+rte_mbuf_dyn_dump(FILE *f)
+{
+	unsigned int i, nb_free = 0;
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (init_shared_mem() < 0) {
+		fprintf(f, "no dynamic fields/flags registry\n");
+		goto exit;
+	}
+
+	fprintf(f, "Dynamic fields:\n");
+	for (i = 0; i < shm->nb_fields; i++)
+		fprintf(f, "  %s: offset=%zu size=%zu align=%zu\n",
+			shm->fields[i].params.name, shm->fields[i].offset,
+			shm->fields[i].params.size,
+			shm->fields[i].params.align);
+	for (i = 0; i < sizeof(shm->free_space); i++)
+		nb_free += shm->free_space[i];
+	fprintf(f, "  free bytes: %u\n", nb_free);
+
+	fprintf(f, "Dynamic flags:\n");
+	for (i = 0; i < shm->nb_flags; i++)
+		fprintf(f, "  %s: bit=%u\n", shm->flags[i].params.name,
+			shm->flags[i].bitnum);
+	fprintf(f, "  free flags: 0x%"PRIx64"\n", shm->free_flags);
+
+exit:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+}
@@ -0,0 +1,178 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_MBUF_DYN_H_
+#define _RTE_MBUF_DYN_H_
+
+/**
+ * @file
+ * RTE Mbuf dynamic fields and flags
+ *
+ * The end of the second cache line of struct rte_mbuf (the dynfield1
+ * area) and the bits of ol_flags that are not used by the PKT_RX_*
+ * and PKT_TX_* flags are not assigned statically. Libraries and
+ * applications reserve them at initialization by registering a named
+ * field (a range of bytes) or flag (a bit), and get its offset in the
+ * mbuf or its bit number. On the fast path, the field or flag is then
+ * accessed at this fixed location, in a cache line that is touched
+ * anyway, rather than in a side table.
+ *
+ * Registering a name that is already registered with the same
+ * parameters returns the same offset or bit, so that independent
+ * modules can share a field by agreeing on its name. The registry is
+ * stored in a memzone, so that secondary processes see the fields and
+ * flags registered by the primary one.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RTE_MBUF_DYN_NAMESIZE 64 /**< Max length of a field or flag name. */
+
+/**
+ * Parameters of a dynamic field.
+ */
+struct rte_mbuf_dynfield {
+	char name[RTE_MBUF_DYN_NAMESIZE]; /**< Name of the field. */
+	size_t size;        /**< Size of the field, in bytes. */
+	size_t align;       /**< Alignment of the field, a power of 2. */
+	unsigned int flags; /**< Reserved for future use, must be 0. */
+};
+
+/**
+ * Parameters of a dynamic flag.
+ */
+struct rte_mbuf_dynflag {
+	char name[RTE_MBUF_DYN_NAMESIZE]; /**< Name of the flag. */
+	unsigned int flags; /**< Reserved for future use, must be 0. */
+};
+
+/**
+ * Register a dynamic field in the mbuf structure.
+ *
+ * The field is placed in the free bytes of the mbuf structure, at an
+ * offset aligned on params->align. If a field with the same name was
+ * already registered with the same parameters, its offset is returned.
+ *
+ * @param params
+ *   The parameters of the field.
+ * @return
+ *   The offset of the field in the mbuf structure on success, or -1 on
+ *   error with rte_errno set:
+ *   - EINVAL: invalid parameters (size, alignment, flags or name).
+ *   - ENAMETOOLONG: the name is not nul-terminated.
+ *   - EEXIST: the name is registered with different parameters.
+ *   - ENOENT: not enough free space in the mbuf structure.
+ *   - ENOMEM: the registry cannot be allocated.
+ */
+int rte_mbuf_dynfield_register(const struct rte_mbuf_dynfield *params);
+
+/**
+ * Look up a registered dynamic field.
+ *
+ * @param name
+ *   The name of the field.
+ * @param params
+ *   If not NULL, filled with the parameters of the field.
+ * @return
+ *   The offset of the field in the mbuf structure on success, or -1 on
+ *   error with rte_errno set to ENOENT if the field is not registered.
+ */
+int rte_mbuf_dynfield_lookup(const char *name,
+	struct rte_mbuf_dynfield *params);
+
+/**
+ * Register a dynamic flag in the ol_flags field of mbufs.
+ *
+ * If a flag with the same name was already registered, its bit number
+ * is returned.
+ *
+ * @param params
+ *   The parameters of the flag.
+ * @return
+ *   The bit number of the flag in ol_flags on success, or -1 on error
+ *   with rte_errno set:
+ *   - EINVAL: invalid parameters (flags or name).
+ *   - ENAMETOOLONG: the name is not nul-terminated.
+ *   - EEXIST: the name is registered with different parameters.
+ *   - ENOENT: no free bit in ol_flags.
+ *   - ENOMEM: the registry cannot be allocated.
+ */
+int rte_mbuf_dynflag_register(const struct rte_mbuf_dynflag *params);
+
+/**
+ * Look up a registered dynamic flag.
+ *
+ * @param name
+ *   The name of the flag.
+ * @param params
+ *   If not NULL, filled with the parameters of the flag.
+ * @return
+ *   The bit number of the flag in ol_flags on success, or -1 on error
+ *   with rte_errno set to ENOENT if the flag is not registered.
+ */
+int rte_mbuf_dynflag_lookup(const char *name,
+	struct rte_mbuf_dynflag *params);
+
+/**
+ * Dump the registered dynamic fields and flags, and the free space.
+ *
+ * @param f
+ *   A pointer to a file for output.
+ */
+void rte_mbuf_dyn_dump(FILE *f);
+
+/**
+ * Get a pointer to a dynamic field of an mbuf.
+ *
+ * @param m
+ *   The mbuf.
+ * @param offset
+ *   The offset of the field, as returned by rte_mbuf_dynfield_register()
+ *   or rte_mbuf_dynfield_lookup().
+ * @param type
+ *   The type of the returned pointer.
+ */
+#define RTE_MBUF_DYNFIELD(m, offset, type) \
+	((type)((uintptr_t)(m) + (offset)))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MBUF_DYN_H_ */
@@ -39,6 +39,8 @@
 #include <inttypes.h>
 #include <errno.h>
 #include <sys/queue.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 
 #include <rte_common.h>
 #include <rte_log.h>
@@ -126,6 +128,56 @@ static unsigned optimize_object_size(unsigned obj_size)
 	return new_obj_size * RTE_CACHE_LINE_SIZE;
 }
 
+static void
+mempool_cache_init(struct rte_mempool_cache *cache, uint32_t size)
+{
+	cache->size = size;
+	cache->flushthresh = CALC_CACHE_FLUSHTHRESH(size);
+	cache->len = 0;
+}
+
+/*
+ * Return the memory needed by the caches of the enabled lcores, 0 if
+ * the mempool has no cache.
+ */
+static size_t
+mempool_cache_mem_size(uint32_t cache_size)
+{
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	unsigned lcore_id, count = 0;
+
+	if (cache_size == 0)
+		return 0;
+
+	RTE_LCORE_FOREACH(lcore_id)
+		count++;
+
+	return (size_t)count * RTE_MEMPOOL_CACHE_MEMSIZE(cache_size);
+#else
+	RTE_SET_USED(cache_size);
+	return 0;
+#endif
+}
+
+/* attach the caches stored at addr to the enabled lcores */
+static void
+mempool_cache_setup(struct rte_mempool *mp, void *addr)
+{
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	unsigned lcore_id;
+
+	RTE_LCORE_FOREACH(lcore_id) {
+		mp->local_cache[lcore_id] = addr;
+		mempool_cache_init(addr, mp->cache_size);
+		addr = RTE_PTR_ADD(addr,
+			RTE_MEMPOOL_CACHE_MEMSIZE(mp->cache_size));
+	}
+#else
+	RTE_SET_USED(mp);
+	RTE_SET_USED(addr);
+#endif
+}
+
 static void
 mempool_add_elem(struct rte_mempool *mp, void *obj, uint32_t obj_idx,
 	rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg)
@@ -148,8 +200,8 @@ mempool_add_elem(struct rte_mempool *mp, void *obj, uint32_t obj_idx,
 	if (obj_init)
 		obj_init(mp, obj_init_arg, obj, obj_idx);
 
-	/* enqueue in ring */
-	rte_ring_sp_enqueue(mp->ring, obj);
+	/* enqueue in the backend */
+	rte_mempool_ops_enqueue_bulk(mp, &obj, 1);
 }
 
 uint32_t
@@ -297,10 +349,11 @@ rte_mempool_calc_obj_size(uint32_t elt_size, uint32_t flags,
 		sz->trailer_size = new_size - sz->header_size - sz->elt_size;
 	}
 
-	if (! rte_eal_has_hugepages()) {
+	if (!rte_eal_has_hugepages() && (flags & MEMPOOL_F_ANON) == 0) {
 		/*
 		 * compute trailer size so that pool elements fit exactly in
-		 * a standard page
+		 * a standard page; objects in anonymous memory do not need
+		 * it, as their physical address is their virtual address
 		 */
 		int page_size = getpagesize();
 		int new_size = page_size - sz->header_size - sz->elt_size;
@@ -375,6 +428,64 @@ rte_mempool_xmem_usage(void *vaddr, uint32_t elt_num, size_t elt_sz,
 	return usz;
 }
 
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+
+/*
+ * Map anonymous memory to store the objects of a mempool. The mapping
+ * is aligned on a 2M boundary and advised to be backed by transparent
+ * huge pages to limit TLB misses. If socket_id is a valid socket,
+ * the pages are preferably taken from that NUMA node: a preferred
+ * rather than strict policy is used so that an exhausted node does not
+ * get the process killed when the objects are first written.
+ */
+static void *
+mempool_anon_map(size_t len, int socket_id)
+{
+	uintptr_t va, start;
+	void *addr;
+
+	len = RTE_ALIGN_CEIL(len, RTE_PGSIZE_2M);
+
+	/* over-allocate, then trim the mapping to a 2M boundary */
+	addr = mmap(NULL, len + RTE_PGSIZE_2M, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (addr == MAP_FAILED) {
+		RTE_LOG(ERR, MEMPOOL, "%s(): mmap() failed: %s\n",
+			__func__, strerror(errno));
+		return NULL;
+	}
+	va = (uintptr_t)addr;
+	start = RTE_ALIGN_CEIL(va, RTE_PGSIZE_2M);
+	if (start != va)
+		munmap(addr, start - va);
+	munmap((void *)(start + len), va + RTE_PGSIZE_2M - start);
+	addr = (void *)start;
+
+#ifdef MADV_HUGEPAGE
+	if (madvise(addr, len, MADV_HUGEPAGE) < 0)
+		RTE_LOG(DEBUG, MEMPOOL, "%s(): no transparent huge pages: %s\n",
+			__func__, strerror(errno));
+#endif
+
+#ifdef SYS_mbind
+	if (socket_id >= 0 && socket_id < RTE_MAX_NUMA_NODES) {
+		unsigned long nodemask = 1UL << socket_id;
+
+		if (syscall(SYS_mbind, addr, len, MPOL_PREFERRED, &nodemask,
+				sizeof(nodemask) * CHAR_BIT, 0) < 0)
+			RTE_LOG(DEBUG, MEMPOOL,
+				"%s(): cannot bind to socket %d: %s\n",
+				__func__, socket_id, strerror(errno));
+	}
+#else
+	RTE_SET_USED(socket_id);
+#endif
+
+	return addr;
+}
+
 /* create the mempool */
 struct rte_mempool *
 rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
@@ -399,35 +510,33 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
 #endif
 }
 
-/*
- * Create the mempool over already allocated chunk of memory.
- * That external memory buffer can consists of physically disjoint pages.
- * Setting vaddr to NULL, makes mempool to fallback to original behaviour
- * and allocate space for mempool and it's elements as one big chunk of
- * physically continuos memory.
- * */
-struct rte_mempool *
-rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
+/* create the mempool, with its objects stored in the backend ops_name */
+static struct rte_mempool *
+mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 		unsigned cache_size, unsigned private_data_size,
 		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
 		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
 		int socket_id, unsigned flags, void *vaddr,
-		const phys_addr_t paddr[], uint32_t pg_num, uint32_t pg_shift)
+		const phys_addr_t paddr[], uint32_t pg_num, uint32_t pg_shift,
+		const char *ops_name)
 {
 	char mz_name[RTE_MEMZONE_NAMESIZE];
-	char rg_name[RTE_RING_NAMESIZE];
 	struct rte_mempool_list *mempool_list;
 	struct rte_mempool *mp = NULL;
 	struct rte_tailq_entry *te;
-	struct rte_ring *r;
 	const struct rte_memzone *mz;
 	size_t mempool_size;
+	size_t cache_mem_size;
 	int mz_flags = RTE_MEMZONE_1GB|RTE_MEMZONE_SIZE_HINT_ONLY;
-	int rg_flags = 0;
+	int ops_index;
+	int ret;
 	void *obj;
 	struct rte_mempool_objsz objsz;
 	void *startaddr;
 	int page_size = getpagesize();
+	void *anon_va = NULL;
+	size_t anon_len = 0;
+	phys_addr_t anon_pa;
 
 	/* compilation-time checks */
 	RTE_BUILD_BUG_ON((sizeof(struct rte_mempool) &
@@ -435,8 +544,6 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 	RTE_BUILD_BUG_ON((sizeof(struct rte_mempool_cache) &
 			  RTE_CACHE_LINE_MASK) != 0);
-	RTE_BUILD_BUG_ON((offsetof(struct rte_mempool, local_cache) &
-			  RTE_CACHE_LINE_MASK) != 0);
 #endif
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
 	RTE_BUILD_BUG_ON((sizeof(struct rte_mempool_debug_stats) &
@@ -470,11 +577,17 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	if (flags & MEMPOOL_F_NO_CACHE_ALIGN)
 		flags |= MEMPOOL_F_NO_SPREAD;
 
-	/* ring flags */
-	if (flags & MEMPOOL_F_SP_PUT)
-		rg_flags |= RING_F_SP_ENQ;
-	if (flags & MEMPOOL_F_SC_GET)
-		rg_flags |= RING_F_SC_DEQ;
+	/* without an explicit backend, use a ring that stays safe for the
+	 * "mp" and "mc" functions; the SP/SC flags only select the default
+	 * path of put and get */
+	if (ops_name == NULL)
+		ops_name = RTE_MEMPOOL_OPS_RING_MP_MC;
+	ops_index = rte_mempool_ops_lookup(ops_name);
+	if (ops_index < 0) {
+		RTE_LOG(ERR, MEMPOOL, "Unknown mempool ops <%s>\n", ops_name);
+		rte_errno = -ops_index;
+		return NULL;
+	}
 
 	/* calculate mempool object sizes. */
 	if (!rte_mempool_calc_obj_size(elt_size, flags, &objsz)) {
@@ -482,16 +595,27 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 		return NULL;
 	}
 
-	rte_rwlock_write_lock(RTE_EAL_MEMPOOL_RWLOCK);
+	/*
+	 * When asked to, store the objects in anonymous memory instead of
+	 * the memzone of the mempool. The objects then have no physical
+	 * address: elt_pa is set to their virtual address, like the EAL
+	 * does for its own memory when hugepages are disabled.
+	 */
+	if ((flags & MEMPOOL_F_ANON) && vaddr == NULL && n != 0) {
+		anon_len = (size_t)objsz.total_size * n;
+		anon_va = mempool_anon_map(anon_len, socket_id);
+		if (anon_va == NULL) {
+			rte_errno = ENOMEM;
+			return NULL;
+		}
+		anon_pa = (phys_addr_t)(uintptr_t)anon_va;
+		vaddr = anon_va;
+		paddr = &anon_pa;
+		pg_num = MEMPOOL_PG_NUM_DEFAULT;
+		pg_shift = MEMPOOL_PG_SHIFT_MAX;
+	}
 
-	/* allocate the ring that will be used to store objects */
-	/* Ring functions will return appropriate errors if we are
-	 * running as a secondary process etc., so no checks made
-	 * in this function for that condition */
-	snprintf(rg_name, sizeof(rg_name), RTE_MEMPOOL_MZ_FORMAT, name);
-	r = rte_ring_create(rg_name, rte_align32pow2(n+1), socket_id, rg_flags);
-	if (r == NULL)
-		goto exit;
+	rte_rwlock_write_lock(RTE_EAL_MEMPOOL_RWLOCK);
 
 	/*
 	 * reserve a memory zone for this mempool: private data is
@@ -528,6 +652,11 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	if (vaddr == NULL)
 		mempool_size += (size_t)objsz.total_size * n;
 
+	/* per-lcore caches are stored after the objects */
+	cache_mem_size = mempool_cache_mem_size(cache_size);
+	if (cache_mem_size != 0)
+		mempool_size += cache_mem_size + RTE_CACHE_LINE_SIZE;
+
 	if (! rte_eal_has_hugepages()) {
 		/*
 		 * we want the memory pool to start on a page boundary,
@@ -541,10 +670,9 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 
 	mz = rte_memzone_reserve(mz_name, mempool_size, socket_id, mz_flags);
 
-	/*
-	 * no more memory: in this case we loose previously reserved
-	 * space for the ring as we cannot free it
-	 */
+	/* Memzone functions will return appropriate errors if we are
+	 * running as a secondary process etc., so no checks made
+	 * in this function for that condition */
 	if (mz == NULL) {
 		rte_free(te);
 		goto exit;
@@ -567,9 +695,10 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	memset(mp, 0, sizeof(*mp));
 	snprintf(mp->name, sizeof(mp->name), "%s", name);
 	mp->phys_addr = mz->phys_addr;
-	mp->ring = r;
 	mp->size = n;
 	mp->flags = flags;
+	mp->ops_index = ops_index;
+	mp->socket_id = socket_id;
 	mp->elt_size = objsz.elt_size;
 	mp->header_size = objsz.header_size;
 	mp->trailer_size = objsz.trailer_size;
@@ -600,6 +729,29 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 
 	mp->elt_va_end = mp->elt_va_start;
 
+	if (cache_mem_size != 0) {
+		void *caches = (char *)obj;
+
+		if (vaddr == NULL)
+			caches = (char *)obj + (size_t)objsz.total_size * n;
+		mempool_cache_setup(mp, RTE_PTR_ALIGN_CEIL(caches,
+			RTE_CACHE_LINE_SIZE));
+	}
+
+	/*
+	 * allocate the backend that will be used to store objects; on
+	 * failure, we lose the memzone of the mempool as we cannot free it
+	 */
+	ret = rte_mempool_get_ops(ops_index)->alloc(mp);
+	if (ret < 0) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot allocate mempool ops <%s>\n",
+			ops_name);
+		rte_errno = -ret;
+		rte_free(te);
+		mp = NULL;
+		goto exit;
+	}
+
 	/* call the initializer */
 	if (mp_init)
 		mp_init(mp, mp_init_arg);
@@ -613,18 +765,173 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
 
 exit:
+	if (mp == NULL && anon_va != NULL)
+		munmap(anon_va, RTE_ALIGN_CEIL(anon_len, RTE_PGSIZE_2M));
 	rte_rwlock_write_unlock(RTE_EAL_MEMPOOL_RWLOCK);
 
 	return mp;
 }
 
+/* create the mempool over the backend named ops_name */
+struct rte_mempool *
+rte_mempool_create_with_ops(const char *name, unsigned n, unsigned elt_size,
+		unsigned cache_size, unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, const char *ops_name)
+{
+	return mempool_xmem_create(name, n, elt_size,
+		cache_size, private_data_size,
+		mp_init, mp_init_arg,
+		obj_init, obj_init_arg,
+		socket_id, flags,
+		NULL, NULL, MEMPOOL_PG_NUM_DEFAULT, MEMPOOL_PG_SHIFT_MAX,
+		ops_name);
+}
+
+/*
+ * Create the mempool over already allocated chunk of memory.
+ * That external memory buffer can consists of physically disjoint pages.
+ * Setting vaddr to NULL, makes mempool to fallback to original behaviour
+ * and allocate space for mempool and it's elements as one big chunk of
+ * physically continuos memory.
+ * */
+struct rte_mempool *
+rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
+		unsigned cache_size, unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, void *vaddr,
+		const phys_addr_t paddr[], uint32_t pg_num, uint32_t pg_shift)
+{
+	return mempool_xmem_create(name, n, elt_size,
+		cache_size, private_data_size,
+		mp_init, mp_init_arg,
+		obj_init, obj_init_arg,
+		socket_id, flags,
+		vaddr, paddr, pg_num, pg_shift, NULL);
+}
+
+/* create a user-owned cache */
+struct rte_mempool_cache *
+rte_mempool_cache_create(uint32_t size, int socket_id)
+{
+	struct rte_mempool_cache *cache;
+
+	if (size == 0 || size > RTE_MEMPOOL_CACHE_MAX_SIZE) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	cache = rte_zmalloc_socket("MEMPOOL_CACHE",
+		RTE_MEMPOOL_CACHE_MEMSIZE(size), RTE_CACHE_LINE_SIZE, socket_id);
+	if (cache == NULL) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot allocate mempool cache!\n");
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	mempool_cache_init(cache, size);
+	return cache;
+}
+
+/* free a user-owned cache */
+void
+rte_mempool_cache_free(struct rte_mempool_cache *cache)
+{
+	rte_free(cache);
+}
+
+/* start collecting runtime statistics */
+int
+rte_mempool_stats_enable(struct rte_mempool *mp)
+{
+	struct rte_mempool_stats *st = mp->stats_mem;
+
+	if (st == NULL) {
+		st = rte_zmalloc_socket("MEMPOOL_STATS",
+			sizeof(*st) * RTE_MAX_LCORE, RTE_CACHE_LINE_SIZE,
+			mp->socket_id);
+		if (st == NULL) {
+			RTE_LOG(ERR, MEMPOOL, "Cannot allocate statistics of %s\n",
+				mp->name);
+			return -ENOMEM;
+		}
+		mp->stats_mem = st;
+	}
+
+	rte_mempool_stats_reset(mp);
+	rte_wmb();
+	mp->rt_stats = st;
+	return 0;
+}
+
+/* stop collecting runtime statistics; the storage is kept, as other
+ * lcores may still be using it */
+void
+rte_mempool_stats_disable(struct rte_mempool *mp)
+{
+	mp->rt_stats = NULL;
+}
+
+/* reset the runtime statistics */
+void
+rte_mempool_stats_reset(struct rte_mempool *mp)
+{
+	struct rte_mempool_stats *st = mp->stats_mem;
+	unsigned lcore_id;
+
+	if (st == NULL)
+		return;
+
+	memset(st, 0, sizeof(*st) * RTE_MAX_LCORE);
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		st[lcore_id].common_pool_low = UINT32_MAX;
+}
+
+/* read the runtime statistics of one lcore, or of all of them */
+int
+rte_mempool_stats_get(const struct rte_mempool *mp, unsigned lcore_id,
+	struct rte_mempool_stats *stats)
+{
+	const struct rte_mempool_stats *st;
+	unsigned i;
+
+	if (mp->stats_mem == NULL)
+		return -ENOENT;
+
+	if (lcore_id != LCORE_ID_ANY) {
+		if (lcore_id >= RTE_MAX_LCORE)
+			return -EINVAL;
+		*stats = mp->stats_mem[lcore_id];
+		return 0;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	stats->common_pool_low = UINT32_MAX;
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		st = &mp->stats_mem[i];
+		stats->get_cache_hit += st->get_cache_hit;
+		stats->get_cache_miss += st->get_cache_miss;
+		stats->cache_refill += st->cache_refill;
+		stats->put_cache += st->put_cache;
+		stats->cache_flush += st->cache_flush;
+		stats->get_common += st->get_common;
+		stats->put_common += st->put_common;
+		stats->get_fail += st->get_fail;
+		if (st->common_pool_low < stats->common_pool_low)
+			stats->common_pool_low = st->common_pool_low;
+	}
+	return 0;
+}
+
 /* Return the number of entries in the mempool */
 unsigned
 rte_mempool_count(const struct rte_mempool *mp)
 {
 	unsigned count;
 
-	count = rte_ring_count(mp->ring);
+	count = rte_mempool_get_ops(mp->ops_index)->get_count(mp);
 
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 	{
@@ -632,8 +939,10 @@ rte_mempool_count(const struct rte_mempool *mp)
 		if (mp->cache_size == 0)
 			return count;
 
-		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
-			count += mp->local_cache[lcore_id].len;
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+			if (mp->local_cache[lcore_id] != NULL)
+				count += mp->local_cache[lcore_id]->len;
+		}
 	}
 #endif
 
@@ -658,7 +967,9 @@ rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 	fprintf(f, "  cache infos:\n");
 	fprintf(f, "    cache_size=%"PRIu32"\n", mp->cache_size);
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		cache_count = mp->local_cache[lcore_id].len;
+		if (mp->local_cache[lcore_id] == NULL)
+			continue;
+		cache_count = mp->local_cache[lcore_id]->len;
 		fprintf(f, "    cache_count[%u]=%u\n", lcore_id, cache_count);
 		count += cache_count;
 	}
@@ -671,6 +982,30 @@ rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 #endif
 }
 
+/* dump the runtime statistics, if they were ever enabled */
+static void
+rte_mempool_dump_rt_stats(FILE *f, const struct rte_mempool *mp)
+{
+	struct rte_mempool_stats sum;
+
+	if (rte_mempool_stats_get(mp, LCORE_ID_ANY, &sum) < 0)
+		return;
+
+	fprintf(f, "  runtime stats (%s):\n",
+		mp->rt_stats != NULL ? "enabled" : "disabled");
+	fprintf(f, "    get_cache_hit=%"PRIu64"\n", sum.get_cache_hit);
+	fprintf(f, "    get_cache_miss=%"PRIu64"\n", sum.get_cache_miss);
+	fprintf(f, "    cache_refill=%"PRIu64"\n", sum.cache_refill);
+	fprintf(f, "    put_cache=%"PRIu64"\n", sum.put_cache);
+	fprintf(f, "    cache_flush=%"PRIu64"\n", sum.cache_flush);
+	fprintf(f, "    get_common=%"PRIu64"\n", sum.get_common);
+	fprintf(f, "    put_common=%"PRIu64"\n", sum.put_common);
+	fprintf(f, "    get_fail=%"PRIu64"\n", sum.get_fail);
+	if (sum.common_pool_low != UINT32_MAX)
+		fprintf(f, "    common_pool_low=%"PRIu32"\n",
+			sum.common_pool_low);
+}
+
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
 /* check cookies before and after objects */
 #ifndef __INTEL_COMPILER
@@ -741,7 +1076,10 @@ mempool_audit_cache(const struct rte_mempool *mp)
 	/* check cache size consistency */
 	unsigned lcore_id;
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		if (mp->local_cache[lcore_id].len > mp->cache_flushthresh) {
+		const struct rte_mempool_cache *cache;
+
+		cache = mp->local_cache[lcore_id];
+		if (cache != NULL && cache->len > cache->flushthresh) {
 			RTE_LOG(CRIT, MEMPOOL, "badness on cache[%u]\n",
 				lcore_id);
 			rte_panic("MEMPOOL: invalid cache len\n");
@@ -780,7 +1118,8 @@ rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 
 	fprintf(f, "mempool <%s>@%p\n", mp->name, mp);
 	fprintf(f, "  flags=%x\n", mp->flags);
-	fprintf(f, "  ring=<%s>@%p\n", mp->ring->name, mp->ring);
+	fprintf(f, "  ops=<%s>@%p\n",
+		rte_mempool_get_ops(mp->ops_index)->name, mp->pool_data);
 	fprintf(f, "  phys_addr=0x%" PRIx64 "\n", mp->phys_addr);
 	fprintf(f, "  size=%"PRIu32"\n", mp->size);
 	fprintf(f, "  header_size=%"PRIu32"\n", mp->header_size);
@@ -803,7 +1142,7 @@ rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 			mp->size);
 
 	cache_count = rte_mempool_dump_cache(f, mp);
-	common_count = rte_ring_count(mp->ring);
+	common_count = rte_mempool_get_ops(mp->ops_index)->get_count(mp);
 	if ((cache_count + common_count) > mp->size)
 		common_count = mp->size - cache_count;
 	fprintf(f, "  common_pool_count=%u\n", common_count);
@@ -830,6 +1169,8 @@ rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 	fprintf(f, "  no statistics available\n");
 #endif
 
+	rte_mempool_dump_rt_stats(f, mp);
+
 	rte_mempool_audit(mp);
 }
 
@@ -39,10 +39,12 @@
  * RTE Mempool.
  *
  * A memory pool is an allocator of fixed-size object. It is
- * identified by its name, and uses a ring to store free objects. It
- * provides some other optional services, like a per-core object
- * cache, and an alignment helper to ensure that objects are padded
- * to spread them equally on all RAM channels, ranks, and so on.
+ * identified by its name, and stores its free objects in a backend
+ * selected at creation time through a table of operations (a ring by
+ * default, see rte_mempool_create_with_ops()). It provides some other
+ * optional services, like a per-core object cache, and an alignment
+ * helper to ensure that objects are padded to spread them equally on
+ * all RAM channels, ranks, and so on.
  *
  * Objects owned by a mempool should never be added in another
  * mempool. When an object is freed using rte_mempool_put() or
@@ -71,6 +73,7 @@
 #include <rte_lcore.h>
 #include <rte_memory.h>
 #include <rte_branch_prediction.h>
+#include <rte_spinlock.h>
 #include <rte_ring.h>
 
 #ifdef __cplusplus
@@ -95,19 +98,49 @@ struct rte_mempool_debug_stats {
 } __rte_cache_aligned;
 #endif
 
-#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 /**
- * A structure that stores a per-core object cache.
+ * A structure that stores the runtime statistics of a mempool, for one
+ * lcore or summed over all lcores. Each get or put call is counted once,
+ * whatever its number of objects. See rte_mempool_stats_enable().
+ */
+struct rte_mempool_stats {
+	uint64_t get_cache_hit;  /**< Gets served from the cache content. */
+	uint64_t get_cache_miss; /**< Gets that had to refill the cache. */
+	uint64_t cache_refill;   /**< Successful refills of the cache. */
+	uint64_t put_cache;      /**< Puts stored in the cache. */
+	uint64_t cache_flush;    /**< Flushes of the cache to the common pool. */
+	uint64_t get_common;     /**< Gets served by the common pool directly. */
+	uint64_t put_common;     /**< Puts done in the common pool directly. */
+	uint64_t get_fail;       /**< Gets that failed. */
+	/**
+	 * Lowest number of objects left in the common pool after a get
+	 * from it, UINT32_MAX if no get reached the common pool.
+	 */
+	uint32_t common_pool_low;
+} __rte_cache_aligned;
+
+/**
+ * A structure that stores an object cache: either a per-core cache
+ * embedded in the mempool, or a user-owned one created with
+ * rte_mempool_cache_create().
  */
 struct rte_mempool_cache {
-	unsigned len; /**< Cache len */
+	uint32_t size;        /**< Size of the cache */
+	uint32_t flushthresh; /**< Threshold before we flush excess elements */
+	uint32_t len;         /**< Cache len */
 	/*
-	 * Cache is allocated to this size to allow it to overflow in certain
-	 * cases to avoid needless emptying of cache.
+	 * Cache is allocated to 3 times its size to allow it to overflow in
+	 * certain cases to avoid needless emptying of cache.
 	 */
-	void *objs[RTE_MEMPOOL_CACHE_MAX_SIZE * 3]; /**< Cache objects */
+	void *objs[0]; /**< Cache objects */
 } __rte_cache_aligned;
-#endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
+
+/**
+ * Memory needed by a cache of the given size, rounded up to a cache line.
+ */
+#define RTE_MEMPOOL_CACHE_MEMSIZE(size)					\
+	RTE_CACHE_LINE_ROUNDUP(sizeof(struct rte_mempool_cache) +	\
+		(size) * 3 * sizeof(void *))
 
 /**
  * A structure that stores the size of mempool elements.
@@ -174,9 +207,14 @@ struct rte_mempool_objtlr {
  */
 struct rte_mempool {
 	char name[RTE_MEMPOOL_NAMESIZE]; /**< Name of mempool. */
-	struct rte_ring *ring;           /**< Ring to store objects. */
+	union {
+		void *pool_data;         /**< Data of the mempool backend. */
+		struct rte_ring *ring;   /**< Ring to store objects. */
+	};
 	phys_addr_t phys_addr;           /**< Phys. addr. of mempool struct. */
 	int flags;                       /**< Flags of the mempool. */
+	int32_t ops_index;               /**< Index of the backend ops. */
+	int socket_id;                   /**< Socket of the mempool memory. */
 	uint32_t size;                   /**< Size of the mempool. */
 	uint32_t cache_size;             /**< Size of per-lcore local cache. */
 	uint32_t cache_flushthresh;
@@ -188,9 +226,18 @@ struct rte_mempool {
 
 	unsigned private_data_size;      /**< Size of private data. */
 
+	/** Storage of the per-lcore runtime statistics. */
+	struct rte_mempool_stats *stats_mem;
+	/** Per-lcore runtime statistics, NULL when disabled. */
+	struct rte_mempool_stats *volatile rt_stats;
+
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	/** Per-lcore local cache. */
-	struct rte_mempool_cache local_cache[RTE_MAX_LCORE];
+	/**
+	 * Per-lcore local cache, only allocated for the lcores enabled
+	 * when the mempool is created; NULL for the others, or if the
+	 * mempool has no cache.
+	 */
+	struct rte_mempool_cache *local_cache[RTE_MAX_LCORE];
 #endif
 
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
@@ -217,6 +264,217 @@ struct rte_mempool {
 #define MEMPOOL_F_NO_CACHE_ALIGN 0x0002 /**< Do not align objs on cache lines.*/
 #define MEMPOOL_F_SP_PUT         0x0004 /**< Default put is "single-producer".*/
 #define MEMPOOL_F_SC_GET         0x0008 /**< Default get is "single-consumer".*/
+#define MEMPOOL_F_ANON           0x0010 /**< Objects in anonymous memory. */
+
+#define RTE_MEMPOOL_OPS_NAMESIZE 32 /**< Max length of a backend name. */
+#define RTE_MEMPOOL_MAX_OPS_IDX  16 /**< Max number of registered backends. */
+
+/** Name of the default backend, a multi-producer/multi-consumer ring. */
+#define RTE_MEMPOOL_OPS_RING_MP_MC "ring_mp_mc"
+
+/**
+ * Allocate the backend data of a mempool and store it in mp->pool_data.
+ * The size, name, flags and socket_id fields of the mempool are set
+ * when this function is called.
+ *
+ * @return
+ *   0 on success, a negative errno value otherwise.
+ */
+typedef int (*rte_mempool_alloc_t)(struct rte_mempool *mp);
+
+/**
+ * Store n objects in the backend. The backend is sized to hold all
+ * the objects of the pool, so this function is not expected to fail.
+ */
+typedef int (*rte_mempool_enqueue_t)(struct rte_mempool *mp,
+		void * const *obj_table, unsigned n);
+
+/**
+ * Take n objects from the backend. Either all of them are supplied, or
+ * none and -ENOENT is returned.
+ */
+typedef int (*rte_mempool_dequeue_t)(struct rte_mempool *mp,
+		void **obj_table, unsigned n);
+
+/**
+ * Return the number of objects stored in the backend.
+ */
+typedef unsigned (*rte_mempool_get_count_t)(const struct rte_mempool *mp);
+
+/**
+ * Additional information about a mempool backend.
+ */
+struct rte_mempool_info {
+	/** Number of objects in a contiguous block, 0 if not supported. */
+	unsigned contig_block_size;
+};
+
+/**
+ * Fill the information about the backend of a mempool. Optional.
+ */
+typedef int (*rte_mempool_get_info_t)(const struct rte_mempool *mp,
+		struct rte_mempool_info *info);
+
+/**
+ * Take n blocks of contig_block_size adjacent objects from the backend
+ * and store the first object of each block in first_obj_table. Either
+ * all blocks are supplied, or none and -ENOENT is returned. Optional.
+ */
+typedef int (*rte_mempool_dequeue_contig_blocks_t)(struct rte_mempool *mp,
+		void **first_obj_table, unsigned n);
+
+/**
+ * Operations of a mempool backend, i.e. the common store of the free
+ * objects that sits behind the per-lcore caches.
+ */
+struct rte_mempool_ops {
+	char name[RTE_MEMPOOL_OPS_NAMESIZE]; /**< Name of the backend. */
+	rte_mempool_alloc_t alloc;           /**< Allocate backend data. */
+	rte_mempool_enqueue_t enqueue;       /**< Store objects. */
+	rte_mempool_dequeue_t dequeue;       /**< Take objects. */
+	rte_mempool_get_count_t get_count;   /**< Count stored objects. */
+	rte_mempool_get_info_t get_info;     /**< Get backend info. */
+	/** Take blocks of adjacent objects. */
+	rte_mempool_dequeue_contig_blocks_t dequeue_contig_blocks;
+	/** Store objects, from a single producer at a time. Optional,
+	 * enqueue is used instead if it is NULL. */
+	rte_mempool_enqueue_t sp_enqueue;
+	/** Take objects, from a single consumer at a time. Optional,
+	 * dequeue is used instead if it is NULL. */
+	rte_mempool_dequeue_t sc_dequeue;
+} __rte_cache_aligned;
+
+/**
+ * Table of the registered mempool backends.
+ *
+ * A mempool refers to its backend by index in this table, so that the
+ * reference stays valid in secondary processes, provided that they
+ * register the same backends in the same order as the primary (which
+ * is the case when they run the same binary).
+ */
+struct rte_mempool_ops_table {
+	rte_spinlock_t sl;     /**< Lock for registration. */
+	uint32_t num_ops;      /**< Number of registered backends. */
+	/** Registered backends. */
+	struct rte_mempool_ops ops[RTE_MEMPOOL_MAX_OPS_IDX];
+} __rte_cache_aligned;
+
+/** Table of the registered mempool backends. */
+extern struct rte_mempool_ops_table rte_mempool_ops_table;
+
+/**
+ * @internal Get the operations of a mempool backend from its index.
+ */
+static inline struct rte_mempool_ops *
+rte_mempool_get_ops(int ops_index)
+{
+	RTE_VERIFY((unsigned)ops_index < RTE_MEMPOOL_MAX_OPS_IDX);
+
+	return &rte_mempool_ops_table.ops[ops_index];
+}
+
+/**
+ * @internal Take n objects from the backend of a mempool.
+ */
+static inline int
+rte_mempool_ops_dequeue_bulk(struct rte_mempool *mp,
+		void **obj_table, unsigned n)
+{
+	struct rte_mempool_ops *ops = rte_mempool_get_ops(mp->ops_index);
+
+	return ops->dequeue(mp, obj_table, n);
+}
+
+/**
+ * @internal Store n objects in the backend of a mempool.
+ */
+static inline int
+rte_mempool_ops_enqueue_bulk(struct rte_mempool *mp,
+		void * const *obj_table, unsigned n)
+{
+	struct rte_mempool_ops *ops = rte_mempool_get_ops(mp->ops_index);
+
+	return ops->enqueue(mp, obj_table, n);
+}
+
+/**
+ * @internal Take n objects from the backend of a mempool, from a single
+ * consumer at a time.
+ */
+static inline int
+rte_mempool_ops_sc_dequeue_bulk(struct rte_mempool *mp,
+		void **obj_table, unsigned n)
+{
+	struct rte_mempool_ops *ops = rte_mempool_get_ops(mp->ops_index);
+
+	if (ops->sc_dequeue != NULL)
+		return ops->sc_dequeue(mp, obj_table, n);
+	return ops->dequeue(mp, obj_table, n);
+}
+
+/**
+ * @internal Store n objects in the backend of a mempool, from a single
+ * producer at a time.
+ */
+static inline int
+rte_mempool_ops_sp_enqueue_bulk(struct rte_mempool *mp,
+		void * const *obj_table, unsigned n)
+{
+	struct rte_mempool_ops *ops = rte_mempool_get_ops(mp->ops_index);
+
+	if (ops->sp_enqueue != NULL)
+		return ops->sp_enqueue(mp, obj_table, n);
+	return ops->enqueue(mp, obj_table, n);
+}
+
+/**
+ * Get the information about the backend of a mempool.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param info
+ *   The structure to fill; fields not supported by the backend are
+ *   set to 0.
+ * @return
+ *   - 0: Success.
+ *   - -ENOTSUP: The backend does not provide any information.
+ */
+int rte_mempool_ops_get_info(const struct rte_mempool *mp,
+		struct rte_mempool_info *info);
+
+/**
+ * Register a mempool backend.
+ *
+ * @param ops
+ *   The operations of the backend; they are copied in the table.
+ * @return
+ *   - >=0: Index of the backend in rte_mempool_ops_table.
+ *   - -EINVAL: An operation is missing or the name is invalid.
+ *   - -EEXIST: A backend with the same name is already registered.
+ *   - -ENOSPC: The table is full.
+ */
+int rte_mempool_register_ops(const struct rte_mempool_ops *ops);
+
+/**
+ * Look up a registered mempool backend by name.
+ *
+ * @param name
+ *   The name of the backend.
+ * @return
+ *   The index of the backend in rte_mempool_ops_table, or -ENOENT.
+ */
+int rte_mempool_ops_lookup(const char *name);
+
+/**
+ * Register a mempool backend at startup, from a constructor.
+ */
+#define MEMPOOL_REGISTER_OPS(ops)					\
+	void mp_hdlr_init_##ops(void);					\
+	void __attribute__((constructor, used)) mp_hdlr_init_##ops(void)\
+	{								\
+		if (rte_mempool_register_ops(&ops) < 0)			\
+			rte_panic("Cannot register mempool ops " #ops "\n");\
+	}
 
 /**
  * @internal When debug is enabled, store some statistics.
@@ -240,6 +498,50 @@ struct rte_mempool {
 #define __MEMPOOL_STAT_ADD(mp, name, n) do {} while(0)
 #endif
 
+/**
+ * @internal Increment a runtime statistic of the calling lcore, if the
+ * statistics are enabled. Calls from non-EAL threads are not counted.
+ *
+ * @param mp
+ *   Pointer to the memory pool.
+ * @param name
+ *   Name of the field of struct rte_mempool_stats to increment.
+ */
+#define __MEMPOOL_RT_STAT_INC(mp, name) do {                            \
+		struct rte_mempool_stats *__st = (mp)->rt_stats;        \
+		if (unlikely(__st != NULL)) {                           \
+			unsigned __lcore_id = rte_lcore_id();           \
+			if (__lcore_id < RTE_MAX_LCORE)                 \
+				__st[__lcore_id].name++;                \
+		}                                                       \
+	} while (0)
+
+/**
+ * @internal Record the number of objects left in the common pool after
+ * a get from it, if the runtime statistics are enabled.
+ *
+ * @param mp
+ *   Pointer to the memory pool.
+ */
+static inline void
+__mempool_rt_stat_low(struct rte_mempool *mp)
+{
+	struct rte_mempool_stats *st = mp->rt_stats;
+	unsigned lcore_id;
+	unsigned count;
+
+	if (likely(st == NULL))
+		return;
+
+	lcore_id = rte_lcore_id();
+	if (lcore_id >= RTE_MAX_LCORE)
+		return;
+
+	count = rte_mempool_get_ops(mp->ops_index)->get_count(mp);
+	if (count < st[lcore_id].common_pool_low)
+		st[lcore_id].common_pool_low = count;
+}
+
 /**
  * Calculate the size of the mempool header.
  *
@@ -470,9 +772,9 @@ typedef void (rte_mempool_ctor_t)(struct rte_mempool *, void *);
  *   never be used. The access to the per-lcore table is of course
  *   faster than the multi-producer/consumer pool. The cache can be
  *   disabled if the cache_size argument is set to 0; it can be useful to
- *   avoid losing objects in cache. Note that even if not used, the
- *   memory space for cache is always reserved in a mempool structure,
- *   except if CONFIG_RTE_MEMPOOL_CACHE_MAX_SIZE is set to 0.
+ *   avoid losing objects in cache. The memory of the caches is sized
+ *   after cache_size, and only reserved for the lcores enabled at
+ *   creation time; other lcores use the common pool directly.
  * @param private_data_size
  *   The size of the private data appended after the mempool
  *   structure. This is useful for storing some private data after the
@@ -515,6 +817,12 @@ typedef void (rte_mempool_ctor_t)(struct rte_mempool *, void *);
  *   - MEMPOOL_F_SC_GET: If this flag is set, the default behavior
  *     when using rte_mempool_get() or rte_mempool_get_bulk() is
  *     "single-consumer". Otherwise, it is "multi-consumers".
+ *   - MEMPOOL_F_ANON: If this flag is set, the objects are not stored
+ *     in the memzone of the mempool but in anonymous memory, backed by
+ *     transparent huge pages when possible and preferably placed on
+ *     *socket_id*. Such objects have no physical address and must not
+ *     be used for DMA. It is meant for an EAL running without
+ *     hugepages, where it also avoids padding each object to a page.
  * @return
  *   The pointer to the new allocated mempool, on success. NULL on error
  *   with rte_errno set appropriately. Possible rte_errno values include:
@@ -532,6 +840,46 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
 		   rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
 		   int socket_id, unsigned flags);
 
+/**
+ * Create a new mempool named *name* in memory, storing its free objects
+ * in the backend *ops_name*.
+ *
+ * The parameters are the same as rte_mempool_create(), plus the name of
+ * a registered backend. The following backends are always available:
+ *   - "ring_mp_mc": a ring, the backend of rte_mempool_create(). It
+ *     also implements the single-producer and single-consumer paths
+ *     used by the "sp" and "sc" put and get functions.
+ *   - "ring_sp_mc", "ring_mp_sc", "ring_sp_sc": a ring which is only
+ *     safe with a single producer and/or consumer, including through
+ *     the "mp" and "mc" put and get functions.
+ *   - "stack": a lock-free LIFO. Objects are reused in the reverse
+ *     order of their release, so recently freed (cache-hot) objects are
+ *     handed out first.
+ *   - "single": a LIFO without any atomic operation, for pools that are
+ *     only accessed by one thread at a time.
+ *   - "bucket": objects grouped in blocks of adjacent objects, which
+ *     can be taken as a whole with rte_mempool_get_contig_blocks(). It
+ *     requires the objects to be virtually contiguous.
+ *
+ * The MEMPOOL_F_SP_PUT and MEMPOOL_F_SC_GET flags only select the
+ * default put and get path; they do not change the backend.
+ *
+ * @param ops_name
+ *   The name of the backend, or NULL for the "ring_mp_mc" backend of
+ *   rte_mempool_create().
+ * @return
+ *   The pointer to the new allocated mempool, on success. NULL on error
+ *   with rte_errno set appropriately. In addition to the values listed
+ *   in rte_mempool_create(), rte_errno can be ENOENT if no backend is
+ *   registered under *ops_name*.
+ */
+struct rte_mempool *
+rte_mempool_create_with_ops(const char *name, unsigned n, unsigned elt_size,
+		unsigned cache_size, unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, const char *ops_name);
+
 /**
  * Create a new mempool named *name* in memory.
  *
@@ -560,9 +908,9 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
  *   never be used. The access to the per-lcore table is of course
  *   faster than the multi-producer/consumer pool. The cache can be
  *   disabled if the cache_size argument is set to 0; it can be useful to
- *   avoid losing objects in cache. Note that even if not used, the
- *   memory space for cache is always reserved in a mempool structure,
- *   except if CONFIG_RTE_MEMPOOL_CACHE_MAX_SIZE is set to 0.
+ *   avoid losing objects in cache. The memory of the caches is sized
+ *   after cache_size, and only reserved for the lcores enabled at
+ *   creation time; other lcores use the common pool directly.
  * @param private_data_size
  *   The size of the private data appended after the mempool
  *   structure. This is useful for storing some private data after the
@@ -605,9 +953,17 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
  *   - MEMPOOL_F_SC_GET: If this flag is set, the default behavior
  *     when using rte_mempool_get() or rte_mempool_get_bulk() is
  *     "single-consumer". Otherwise, it is "multi-consumers".
+ *   - MEMPOOL_F_ANON: If this flag is set, the objects are not stored
+ *     in the memzone of the mempool but in anonymous memory, backed by
+ *     transparent huge pages when possible and preferably placed on
+ *     *socket_id*. Such objects have no physical address and must not
+ *     be used for DMA. It is meant for an EAL running without
+ *     hugepages, where it also avoids padding each object to a page.
  * @param vaddr
  *   Virtual address of the externally allocated memory buffer.
- *   Will be used to store mempool objects.
+ *   Will be used to store mempool objects. If NULL, the objects are
+ *   stored in the memzone of the mempool, or in anonymous memory if
+ *   MEMPOOL_F_ANON is set in *flags*.
  * @param paddr
  *   Array of physical addresses of the pages that comprises given memory
  *   buffer.
@@ -660,9 +1016,9 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
  *   never be used. The access to the per-lcore table is of course
  *   faster than the multi-producer/consumer pool. The cache can be
  *   disabled if the cache_size argument is set to 0; it can be useful to
- *   avoid losing objects in cache. Note that even if not used, the
- *   memory space for cache is always reserved in a mempool structure,
- *   except if CONFIG_RTE_MEMPOOL_CACHE_MAX_SIZE is set to 0.
+ *   avoid losing objects in cache. The memory of the caches is sized
+ *   after cache_size, and only reserved for the lcores enabled at
+ *   creation time; other lcores use the common pool directly.
  * @param private_data_size
  *   The size of the private data appended after the mempool
  *   structure. This is useful for storing some private data after the
@@ -705,6 +1061,12 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
  *   - MEMPOOL_F_SC_GET: If this flag is set, the default behavior
  *     when using rte_mempool_get() or rte_mempool_get_bulk() is
  *     "single-consumer". Otherwise, it is "multi-consumers".
+ *   - MEMPOOL_F_ANON: If this flag is set, the objects are not stored
+ *     in the memzone of the mempool but in anonymous memory, backed by
+ *     transparent huge pages when possible and preferably placed on
+ *     *socket_id*. Such objects have no physical address and must not
+ *     be used for DMA. It is meant for an EAL running without
+ *     hugepages, where it also avoids padding each object to a page.
  * @return
  *   The pointer to the new allocated mempool, on success. NULL on error
  *   with rte_errno set appropriately. Possible rte_errno values include:
@@ -733,6 +1095,144 @@ rte_dom0_mempool_create(const char *name, unsigned n, unsigned elt_size,
  */
 void rte_mempool_dump(FILE *f, const struct rte_mempool *mp);
 
+/**
+ * Start collecting runtime statistics on a mempool.
+ *
+ * The statistics count cache hits and misses, cache refills and
+ * flushes, gets and puts that go directly to the common pool, failed
+ * gets, and the low watermark of the common pool. The counters are
+ * per-lcore, so no atomic operation is added to the data path; calls
+ * from non-EAL threads are not counted. Unlike the statistics of
+ * RTE_LIBRTE_MEMPOOL_DEBUG, they do not need a specific build.
+ *
+ * When disabled, the cost is one test per get or put. This function can
+ * be called at any time; the statistics are reset.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @return
+ *   - 0: Success.
+ *   - -ENOMEM: Cannot allocate the statistics.
+ */
+int rte_mempool_stats_enable(struct rte_mempool *mp);
+
+/**
+ * Stop collecting runtime statistics on a mempool.
+ *
+ * The statistics collected so far can still be read with
+ * rte_mempool_stats_get().
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ */
+void rte_mempool_stats_disable(struct rte_mempool *mp);
+
+/**
+ * Reset the runtime statistics of a mempool.
+ *
+ * Counters updated by other lcores at the same time may not be reset.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ */
+void rte_mempool_stats_reset(struct rte_mempool *mp);
+
+/**
+ * Read the runtime statistics of a mempool.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param lcore_id
+ *   The lcore to read the statistics of, or LCORE_ID_ANY to sum them
+ *   over all lcores (the low watermark being the lowest of all lcores).
+ * @param stats
+ *   A pointer to a structure that is filled with the statistics.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid lcore_id.
+ *   - -ENOENT: The statistics were never enabled on this mempool.
+ */
+int rte_mempool_stats_get(const struct rte_mempool *mp, unsigned lcore_id,
+	struct rte_mempool_stats *stats);
+
+/**
+ * Get the default per-lcore cache of a mempool.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param lcore_id
+ *   The lcore id, usually rte_lcore_id().
+ * @return
+ *   The cache of the lcore in the mempool, or NULL if the mempool has no
+ *   cache, if lcore_id is not a valid lcore (non-EAL thread) or if the
+ *   lcore was not enabled when the mempool was created.
+ */
+static inline struct rte_mempool_cache * __attribute__((always_inline))
+rte_mempool_default_cache(struct rte_mempool *mp, unsigned lcore_id)
+{
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	if (lcore_id >= RTE_MAX_LCORE)
+		return NULL;
+
+	return mp->local_cache[lcore_id];
+#else
+	RTE_SET_USED(mp);
+	RTE_SET_USED(lcore_id);
+	return NULL;
+#endif
+}
+
+/**
+ * Create a user-owned mempool cache.
+ *
+ * Such a cache can be used by any thread, including non-EAL threads, to
+ * get and put objects with rte_mempool_generic_get() and
+ * rte_mempool_generic_put(). It is not thread-safe: it must be used by
+ * one thread at a time. It must be used with only one mempool until it
+ * is flushed with rte_mempool_cache_flush().
+ *
+ * @param size
+ *   The size of the cache, see the cache_size argument of
+ *   rte_mempool_create(). It must be between 1 and
+ *   CONFIG_RTE_MEMPOOL_CACHE_MAX_SIZE.
+ * @param socket_id
+ *   The socket identifier where the cache is allocated, or SOCKET_ID_ANY.
+ * @return
+ *   A pointer to the cache, or NULL on error with rte_errno set to
+ *   EINVAL (invalid size) or ENOMEM.
+ */
+struct rte_mempool_cache *
+rte_mempool_cache_create(uint32_t size, int socket_id);
+
+/**
+ * Free a user-owned mempool cache. The cache must have been flushed
+ * before, otherwise its objects are lost.
+ *
+ * @param cache
+ *   A pointer to the cache, created by rte_mempool_cache_create().
+ */
+void
+rte_mempool_cache_free(struct rte_mempool_cache *cache);
+
+/**
+ * Put all the objects of a cache back in the common pool of a mempool.
+ *
+ * @param cache
+ *   A pointer to the cache.
+ * @param mp
+ *   A pointer to the mempool the objects of the cache belong to.
+ */
+static inline void __attribute__((always_inline))
+rte_mempool_cache_flush(struct rte_mempool_cache *cache,
+			struct rte_mempool *mp)
+{
+	if (cache->len == 0)
+		return;
+
+	rte_mempool_ops_enqueue_bulk(mp, cache->objs, cache->len);
+	cache->len = 0;
+}
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -742,43 +1242,41 @@ void rte_mempool_dump(FILE *f, const struct rte_mempool *mp);
  * @param n
  *   The number of objects to store back in the mempool, must be strictly
  *   positive.
+ * @param cache
+ *   The cache to put the objects in, or NULL to put them directly in the
+ *   common pool.
  * @param is_mp
- *   Mono-producer (0) or multi-producers (1).
+ *   Put in the common pool with the single-producer (0) or the
+ *   multi-producers (1) path of the backend.
  */
 static inline void __attribute__((always_inline))
-__mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
-		    unsigned n, int is_mp)
+__mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
+		      unsigned n, struct rte_mempool_cache *cache, int is_mp)
 {
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	struct rte_mempool_cache *cache;
 	uint32_t index;
 	void **cache_objs;
-	unsigned lcore_id = rte_lcore_id();
-	uint32_t cache_size = mp->cache_size;
-	uint32_t flushthresh = mp->cache_flushthresh;
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
 	/* increment stat now, adding in mempool always success */
 	__MEMPOOL_STAT_ADD(mp, put, n);
 
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	/* cache is not enabled or single producer or non-EAL thread */
-	if (unlikely(cache_size == 0 || is_mp == 0 ||
-		     lcore_id >= RTE_MAX_LCORE))
+	/* no cache (disabled, single producer or non-EAL thread) */
+	if (unlikely(cache == NULL))
 		goto ring_enqueue;
 
-	/* Go straight to ring if put would overflow mem allocated for cache */
-	if (unlikely(n > RTE_MEMPOOL_CACHE_MAX_SIZE))
+	/* Go straight to backend if put would overflow mem allocated for cache */
+	if (unlikely(n > cache->size))
 		goto ring_enqueue;
 
-	cache = &mp->local_cache[lcore_id];
 	cache_objs = &cache->objs[cache->len];
 
 	/*
 	 * The cache follows the following algorithm
 	 *   1. Add the objects to the cache
 	 *   2. Anything greater than the cache min value (if it crosses the
-	 *   cache flush threshold) is flushed to the ring.
+	 *   cache flush threshold) is flushed to the backend.
 	 */
 
 	/* Add elements back into the cache */
@@ -786,36 +1284,84 @@ __mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 		cache_objs[index] = *obj_table;
 
 	cache->len += n;
+	__MEMPOOL_RT_STAT_INC(mp, put_cache);
 
-	if (cache->len >= flushthresh) {
-		rte_ring_mp_enqueue_bulk(mp->ring, &cache->objs[cache_size],
-				cache->len - cache_size);
-		cache->len = cache_size;
+	if (cache->len >= cache->flushthresh) {
+		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
+				cache->len - cache->size);
+		cache->len = cache->size;
+		__MEMPOOL_RT_STAT_INC(mp, cache_flush);
 	}
 
 	return;
 
 ring_enqueue:
+#else
+	RTE_SET_USED(cache);
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
-	/* push remaining objects in ring */
+	__MEMPOOL_RT_STAT_INC(mp, put_common);
+
+	/* push remaining objects in the backend */
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
 	if (is_mp) {
-		if (rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n) < 0)
+		if (rte_mempool_ops_enqueue_bulk(mp, obj_table, n) < 0)
 			rte_panic("cannot put objects in mempool\n");
-	}
-	else {
-		if (rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n) < 0)
+	} else {
+		if (rte_mempool_ops_sp_enqueue_bulk(mp, obj_table, n) < 0)
 			rte_panic("cannot put objects in mempool\n");
 	}
 #else
 	if (is_mp)
-		rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n);
+		rte_mempool_ops_enqueue_bulk(mp, obj_table, n);
 	else
-		rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n);
+		rte_mempool_ops_sp_enqueue_bulk(mp, obj_table, n);
 #endif
 }
 
+/**
+ * @internal Put several objects back in the mempool; used internally.
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to store back in the mempool, must be strictly
+ *   positive.
+ * @param is_mp
+ *   Mono-producer (0) or multi-producers (1). Mono-producer puts bypass
+ *   the per-lcore cache and use the single-producer path of the backend,
+ *   if it has one.
+ */
+static inline void __attribute__((always_inline))
+__mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
+		    unsigned n, int is_mp)
+{
+	__mempool_generic_put(mp, obj_table, n, is_mp ?
+		rte_mempool_default_cache(mp, rte_lcore_id()) : NULL, is_mp);
+}
+
+/**
+ * Put several objects back in the mempool, through a given cache.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the mempool from obj_table.
+ * @param cache
+ *   The cache to use, e.g. a cache created with rte_mempool_cache_create()
+ *   or returned by rte_mempool_default_cache(). If NULL, the objects are
+ *   put directly in the common pool.
+ */
+static inline void __attribute__((always_inline))
+rte_mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
+			unsigned n, struct rte_mempool_cache *cache)
+{
+	__mempool_check_cookies(mp, obj_table, n, 0);
+	__mempool_generic_put(mp, obj_table, n, cache, 1);
+}
 
 /**
  * Put several objects back in the mempool (multi-producers safe).
@@ -929,50 +1475,55 @@ rte_mempool_put(struct rte_mempool *mp, void *obj)
  *   A pointer to a table of void * pointers (objects).
  * @param n
  *   The number of objects to get, must be strictly positive.
+ * @param cache
+ *   The cache to get the objects from, or NULL to get them directly from
+ *   the common pool.
  * @param is_mc
- *   Mono-consumer (0) or multi-consumers (1).
+ *   Get from the common pool with the single-consumer (0) or the
+ *   multi-consumers (1) path of the backend.
  * @return
  *   - >=0: Success; number of objects supplied.
- *   - <0: Error; code of ring dequeue function.
+ *   - <0: Error; code of the backend dequeue function.
  */
 static inline int __attribute__((always_inline))
-__mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
-		   unsigned n, int is_mc)
+__mempool_generic_get(struct rte_mempool *mp, void **obj_table,
+		      unsigned n, struct rte_mempool_cache *cache, int is_mc)
 {
 	int ret;
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	struct rte_mempool_cache *cache;
 	uint32_t index, len;
 	void **cache_objs;
-	unsigned lcore_id = rte_lcore_id();
-	uint32_t cache_size = mp->cache_size;
 
-	/* cache is not enabled or single consumer */
-	if (unlikely(cache_size == 0 || is_mc == 0 ||
-		     n >= cache_size || lcore_id >= RTE_MAX_LCORE))
+	/* no cache (disabled, single consumer or non-EAL thread) */
+	if (unlikely(cache == NULL || n >= cache->size))
 		goto ring_dequeue;
 
-	cache = &mp->local_cache[lcore_id];
 	cache_objs = cache->objs;
 
 	/* Can this be satisfied from the cache? */
 	if (cache->len < n) {
 		/* No. Backfill the cache first, and then fill from it */
-		uint32_t req = n + (cache_size - cache->len);
+		uint32_t req = n + (cache->size - cache->len);
+
+		__MEMPOOL_RT_STAT_INC(mp, get_cache_miss);
 
 		/* How many do we require i.e. number to fill the cache + the request */
-		ret = rte_ring_mc_dequeue_bulk(mp->ring, &cache->objs[cache->len], req);
+		ret = rte_mempool_ops_dequeue_bulk(mp, &cache->objs[cache->len], req);
 		if (unlikely(ret < 0)) {
 			/*
 			 * In the offchance that we are buffer constrained,
 			 * where we are not able to allocate cache + n, go to
-			 * the ring directly. If that fails, we are truly out of
+			 * the backend directly. If that fails, we are truly out of
 			 * buffers.
 			 */
 			goto ring_dequeue;
 		}
 
 		cache->len += req;
+		__MEMPOOL_RT_STAT_INC(mp, cache_refill);
+		__mempool_rt_stat_low(mp);
+	} else {
+		__MEMPOOL_RT_STAT_INC(mp, get_cache_hit);
 	}
 
 	/* Now fill in the response ... */
@@ -986,19 +1537,81 @@ __mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
 	return 0;
 
 ring_dequeue:
+#else
+	RTE_SET_USED(cache);
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
-	/* get remaining objects from ring */
+	/* get remaining objects from the backend */
 	if (is_mc)
-		ret = rte_ring_mc_dequeue_bulk(mp->ring, obj_table, n);
+		ret = rte_mempool_ops_dequeue_bulk(mp, obj_table, n);
 	else
-		ret = rte_ring_sc_dequeue_bulk(mp->ring, obj_table, n);
+		ret = rte_mempool_ops_sc_dequeue_bulk(mp, obj_table, n);
 
-	if (ret < 0)
+	if (ret < 0) {
 		__MEMPOOL_STAT_ADD(mp, get_fail, n);
-	else
+		__MEMPOOL_RT_STAT_INC(mp, get_fail);
+	} else {
 		__MEMPOOL_STAT_ADD(mp, get_success, n);
+		__MEMPOOL_RT_STAT_INC(mp, get_common);
+		__mempool_rt_stat_low(mp);
+	}
+
+	return ret;
+}
 
+/**
+ * @internal Get several objects from the mempool; used internally.
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to get, must be strictly positive.
+ * @param is_mc
+ *   Mono-consumer (0) or multi-consumers (1). Mono-consumer gets bypass
+ *   the per-lcore cache and use the single-consumer path of the backend,
+ *   if it has one.
+ * @return
+ *   - >=0: Success; number of objects supplied.
+ *   - <0: Error; code of the backend dequeue function.
+ */
+static inline int __attribute__((always_inline))
+__mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
+		   unsigned n, int is_mc)
+{
+	return __mempool_generic_get(mp, obj_table, n, is_mc ?
+		rte_mempool_default_cache(mp, rte_lcore_id()) : NULL, is_mc);
+}
+
+/**
+ * Get several objects from the mempool, through a given cache.
+ *
+ * Objects are retrieved first from the cache, subsequently from the
+ * common pool. Note that it can return -ENOENT when the cache and the
+ * common pool are empty, even if other caches are full.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to get from the mempool to obj_table.
+ * @param cache
+ *   The cache to use, e.g. a cache created with rte_mempool_cache_create()
+ *   or returned by rte_mempool_default_cache(). If NULL, the objects are
+ *   taken directly from the common pool.
+ * @return
+ *   - 0: Success; objects taken.
+ *   - -ENOENT: Not enough entries in the mempool; no object is retrieved.
+ */
+static inline int __attribute__((always_inline))
+rte_mempool_generic_get(struct rte_mempool *mp, void **obj_table,
+			unsigned n, struct rte_mempool_cache *cache)
+{
+	int ret;
+	ret = __mempool_generic_get(mp, obj_table, n, cache, 1);
+	if (ret == 0)
+		__mempool_check_cookies(mp, obj_table, n, 1);
 	return ret;
 }
 
@@ -1162,12 +1775,88 @@ rte_mempool_get(struct rte_mempool *mp, void **obj_p)
 	return rte_mempool_get_bulk(mp, obj_p, 1);
 }
 
+/**
+ * @internal Check and update the cookies of the objects of contiguous
+ * blocks, see __mempool_check_cookies().
+ */
+#ifdef RTE_LIBRTE_MEMPOOL_DEBUG
+static inline void
+__mempool_contig_blocks_check_cookies(const struct rte_mempool *mp,
+	void * const *first_obj_table, unsigned n, int free)
+{
+	struct rte_mempool_info info;
+	size_t total_elt_sz;
+	unsigned i, j;
+	void *obj;
+
+	if (rte_mempool_ops_get_info(mp, &info) < 0)
+		rte_panic("MEMPOOL: contiguous blocks not supported\n");
+
+	total_elt_sz = mp->header_size + mp->elt_size + mp->trailer_size;
+	for (i = 0; i < n; i++) {
+		for (j = 0; j < info.contig_block_size; j++) {
+			obj = RTE_PTR_ADD(first_obj_table[i], j * total_elt_sz);
+			__mempool_check_cookies(mp, &obj, 1, free);
+		}
+	}
+}
+#else
+#define __mempool_contig_blocks_check_cookies(mp, first_obj_table, n, free) \
+	do {} while (0)
+#endif /* RTE_LIBRTE_MEMPOOL_DEBUG */
+
+/**
+ * Get several blocks of contiguous objects from the mempool.
+ *
+ * Each block is made of rte_mempool_info.contig_block_size objects
+ * that are adjacent in memory, the distance between two objects being
+ * header_size + elt_size + trailer_size; see rte_mempool_ops_get_info().
+ * Blocks start on a block boundary of the pool. The objects are
+ * released one by one with rte_mempool_put() or equivalent, and the
+ * backend rebuilds the blocks as their objects come back.
+ *
+ * The blocks are taken directly from the backend, bypassing the
+ * per-lcore caches. Only some backends support it, such as "bucket".
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param first_obj_table
+ *   A pointer to a table of void * pointers that will be filled with
+ *   the first object of each block.
+ * @param n
+ *   The number of blocks to get from the mempool.
+ * @return
+ *   - 0: Success; blocks taken.
+ *   - -ENOENT: Not enough blocks in the mempool; no block is retrieved.
+ *   - -ENOTSUP: The backend of the mempool does not support it.
+ */
+static inline int __attribute__((always_inline))
+rte_mempool_get_contig_blocks(struct rte_mempool *mp,
+			      void **first_obj_table, unsigned n)
+{
+	struct rte_mempool_ops *ops = rte_mempool_get_ops(mp->ops_index);
+	int ret;
+
+	if (ops->dequeue_contig_blocks == NULL)
+		return -ENOTSUP;
+
+	ret = ops->dequeue_contig_blocks(mp, first_obj_table, n);
+	if (ret < 0) {
+		__MEMPOOL_STAT_ADD(mp, get_fail, n);
+		return ret;
+	}
+
+	__MEMPOOL_STAT_ADD(mp, get_success, n);
+	__mempool_contig_blocks_check_cookies(mp, first_obj_table, n, 1);
+	return 0;
+}
+
 /**
  * Return the number of entries in the mempool.
  *
  * When cache is enabled, this function has to browse the length of
  * all lcores, so it should not be used in a data path, but only for
- * debug purposes.
+ * debug purposes. Objects held in user-owned caches are not counted.
  *
  * @param mp
  *   A pointer to the mempool structure.
@@ -1177,7 +1866,7 @@ rte_mempool_get(struct rte_mempool *mp, void **obj_p)
 unsigned rte_mempool_count(const struct rte_mempool *mp);
 
 /**
- * Return the number of free entries in the mempool ring.
+ * Return the number of free entries in the mempool.
  * i.e. how many entries can be freed back to the mempool.
  *
  * NOTE: This corresponds to the number of elements *allocated* from the
@@ -1250,7 +1939,8 @@ rte_mempool_empty(const struct rte_mempool *mp)
 static inline phys_addr_t
 rte_mempool_virt2phy(const struct rte_mempool *mp, const void *elt)
 {
-	if (rte_eal_has_hugepages()) {
+	/* anonymous memory has its table of page addresses too */
+	if (rte_eal_has_hugepages() || (mp->flags & MEMPOOL_F_ANON)) {
 		uintptr_t off;
 
 		off = (const char *)elt - (const char *)mp->elt_va_start;
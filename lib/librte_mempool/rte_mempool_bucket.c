@@ -0,0 +1,315 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_spinlock.h>
+#include <rte_malloc.h>
+#include <rte_mempool.h>
+
+/*
+ * Bucket backend: the objects of the pool are split in buckets of
+ * adjacent objects, about CONFIG_RTE_MEMPOOL_BUCKET_SIZE_KB large, so
+ * that whole buckets can be handed out by
+ * rte_mempool_get_contig_blocks().
+ *
+ * Each bucket keeps its own list of free objects. A bucket is either
+ * empty (in no list), partially free (in the partial list) or
+ * entirely free (in the full list). Single objects are taken from
+ * partial buckets first, so that full buckets are kept for contiguous
+ * requests, and a bucket moves back to the full list as soon as all its
+ * objects are released. The backend is protected by a spinlock; the
+ * per-lcore caches keep it out of the fast path.
+ *
+ * The object index is computed from its address, which requires the
+ * objects to be laid out without holes: this is checked at allocation.
+ */
+
+#define BUCKET_END UINT32_MAX /**< Index marking the end of a list. */
+
+struct mempool_bucket_hdr {
+	uint32_t nb_free;   /**< Number of free objects in the bucket. */
+	uint32_t free_head; /**< Index of the first free object. */
+	uint32_t prev;      /**< Previous bucket in the list. */
+	uint32_t next;      /**< Next bucket in the list. */
+};
+
+struct mempool_bucket {
+	rte_spinlock_t lock;
+	uintptr_t va_start;       /**< Address of the first object. */
+	size_t total_elt_sz;      /**< Distance between two objects. */
+	uint32_t obj_per_bucket;  /**< Objects in a (non-last) bucket. */
+	uint32_t nb_buckets;      /**< Number of buckets. */
+	uint32_t count;           /**< Number of free objects. */
+	uint32_t nb_full;         /**< Number of buckets in the full list. */
+	uint32_t full;            /**< First entirely free bucket. */
+	uint32_t partial;         /**< First partially free bucket. */
+	uint32_t *obj_next;       /**< Next free object, per object. */
+	struct mempool_bucket_hdr buckets[0] __rte_cache_aligned;
+};
+
+static inline void
+bucket_list_add(struct mempool_bucket *bd, uint32_t *head, uint32_t b)
+{
+	struct mempool_bucket_hdr *h = &bd->buckets[b];
+
+	h->prev = BUCKET_END;
+	h->next = *head;
+	if (*head != BUCKET_END)
+		bd->buckets[*head].prev = b;
+	*head = b;
+}
+
+static inline void
+bucket_list_del(struct mempool_bucket *bd, uint32_t *head, uint32_t b)
+{
+	struct mempool_bucket_hdr *h = &bd->buckets[b];
+
+	if (h->prev != BUCKET_END)
+		bd->buckets[h->prev].next = h->next;
+	else
+		*head = h->next;
+	if (h->next != BUCKET_END)
+		bd->buckets[h->next].prev = h->prev;
+}
+
+/* release one object in its bucket, with the lock held */
+static inline void
+bucket_put_obj(struct mempool_bucket *bd, void *obj)
+{
+	struct mempool_bucket_hdr *h;
+	uint32_t idx, b;
+
+	idx = ((uintptr_t)obj - bd->va_start) / bd->total_elt_sz;
+	b = idx / bd->obj_per_bucket;
+	h = &bd->buckets[b];
+
+	bd->obj_next[idx] = h->free_head;
+	h->free_head = idx;
+	h->nb_free++;
+
+	if (h->nb_free == bd->obj_per_bucket) {
+		if (h->nb_free > 1)
+			bucket_list_del(bd, &bd->partial, b);
+		bucket_list_add(bd, &bd->full, b);
+		bd->nb_full++;
+	} else if (h->nb_free == 1) {
+		bucket_list_add(bd, &bd->partial, b);
+	}
+	bd->count++;
+}
+
+/* take one object, preferably from a partial bucket, with the lock held */
+static inline void *
+bucket_get_obj(struct mempool_bucket *bd)
+{
+	struct mempool_bucket_hdr *h;
+	uint32_t idx, b;
+
+	b = bd->partial;
+	if (b == BUCKET_END) {
+		b = bd->full;
+		bucket_list_del(bd, &bd->full, b);
+		bd->nb_full--;
+		if (bd->obj_per_bucket > 1)
+			bucket_list_add(bd, &bd->partial, b);
+	}
+	h = &bd->buckets[b];
+
+	idx = h->free_head;
+	h->free_head = bd->obj_next[idx];
+	h->nb_free--;
+	if (h->nb_free == 0 && b == bd->partial)
+		bucket_list_del(bd, &bd->partial, b);
+	bd->count--;
+
+	return (void *)(bd->va_start + idx * bd->total_elt_sz);
+}
+
+static int
+bucket_enqueue(struct rte_mempool *mp, void * const *obj_table, unsigned n)
+{
+	struct mempool_bucket *bd = mp->pool_data;
+	unsigned i;
+
+	rte_spinlock_lock(&bd->lock);
+	for (i = 0; i < n; i++)
+		bucket_put_obj(bd, obj_table[i]);
+	rte_spinlock_unlock(&bd->lock);
+
+	return 0;
+}
+
+static int
+bucket_dequeue(struct rte_mempool *mp, void **obj_table, unsigned n)
+{
+	struct mempool_bucket *bd = mp->pool_data;
+	unsigned i;
+
+	rte_spinlock_lock(&bd->lock);
+	if (unlikely(bd->count < n)) {
+		rte_spinlock_unlock(&bd->lock);
+		return -ENOENT;
+	}
+	for (i = 0; i < n; i++)
+		obj_table[i] = bucket_get_obj(bd);
+	rte_spinlock_unlock(&bd->lock);
+
+	return 0;
+}
+
+static int
+bucket_dequeue_contig_blocks(struct rte_mempool *mp, void **first_obj_table,
+	unsigned n)
+{
+	struct mempool_bucket *bd = mp->pool_data;
+	struct mempool_bucket_hdr *h;
+	uint32_t b;
+	unsigned i;
+
+	rte_spinlock_lock(&bd->lock);
+	if (unlikely(bd->nb_full < n)) {
+		rte_spinlock_unlock(&bd->lock);
+		return -ENOENT;
+	}
+	for (i = 0; i < n; i++) {
+		b = bd->full;
+		bucket_list_del(bd, &bd->full, b);
+		h = &bd->buckets[b];
+		h->nb_free = 0;
+		h->free_head = BUCKET_END;
+		first_obj_table[i] = (void *)(bd->va_start +
+			(size_t)b * bd->obj_per_bucket * bd->total_elt_sz);
+	}
+	bd->nb_full -= n;
+	bd->count -= n * bd->obj_per_bucket;
+	rte_spinlock_unlock(&bd->lock);
+
+	return 0;
+}
+
+static unsigned
+bucket_get_count(const struct rte_mempool *mp)
+{
+	const struct mempool_bucket *bd = mp->pool_data;
+
+	return bd->count;
+}
+
+static int
+bucket_get_info(const struct rte_mempool *mp, struct rte_mempool_info *info)
+{
+	const struct mempool_bucket *bd = mp->pool_data;
+
+	info->contig_block_size = bd->obj_per_bucket;
+	return 0;
+}
+
+struct bucket_layout_arg {
+	uintptr_t next; /**< Expected address of the next object. */
+	int holes;      /**< Set if an object is not where expected. */
+};
+
+static void
+bucket_check_layout(void *arg, void *start, void *end, uint32_t idx)
+{
+	struct bucket_layout_arg *la = arg;
+
+	RTE_SET_USED(idx);
+	if ((uintptr_t)start != la->next)
+		la->holes = 1;
+	la->next = (uintptr_t)end;
+}
+
+static int
+bucket_alloc(struct rte_mempool *mp)
+{
+	struct bucket_layout_arg la;
+	struct mempool_bucket *bd;
+	uint32_t obj_per_bucket, nb_buckets, i;
+	size_t total_elt_sz, sz;
+
+	total_elt_sz = mp->header_size + mp->elt_size + mp->trailer_size;
+
+	/* objects must be adjacent, as populated by mempool_populate() */
+	la.next = mp->elt_va_start;
+	la.holes = 0;
+	if (rte_mempool_obj_iter((void *)mp->elt_va_start, mp->size,
+			total_elt_sz, 1, mp->elt_pa, mp->pg_num, mp->pg_shift,
+			bucket_check_layout, &la) != mp->size || la.holes) {
+		RTE_LOG(ERR, MEMPOOL,
+			"Bucket mempool needs virtually contiguous objects\n");
+		return -EINVAL;
+	}
+
+	obj_per_bucket = (RTE_MEMPOOL_BUCKET_SIZE_KB * 1024) / total_elt_sz;
+	if (obj_per_bucket == 0)
+		obj_per_bucket = 1;
+	if (mp->size != 0 && obj_per_bucket > mp->size)
+		obj_per_bucket = mp->size;
+	nb_buckets = (mp->size + obj_per_bucket - 1) / obj_per_bucket;
+
+	sz = sizeof(*bd) + nb_buckets * sizeof(bd->buckets[0]);
+	bd = rte_zmalloc_socket(mp->name, sz + mp->size * sizeof(uint32_t),
+		RTE_CACHE_LINE_SIZE, mp->socket_id);
+	if (bd == NULL)
+		return -ENOMEM;
+
+	rte_spinlock_init(&bd->lock);
+	bd->va_start = mp->elt_va_start + mp->header_size;
+	bd->total_elt_sz = total_elt_sz;
+	bd->obj_per_bucket = obj_per_bucket;
+	bd->nb_buckets = nb_buckets;
+	bd->full = BUCKET_END;
+	bd->partial = BUCKET_END;
+	bd->obj_next = RTE_PTR_ADD(bd, sz);
+	for (i = 0; i < nb_buckets; i++)
+		bd->buckets[i].free_head = BUCKET_END;
+
+	mp->pool_data = bd;
+	return 0;
+}
+
+static const struct rte_mempool_ops ops_bucket = {
+	.name = "bucket",
+	.alloc = bucket_alloc,
+	.enqueue = bucket_enqueue,
+	.dequeue = bucket_dequeue,
+	.get_count = bucket_get_count,
+	.get_info = bucket_get_info,
+	.dequeue_contig_blocks = bucket_dequeue_contig_blocks,
+};
+
+MEMPOOL_REGISTER_OPS(ops_bucket)
@@ -0,0 +1,139 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_log.h>
+#include <rte_spinlock.h>
+#include <rte_mempool.h>
+
+/* registered mempool backends */
+struct rte_mempool_ops_table rte_mempool_ops_table = {
+	.sl = RTE_SPINLOCK_INITIALIZER,
+	.num_ops = 0,
+};
+
+static int
+mempool_ops_lookup(const char *name)
+{
+	uint32_t i;
+
+	for (i = 0; i < rte_mempool_ops_table.num_ops; i++) {
+		if (strcmp(name, rte_mempool_ops_table.ops[i].name) == 0)
+			return i;
+	}
+	return -ENOENT;
+}
+
+/* add a new backend in rte_mempool_ops_table, return its index */
+int
+rte_mempool_register_ops(const struct rte_mempool_ops *h)
+{
+	struct rte_mempool_ops *ops;
+	int ops_index;
+
+	if (h->alloc == NULL || h->enqueue == NULL ||
+	    h->dequeue == NULL || h->get_count == NULL) {
+		RTE_LOG(ERR, MEMPOOL,
+			"Missing callback while registering mempool ops\n");
+		return -EINVAL;
+	}
+
+	if (h->name[0] == '\0' ||
+	    strnlen(h->name, sizeof(ops->name)) == sizeof(ops->name)) {
+		RTE_LOG(ERR, MEMPOOL,
+			"Invalid name while registering mempool ops\n");
+		return -EINVAL;
+	}
+
+	rte_spinlock_lock(&rte_mempool_ops_table.sl);
+
+	if (mempool_ops_lookup(h->name) >= 0) {
+		rte_spinlock_unlock(&rte_mempool_ops_table.sl);
+		RTE_LOG(ERR, MEMPOOL, "Mempool ops <%s> already registered\n",
+			h->name);
+		return -EEXIST;
+	}
+
+	if (rte_mempool_ops_table.num_ops >= RTE_MEMPOOL_MAX_OPS_IDX) {
+		rte_spinlock_unlock(&rte_mempool_ops_table.sl);
+		RTE_LOG(ERR, MEMPOOL,
+			"Maximum number of mempool ops structs exceeded\n");
+		return -ENOSPC;
+	}
+
+	ops_index = rte_mempool_ops_table.num_ops++;
+	ops = &rte_mempool_ops_table.ops[ops_index];
+	snprintf(ops->name, sizeof(ops->name), "%s", h->name);
+	ops->alloc = h->alloc;
+	ops->enqueue = h->enqueue;
+	ops->dequeue = h->dequeue;
+	ops->get_count = h->get_count;
+	ops->get_info = h->get_info;
+	ops->dequeue_contig_blocks = h->dequeue_contig_blocks;
+	ops->sp_enqueue = h->sp_enqueue;
+	ops->sc_dequeue = h->sc_dequeue;
+
+	rte_spinlock_unlock(&rte_mempool_ops_table.sl);
+
+	return ops_index;
+}
+
+/* return the index of a registered backend */
+int
+rte_mempool_ops_lookup(const char *name)
+{
+	int ops_index;
+
+	rte_spinlock_lock(&rte_mempool_ops_table.sl);
+	ops_index = mempool_ops_lookup(name);
+	rte_spinlock_unlock(&rte_mempool_ops_table.sl);
+
+	return ops_index;
+}
+
+/* get additional information about the backend of a mempool */
+int
+rte_mempool_ops_get_info(const struct rte_mempool *mp,
+	struct rte_mempool_info *info)
+{
+	struct rte_mempool_ops *ops = rte_mempool_get_ops(mp->ops_index);
+
+	memset(info, 0, sizeof(*info));
+	if (ops->get_info == NULL)
+		return -ENOTSUP;
+
+	return ops->get_info(mp, info);
+}
@@ -0,0 +1,119 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_malloc.h>
+#include <rte_mempool.h>
+
+/*
+ * Single-thread backend: the free objects are stored in an array used
+ * as a LIFO, without any atomic operation or barrier. The mempool must
+ * not be accessed by more than one thread at a time.
+ */
+
+struct mempool_single {
+	uint32_t len;  /**< Number of objects in the array. */
+	uint32_t size; /**< Capacity of the array. */
+	void *objs[0] __rte_cache_aligned; /**< Free objects. */
+};
+
+static int
+single_enqueue(struct rte_mempool *mp, void * const *obj_table, unsigned n)
+{
+	struct mempool_single *s = mp->pool_data;
+
+	if (unlikely(n > s->size - s->len))
+		return -ENOBUFS;
+
+	memcpy(&s->objs[s->len], obj_table, n * sizeof(void *));
+	s->len += n;
+
+	return 0;
+}
+
+static int
+single_dequeue(struct rte_mempool *mp, void **obj_table, unsigned n)
+{
+	struct mempool_single *s = mp->pool_data;
+	void **objs;
+	unsigned i;
+
+	if (unlikely(n > s->len))
+		return -ENOENT;
+
+	/* most recently put objects first */
+	objs = &s->objs[s->len - 1];
+	for (i = 0; i < n; i++)
+		obj_table[i] = *objs--;
+	s->len -= n;
+
+	return 0;
+}
+
+static unsigned
+single_get_count(const struct rte_mempool *mp)
+{
+	const struct mempool_single *s = mp->pool_data;
+
+	return s->len;
+}
+
+static int
+single_alloc(struct rte_mempool *mp)
+{
+	struct mempool_single *s;
+
+	s = rte_zmalloc_socket(mp->name, sizeof(*s) +
+		mp->size * sizeof(s->objs[0]), RTE_CACHE_LINE_SIZE,
+		mp->socket_id);
+	if (s == NULL)
+		return -ENOMEM;
+
+	s->size = mp->size;
+	mp->pool_data = s;
+	return 0;
+}
+
+static const struct rte_mempool_ops ops_single = {
+	.name = "single",
+	.alloc = single_alloc,
+	.enqueue = single_enqueue,
+	.dequeue = single_dequeue,
+	.get_count = single_get_count,
+};
+
+MEMPOOL_REGISTER_OPS(ops_single)
@@ -0,0 +1,232 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_atomic.h>
+#include <rte_malloc.h>
+#include <rte_mempool.h>
+
+/*
+ * Lock-free stack backend.
+ *
+ * The stack is made of one node per object of the pool. Nodes are
+ * linked by index in two lists: the "used" list holds the free objects
+ * of the pool, the "free" list holds the nodes that do not carry an
+ * object. Putting objects moves nodes from the free list to the used
+ * list, getting objects moves them back.
+ *
+ * The head of each list is a 64-bit word made of the index of the top
+ * node and of a tag incremented at each update, so that it can be
+ * changed with a single compare-and-set without ABA issues. A length is
+ * maintained next to each head: a thread first reserves the nodes it
+ * will pop by decrementing it, so that the pop itself can not fail, and
+ * increments it only after a push is complete.
+ */
+
+#define STACK_END UINT32_MAX /**< Index marking the end of a list. */
+
+struct mempool_stack_node {
+	uint32_t next; /**< Index of the next node in the list. */
+	void *obj;     /**< Object carried by the node (used list only). */
+};
+
+union mempool_stack_head {
+	uint64_t raw;
+	struct {
+		uint32_t idx; /**< Index of the top node. */
+		uint32_t tag; /**< Update counter, against ABA. */
+	};
+};
+
+struct mempool_stack_list {
+	volatile uint64_t head; /**< Top of the list and its tag. */
+	rte_atomic32_t len;     /**< Number of nodes that can be reserved. */
+} __rte_cache_aligned;
+
+struct mempool_stack {
+	struct mempool_stack_list used; /**< Nodes holding free objects. */
+	struct mempool_stack_list free; /**< Nodes without object. */
+	struct mempool_stack_node nodes[0] __rte_cache_aligned;
+};
+
+/* reserve n nodes of a list, return -1 if it has less than n nodes */
+static inline int
+stack_list_reserve(struct mempool_stack_list *l, unsigned n)
+{
+	int32_t len;
+
+	do {
+		len = rte_atomic32_read(&l->len);
+		if (unlikely(len < (int32_t)n))
+			return -1;
+	} while (rte_atomic32_cmpset((volatile uint32_t *)&l->len.cnt,
+			len, len - n) == 0);
+
+	return 0;
+}
+
+/* pop n reserved nodes from a list, return the first and the last one */
+static inline uint32_t
+stack_list_pop(struct mempool_stack *s, struct mempool_stack_list *l,
+	unsigned n, uint32_t *last)
+{
+	union mempool_stack_head old, new;
+	uint32_t idx;
+	unsigned i;
+
+	for (;;) {
+		old.raw = l->head;
+		idx = old.idx;
+		for (i = 1; i < n && idx != STACK_END; i++)
+			idx = s->nodes[idx].next;
+
+		/* the list changed while we were walking it, retry */
+		if (unlikely(idx == STACK_END)) {
+			rte_pause();
+			continue;
+		}
+
+		new.idx = s->nodes[idx].next;
+		new.tag = old.tag + 1;
+		if (rte_atomic64_cmpset(&l->head, old.raw, new.raw) != 0)
+			break;
+	}
+
+	*last = idx;
+	return old.idx;
+}
+
+/* push a chain of n nodes from first to last on a list */
+static inline void
+stack_list_push(struct mempool_stack *s, struct mempool_stack_list *l,
+	uint32_t first, uint32_t last, unsigned n)
+{
+	union mempool_stack_head old, new;
+
+	do {
+		old.raw = l->head;
+		s->nodes[last].next = old.idx;
+		new.idx = first;
+		new.tag = old.tag + 1;
+	} while (rte_atomic64_cmpset(&l->head, old.raw, new.raw) == 0);
+
+	rte_atomic32_add(&l->len, n);
+}
+
+static int
+stack_enqueue(struct rte_mempool *mp, void * const *obj_table, unsigned n)
+{
+	struct mempool_stack *s = mp->pool_data;
+	uint32_t first, last, idx;
+	unsigned i;
+
+	if (unlikely(stack_list_reserve(&s->free, n) < 0))
+		return -ENOBUFS;
+
+	first = stack_list_pop(s, &s->free, n, &last);
+	for (i = 0, idx = first; i < n; i++, idx = s->nodes[idx].next)
+		s->nodes[idx].obj = obj_table[i];
+	stack_list_push(s, &s->used, first, last, n);
+
+	return 0;
+}
+
+static int
+stack_dequeue(struct rte_mempool *mp, void **obj_table, unsigned n)
+{
+	struct mempool_stack *s = mp->pool_data;
+	uint32_t first, last, idx;
+	unsigned i;
+
+	if (unlikely(stack_list_reserve(&s->used, n) < 0))
+		return -ENOENT;
+
+	first = stack_list_pop(s, &s->used, n, &last);
+	for (i = 0, idx = first; i < n; i++, idx = s->nodes[idx].next)
+		obj_table[i] = s->nodes[idx].obj;
+	stack_list_push(s, &s->free, first, last, n);
+
+	return 0;
+}
+
+static unsigned
+stack_get_count(const struct rte_mempool *mp)
+{
+	const struct mempool_stack *s = mp->pool_data;
+
+	return (unsigned)s->used.len.cnt;
+}
+
+static int
+stack_alloc(struct rte_mempool *mp)
+{
+	union mempool_stack_head head;
+	struct mempool_stack *s;
+	uint32_t i;
+
+	s = rte_zmalloc_socket(mp->name, sizeof(*s) +
+		mp->size * sizeof(s->nodes[0]), RTE_CACHE_LINE_SIZE,
+		mp->socket_id);
+	if (s == NULL)
+		return -ENOMEM;
+
+	/* all nodes start in the free list */
+	for (i = 0; i < mp->size; i++)
+		s->nodes[i].next = (i + 1 < mp->size) ? i + 1 : STACK_END;
+
+	head.idx = 0;
+	head.tag = 0;
+	s->free.head = head.raw;
+	rte_atomic32_set(&s->free.len, mp->size);
+
+	head.idx = STACK_END;
+	s->used.head = head.raw;
+	rte_atomic32_set(&s->used.len, 0);
+
+	mp->pool_data = s;
+	return 0;
+}
+
+static const struct rte_mempool_ops ops_stack = {
+	.name = "stack",
+	.alloc = stack_alloc,
+	.enqueue = stack_enqueue,
+	.dequeue = stack_dequeue,
+	.get_count = stack_get_count,
+};
+
+MEMPOOL_REGISTER_OPS(ops_stack)
@@ -0,0 +1,732 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_memcpy.h>
+
+#include "rte_port_pcap.h"
+
+#define PCAP_MAGIC_USEC                     0xa1b2c3d4
+#define PCAP_MAGIC_NSEC                     0xa1b23c4d
+#define PCAP_VERSION_MAJOR                  2
+#define PCAP_VERSION_MINOR                  4
+#define PCAP_LINKTYPE_ETHERNET              1
+#define PCAP_SNAPLEN_MAX                    UINT16_MAX
+
+/* File header of the libpcap format */
+struct pcap_file_hdr {
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+};
+
+/* Record header of the libpcap format */
+struct pcap_rec_hdr {
+	uint32_t ts_sec;
+	uint32_t ts_frac;   /* microseconds or nanoseconds */
+	uint32_t caplen;    /* bytes saved in the file */
+	uint32_t len;       /* bytes on the wire */
+};
+
+/* convert a number of TSC cycles to nanoseconds, and back */
+static inline uint64_t
+pcap_tsc_to_ns(uint64_t tsc, uint64_t hz)
+{
+	return tsc / hz * NS_PER_S + tsc % hz * NS_PER_S / hz;
+}
+
+static inline uint64_t
+pcap_ns_to_tsc(uint64_t ns, uint64_t hz)
+{
+	return ns / NS_PER_S * hz + ns % NS_PER_S * hz / NS_PER_S;
+}
+
+/*
+ * Port PCAP READER
+ *
+ */
+#ifdef RTE_PORT_STATS_COLLECT
+
+#define RTE_PORT_PCAP_READER_STATS_PKTS_IN_ADD(port, val) \
+	port->stats.n_pkts_in += val
+#define RTE_PORT_PCAP_READER_STATS_PKTS_DROP_ADD(port, val) \
+	port->stats.n_pkts_drop += val
+
+#else
+
+#define RTE_PORT_PCAP_READER_STATS_PKTS_IN_ADD(port, val)
+#define RTE_PORT_PCAP_READER_STATS_PKTS_DROP_ADD(port, val)
+
+#endif
+
+/*
+ * Mapping of the capture file. In zero copy mode, the packets delivered
+ * by the reader point into it and hold a reference on its shared info,
+ * so it is unmapped by whoever drops the last reference: the reader when
+ * it is freed or the last packet.
+ */
+struct pcap_mapping {
+	struct rte_mbuf_ext_shared_info shinfo;
+	void *addr;
+	size_t size;
+};
+
+struct rte_port_pcap_reader {
+	struct rte_port_in_stats stats;
+
+	struct rte_mempool *mempool;
+	struct pcap_mapping *map;
+	const uint8_t *data;
+	size_t pos;         /* offset of the next record */
+	size_t end;         /* end of the last complete record */
+	uint32_t flags;
+	uint32_t n_loops;
+	uint32_t loop;
+	int swapped;
+	uint32_t frac_ns;   /* nanoseconds per unit of ts_frac */
+
+	/* Pacing */
+	uint64_t ts_first;  /* timestamp of the first record, ns */
+	uint64_t ts_last;   /* timestamp of the last record, ns */
+	uint64_t ts_offset; /* duration of the previous loops, ns */
+	uint64_t tsc_start;
+	uint64_t tsc_hz;
+};
+
+static inline uint32_t
+pcap_reader_u32(const struct rte_port_pcap_reader *p, uint32_t v)
+{
+	return p->swapped ? rte_bswap32(v) : v;
+}
+
+static inline uint64_t
+pcap_reader_rec_ns(const struct rte_port_pcap_reader *p,
+	const struct pcap_rec_hdr *r)
+{
+	return (uint64_t)pcap_reader_u32(p, r->ts_sec) * NS_PER_S +
+		(uint64_t)pcap_reader_u32(p, r->ts_frac) * p->frac_ns;
+}
+
+static void
+pcap_mapping_free(__rte_unused void *addr, void *opaque)
+{
+	struct pcap_mapping *map = opaque;
+
+	munmap(map->addr, map->size);
+	rte_free(map);
+}
+
+static struct pcap_mapping *
+pcap_mapping_create(const char *file_name, int socket_id)
+{
+	struct pcap_mapping *map;
+	struct stat st;
+	void *addr;
+	int fd;
+
+	fd = open(file_name, O_RDONLY);
+	if (fd < 0) {
+		RTE_LOG(ERR, PORT, "%s: Cannot open %s\n", __func__, file_name);
+		return NULL;
+	}
+	if (fstat(fd, &st) != 0 ||
+	    (size_t)st.st_size < sizeof(struct pcap_file_hdr)) {
+		RTE_LOG(ERR, PORT, "%s: %s is not a pcap file\n", __func__,
+			file_name);
+		close(fd);
+		return NULL;
+	}
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		RTE_LOG(ERR, PORT, "%s: Cannot map %s\n", __func__, file_name);
+		return NULL;
+	}
+	madvise(addr, st.st_size, MADV_WILLNEED);
+
+	map = rte_zmalloc_socket("PORT", sizeof(*map), RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (map == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Cannot allocate mapping\n", __func__);
+		munmap(addr, st.st_size);
+		return NULL;
+	}
+	map->addr = addr;
+	map->size = st.st_size;
+	map->shinfo.free_cb = pcap_mapping_free;
+	map->shinfo.fcb_opaque = map;
+	rte_mbuf_ext_refcnt_set(&map->shinfo, 1);
+
+	return map;
+}
+
+/* check the file header and find the end of the last complete record */
+static int
+pcap_reader_parse(struct rte_port_pcap_reader *p, const char *file_name)
+{
+	const struct pcap_file_hdr *fh = (const struct pcap_file_hdr *)p->data;
+	const struct pcap_rec_hdr *r;
+	size_t size = p->map->size;
+	size_t pos = sizeof(*fh);
+	uint32_t caplen;
+
+	switch (fh->magic) {
+	case PCAP_MAGIC_USEC:
+		p->frac_ns = 1000;
+		break;
+	case PCAP_MAGIC_NSEC:
+		p->frac_ns = 1;
+		break;
+	default:
+		p->swapped = 1;
+		if (fh->magic == rte_bswap32(PCAP_MAGIC_USEC))
+			p->frac_ns = 1000;
+		else if (fh->magic == rte_bswap32(PCAP_MAGIC_NSEC))
+			p->frac_ns = 1;
+		else {
+			RTE_LOG(ERR, PORT, "%s: %s is not a pcap file\n",
+				__func__, file_name);
+			return -1;
+		}
+	}
+
+	while (size - pos >= sizeof(*r)) {
+		r = (const struct pcap_rec_hdr *)(p->data + pos);
+		caplen = pcap_reader_u32(p, r->caplen);
+		if (caplen > PCAP_SNAPLEN_MAX ||
+		    caplen > size - pos - sizeof(*r))
+			break;
+
+		if (pos == sizeof(*fh))
+			p->ts_first = pcap_reader_rec_ns(p, r);
+		p->ts_last = pcap_reader_rec_ns(p, r);
+		pos += sizeof(*r) + caplen;
+	}
+	if (pos != size)
+		RTE_LOG(WARNING, PORT, "%s: %s is truncated after %zu bytes\n",
+			__func__, file_name, pos);
+
+	p->pos = sizeof(*fh);
+	p->end = pos;
+	return 0;
+}
+
+static void *
+rte_port_pcap_reader_create(void *params, int socket_id)
+{
+	struct rte_port_pcap_reader_params *conf =
+			(struct rte_port_pcap_reader_params *) params;
+	struct rte_port_pcap_reader *port;
+
+	/* Check input parameters */
+	if ((conf == NULL) ||
+	    (conf->mempool == NULL) ||
+	    (conf->file_name == NULL) ||
+	    (rte_pktmbuf_data_room_size(conf->mempool) <=
+		RTE_PKTMBUF_HEADROOM)) {
+		RTE_LOG(ERR, PORT, "%s: Invalid params\n", __func__);
+		return NULL;
+	}
+
+	/* Memory allocation */
+	port = rte_zmalloc_socket("PORT", sizeof(*port),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Failed to allocate port\n", __func__);
+		return NULL;
+	}
+
+	port->map = pcap_mapping_create(conf->file_name, socket_id);
+	if (port->map == NULL) {
+		rte_free(port);
+		return NULL;
+	}
+
+	/* Initialization */
+	port->mempool = conf->mempool;
+	port->data = port->map->addr;
+	port->flags = conf->flags;
+	port->n_loops = conf->n_loops;
+	port->tsc_hz = rte_get_tsc_hz();
+	if (pcap_reader_parse(port, conf->file_name) != 0) {
+		pcap_mapping_free(NULL, port->map);
+		rte_free(port);
+		return NULL;
+	}
+
+	return port;
+}
+
+/* no record, or replaying the last loop */
+static inline int
+pcap_reader_last_loop(const struct rte_port_pcap_reader *p)
+{
+	return p->end == sizeof(struct pcap_file_hdr) ||
+		(p->n_loops != 0 && p->loop + 1 >= p->n_loops);
+}
+
+/* rewind to the first record, returns non-zero when the replay is over */
+static int
+pcap_reader_next_loop(struct rte_port_pcap_reader *p)
+{
+	if (pcap_reader_last_loop(p))
+		return -1;
+
+	p->loop++;
+	p->pos = sizeof(struct pcap_file_hdr);
+	p->ts_offset += p->ts_last - p->ts_first;
+	return 0;
+}
+
+/* TSC value at which a record is due */
+static inline uint64_t
+pcap_reader_deadline(const struct rte_port_pcap_reader *p,
+	const struct pcap_rec_hdr *r)
+{
+	uint64_t ts = pcap_reader_rec_ns(p, r);
+
+	ts = (ts > p->ts_first) ? ts - p->ts_first : 0;
+	return p->tsc_start + pcap_ns_to_tsc(p->ts_offset + ts, p->tsc_hz);
+}
+
+/* copy record data into a packet, chaining segments as needed */
+static int
+pcap_reader_copy(struct rte_mbuf *m, struct rte_mempool *mp,
+	const uint8_t *data, uint32_t len)
+{
+	struct rte_mbuf *seg = m;
+	uint32_t seg_len;
+
+	for (;;) {
+		seg_len = RTE_MIN(len, (uint32_t)rte_pktmbuf_tailroom(seg));
+		rte_memcpy(rte_pktmbuf_mtod(seg, uint8_t *), data, seg_len);
+		seg->data_len = (uint16_t)seg_len;
+		m->pkt_len += seg_len;
+		data += seg_len;
+		len -= seg_len;
+		if (len == 0)
+			return 0;
+
+		seg->next = rte_pktmbuf_alloc(mp);
+		if (seg->next == NULL)
+			return -1;
+		seg = seg->next;
+		m->nb_segs++;
+	}
+}
+
+static int
+rte_port_pcap_reader_rx(void *port, struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	struct rte_port_pcap_reader *p = (struct rte_port_pcap_reader *) port;
+	const struct pcap_rec_hdr *rec[RTE_PORT_IN_BURST_SIZE_MAX];
+	const struct pcap_rec_hdr *r;
+	uint64_t now = 0, ts_offset = p->ts_offset;
+	size_t pos = p->pos;
+	uint32_t loop = p->loop;
+	uint32_t n, i, len;
+
+	if (n_pkts > RTE_PORT_IN_BURST_SIZE_MAX)
+		n_pkts = RTE_PORT_IN_BURST_SIZE_MAX;
+
+	if (p->flags & RTE_PORT_PCAP_READER_F_PACED) {
+		now = rte_rdtsc();
+		if (p->tsc_start == 0)
+			p->tsc_start = now;
+	}
+
+	/* Pick the records of the burst, which stops at the end of a loop */
+	for (n = 0; n < n_pkts; n++) {
+		if (p->pos == p->end &&
+		    (n != 0 || pcap_reader_next_loop(p) != 0))
+			break;
+
+		r = (const struct pcap_rec_hdr *)(p->data + p->pos);
+		if ((p->flags & RTE_PORT_PCAP_READER_F_PACED) &&
+		    pcap_reader_deadline(p, r) > now)
+			break;
+
+		rec[n] = r;
+		p->pos += sizeof(*r) + pcap_reader_u32(p, r->caplen);
+	}
+	if (n == 0)
+		return 0;
+
+	/* Without mbufs, go back to the first record of the burst, so that
+	 * it is read again by the next call instead of being lost */
+	if (rte_pktmbuf_alloc_bulk(p->mempool, pkts, n) != 0) {
+		p->pos = pos;
+		p->loop = loop;
+		p->ts_offset = ts_offset;
+		return 0;
+	}
+
+	/* Zero copy, unless the reference count of the mapping is close to
+	 * its limit, in which case the burst is copied */
+	if ((p->flags & RTE_PORT_PCAP_READER_F_ZERO_COPY) &&
+	    rte_mbuf_ext_refcnt_read(&p->map->shinfo) <
+		INT16_MAX - RTE_PORT_IN_BURST_SIZE_MAX) {
+		rte_mbuf_ext_refcnt_update(&p->map->shinfo, (int16_t)n);
+		for (i = 0; i < n; i++) {
+			struct rte_mbuf *m = pkts[i];
+			void *buf = (void *)(uintptr_t)(rec[i] + 1);
+
+			len = pcap_reader_u32(p, rec[i]->caplen);
+			rte_pktmbuf_attach_extbuf(m, buf, RTE_BAD_PHYS_ADDR,
+				(uint16_t)len, &p->map->shinfo);
+			m->data_len = (uint16_t)len;
+			m->pkt_len = len;
+		}
+		RTE_PORT_PCAP_READER_STATS_PKTS_IN_ADD(p, n);
+		return n;
+	}
+
+	for (i = 0; i < n; i++) {
+		len = pcap_reader_u32(p, rec[i]->caplen);
+		if (pcap_reader_copy(pkts[i], p->mempool,
+			(const uint8_t *)(rec[i] + 1), len) != 0)
+			break;
+	}
+
+	/* Out of mbufs for the segments: the burst ends before the record
+	 * that could not be copied, which is read again by the next call */
+	if (i < n) {
+		rte_pktmbuf_free_bulk(&pkts[i], n - i);
+		if (i == 0) {
+			p->pos = pos;
+			p->loop = loop;
+			p->ts_offset = ts_offset;
+		} else {
+			p->pos = (const uint8_t *)rec[i] - p->data;
+		}
+	}
+
+	RTE_PORT_PCAP_READER_STATS_PKTS_IN_ADD(p, i);
+	return i;
+}
+
+int
+rte_port_pcap_reader_eof(void *port)
+{
+	struct rte_port_pcap_reader *p = (struct rte_port_pcap_reader *) port;
+
+	return p->pos == p->end && pcap_reader_last_loop(p);
+}
+
+static int
+rte_port_pcap_reader_free(void *port)
+{
+	struct rte_port_pcap_reader *p = (struct rte_port_pcap_reader *) port;
+
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: port is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	/* Packets still in flight keep the mapping */
+	if (rte_mbuf_ext_refcnt_update(&p->map->shinfo, -1) == 0)
+		pcap_mapping_free(NULL, p->map);
+	rte_free(port);
+
+	return 0;
+}
+
+static int
+rte_port_pcap_reader_stats_read(void *port,
+		struct rte_port_in_stats *stats, int clear)
+{
+	struct rte_port_pcap_reader *p = (struct rte_port_pcap_reader *) port;
+
+	if (stats != NULL)
+		memcpy(stats, &p->stats, sizeof(p->stats));
+
+	if (clear)
+		memset(&p->stats, 0, sizeof(p->stats));
+
+	return 0;
+}
+
+/*
+ * Port PCAP WRITER
+ *
+ */
+#ifdef RTE_PORT_STATS_COLLECT
+
+#define RTE_PORT_PCAP_WRITER_STATS_PKTS_IN_ADD(port, val) \
+	port->stats.n_pkts_in += val
+#define RTE_PORT_PCAP_WRITER_STATS_PKTS_DROP_ADD(port, val) \
+	port->stats.n_pkts_drop += val
+
+#else
+
+#define RTE_PORT_PCAP_WRITER_STATS_PKTS_IN_ADD(port, val)
+#define RTE_PORT_PCAP_WRITER_STATS_PKTS_DROP_ADD(port, val)
+
+#endif
+
+/* Size of the stdio buffer of the capture file */
+#define PCAP_WRITER_BUFFER_SIZE             (1 << 20)
+
+struct rte_port_pcap_writer {
+	struct rte_port_out_stats stats;
+
+	FILE *f;
+	uint32_t snaplen;
+	uint32_t flush_threshold;
+	uint32_t n_unflushed;
+
+	/* Timestamps: wall clock at creation plus elapsed TSC */
+	uint64_t ns_start;
+	uint64_t tsc_start;
+	uint64_t tsc_hz;
+};
+
+static void *
+rte_port_pcap_writer_create(void *params, int socket_id)
+{
+	struct rte_port_pcap_writer_params *conf =
+			(struct rte_port_pcap_writer_params *) params;
+	struct rte_port_pcap_writer *port;
+	struct pcap_file_hdr fh;
+	struct timespec ts;
+
+	/* Check input parameters */
+	if ((conf == NULL) ||
+	    (conf->file_name == NULL) ||
+	    (conf->snaplen > PCAP_SNAPLEN_MAX)) {
+		RTE_LOG(ERR, PORT, "%s: Invalid params\n", __func__);
+		return NULL;
+	}
+
+	/* Memory allocation */
+	port = rte_zmalloc_socket("PORT", sizeof(*port),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Failed to allocate port\n", __func__);
+		return NULL;
+	}
+
+	port->f = fopen(conf->file_name, "w");
+	if (port->f == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Cannot open %s\n", __func__,
+			conf->file_name);
+		rte_free(port);
+		return NULL;
+	}
+	setvbuf(port->f, NULL, _IOFBF, PCAP_WRITER_BUFFER_SIZE);
+
+	/* Initialization */
+	port->snaplen = (conf->snaplen == 0) ? PCAP_SNAPLEN_MAX : conf->snaplen;
+	port->flush_threshold = conf->flush_threshold;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	port->ns_start = ts.tv_sec * NS_PER_S + ts.tv_nsec;
+	port->tsc_start = rte_rdtsc();
+	port->tsc_hz = rte_get_tsc_hz();
+
+	fh.magic = PCAP_MAGIC_NSEC;
+	fh.version_major = PCAP_VERSION_MAJOR;
+	fh.version_minor = PCAP_VERSION_MINOR;
+	fh.thiszone = 0;
+	fh.sigfigs = 0;
+	fh.snaplen = port->snaplen;
+	fh.linktype = PCAP_LINKTYPE_ETHERNET;
+	if (fwrite(&fh, sizeof(fh), 1, port->f) != 1) {
+		RTE_LOG(ERR, PORT, "%s: Cannot write %s\n", __func__,
+			conf->file_name);
+		fclose(port->f);
+		rte_free(port);
+		return NULL;
+	}
+
+	return port;
+}
+
+static inline uint64_t
+pcap_writer_now(struct rte_port_pcap_writer *p)
+{
+	return p->ns_start +
+		pcap_tsc_to_ns(rte_rdtsc() - p->tsc_start, p->tsc_hz);
+}
+
+/* write one packet, segment by segment, up to the snap length */
+static void
+pcap_writer_write(struct rte_port_pcap_writer *p, struct rte_mbuf *pkt,
+	uint64_t ns)
+{
+	struct pcap_rec_hdr r;
+	struct rte_mbuf *seg;
+	uint32_t len, seg_len;
+
+	len = RTE_MIN(pkt->pkt_len, p->snaplen);
+	r.ts_sec = (uint32_t)(ns / NS_PER_S);
+	r.ts_frac = (uint32_t)(ns % NS_PER_S);
+	r.caplen = len;
+	r.len = pkt->pkt_len;
+	if (fwrite(&r, sizeof(r), 1, p->f) != 1)
+		goto error;
+
+	for (seg = pkt; seg != NULL && len != 0; seg = seg->next) {
+		seg_len = RTE_MIN((uint32_t)seg->data_len, len);
+		if (fwrite(rte_pktmbuf_mtod(seg, void *), 1, seg_len, p->f) !=
+		    seg_len)
+			goto error;
+		len -= seg_len;
+	}
+
+	RTE_PORT_PCAP_WRITER_STATS_PKTS_IN_ADD(p, 1);
+	p->n_unflushed++;
+	return;
+
+error:
+	RTE_PORT_PCAP_WRITER_STATS_PKTS_DROP_ADD(p, 1);
+}
+
+static int
+rte_port_pcap_writer_flush(void *port)
+{
+	struct rte_port_pcap_writer *p = (struct rte_port_pcap_writer *) port;
+
+	p->n_unflushed = 0;
+	return fflush(p->f);
+}
+
+static inline void
+pcap_writer_check_flush(struct rte_port_pcap_writer *p)
+{
+	if (p->flush_threshold != 0 && p->n_unflushed >= p->flush_threshold)
+		rte_port_pcap_writer_flush(p);
+}
+
+static int
+rte_port_pcap_writer_tx(void *port, struct rte_mbuf *pkt)
+{
+	struct rte_port_pcap_writer *p = (struct rte_port_pcap_writer *) port;
+
+	pcap_writer_write(p, pkt, pcap_writer_now(p));
+	rte_pktmbuf_free(pkt);
+	pcap_writer_check_flush(p);
+
+	return 0;
+}
+
+static int
+rte_port_pcap_writer_tx_bulk(void *port, struct rte_mbuf **pkts,
+	uint64_t pkts_mask)
+{
+	struct rte_port_pcap_writer *p = (struct rte_port_pcap_writer *) port;
+	uint64_t ns = pcap_writer_now(p);
+	uint64_t mask;
+
+	for (mask = pkts_mask; mask != 0; mask &= mask - 1)
+		pcap_writer_write(p, pkts[__builtin_ctzll(mask)], ns);
+
+	if ((pkts_mask & (pkts_mask + 1)) == 0) {
+		uint32_t n_pkts = __builtin_popcountll(pkts_mask);
+
+		rte_pktmbuf_free_bulk(pkts, n_pkts);
+	} else {
+		for (mask = pkts_mask; mask != 0; mask &= mask - 1)
+			rte_pktmbuf_free(pkts[__builtin_ctzll(mask)]);
+	}
+	pcap_writer_check_flush(p);
+
+	return 0;
+}
+
+static int
+rte_port_pcap_writer_free(void *port)
+{
+	struct rte_port_pcap_writer *p = (struct rte_port_pcap_writer *) port;
+	int ret;
+
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Port is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	ret = fclose(p->f);
+	rte_free(port);
+
+	return ret;
+}
+
+static int
+rte_port_pcap_writer_stats_read(void *port,
+		struct rte_port_out_stats *stats, int clear)
+{
+	struct rte_port_pcap_writer *p = (struct rte_port_pcap_writer *) port;
+
+	if (stats != NULL)
+		memcpy(stats, &p->stats, sizeof(p->stats));
+
+	if (clear)
+		memset(&p->stats, 0, sizeof(p->stats));
+
+	return 0;
+}
+
+/*
+ * Summary of port operations
+ */
+struct rte_port_in_ops rte_port_pcap_reader_ops = {
+	.f_create = rte_port_pcap_reader_create,
+	.f_free = rte_port_pcap_reader_free,
+	.f_rx = rte_port_pcap_reader_rx,
+	.f_stats = rte_port_pcap_reader_stats_read,
+};
+
+struct rte_port_out_ops rte_port_pcap_writer_ops = {
+	.f_create = rte_port_pcap_writer_create,
+	.f_free = rte_port_pcap_writer_free,
+	.f_tx = rte_port_pcap_writer_tx,
+	.f_tx_bulk = rte_port_pcap_writer_tx_bulk,
+	.f_flush = rte_port_pcap_writer_flush,
+	.f_stats = rte_port_pcap_writer_stats_read,
+};
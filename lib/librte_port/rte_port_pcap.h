@@ -0,0 +1,125 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __INCLUDE_RTE_PORT_PCAP_H__
+#define __INCLUDE_RTE_PORT_PCAP_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * RTE Port PCAP File
+ *
+ * pcap_reader: input port replaying the packets of a capture file in the
+ * libpcap format. The file is mapped in memory and each record becomes a
+ * packet mbuf allocated from a mempool, either pointing into the mapping
+ * as an external buffer (zero copy) or holding a copy of the record data.
+ * Packets are delivered as fast as possible, or paced by the timestamps of
+ * the capture.
+ *
+ * pcap_writer: output port writing the packets it receives into a capture
+ * file in the libpcap format, then freeing them.
+ *
+ * No dependency on libpcap: the file format is handled directly, with
+ * microsecond and nanosecond resolution files of both byte orders
+ * accepted on input.
+ *
+ ***/
+
+#include <stdint.h>
+
+#include <rte_mempool.h>
+
+#include "rte_port.h"
+
+/** pcap_reader flag: attach the record data to the mbufs instead of
+copying it. The mbufs are read-only in this mode. */
+#define RTE_PORT_PCAP_READER_F_ZERO_COPY                   0x0001
+
+/** pcap_reader flag: deliver each packet no earlier than its timestamp,
+relative to the first packet of the capture. */
+#define RTE_PORT_PCAP_READER_F_PACED                       0x0002
+
+/** pcap_reader port parameters */
+struct rte_port_pcap_reader_params {
+	/** Packet mbuf pool the packets are allocated from */
+	struct rte_mempool *mempool;
+
+	/** Path of the capture file */
+	const char *file_name;
+
+	/** Number of times the capture is replayed, 0 for no limit */
+	uint32_t n_loops;
+
+	/** RTE_PORT_PCAP_READER_F_* flags */
+	uint32_t flags;
+};
+
+/** pcap_reader port operations */
+extern struct rte_port_in_ops rte_port_pcap_reader_ops;
+
+/**
+ * Check whether a pcap_reader port has delivered all its packets
+ *
+ * An empty burst is otherwise ambiguous in paced mode.
+ *
+ * @param port
+ *   Handle to pcap_reader port instance
+ * @return
+ *   1 once the last record of the last loop has been read, 0 otherwise
+ */
+int rte_port_pcap_reader_eof(void *port);
+
+/** pcap_writer port parameters */
+struct rte_port_pcap_writer_params {
+	/** Path of the capture file, created or truncated */
+	const char *file_name;
+
+	/** Maximum number of bytes saved per packet, 0 for 65535 */
+	uint32_t snaplen;
+
+	/** Number of packets after which the file is flushed, 0 to flush
+	only on request */
+	uint32_t flush_threshold;
+};
+
+/** pcap_writer port operations */
+extern struct rte_port_out_ops rte_port_pcap_writer_ops;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,453 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+
+#include "rte_port_ring.h"
+
+/*
+ * Port RING Reader
+ *
+ */
+#ifdef RTE_PORT_STATS_COLLECT
+
+#define RTE_PORT_RING_READER_STATS_PKTS_IN_ADD(port, val) \
+	port->stats.n_pkts_in += val
+#define RTE_PORT_RING_READER_STATS_PKTS_DROP_ADD(port, val) \
+	port->stats.n_pkts_drop += val
+
+#else
+
+#define RTE_PORT_RING_READER_STATS_PKTS_IN_ADD(port, val)
+#define RTE_PORT_RING_READER_STATS_PKTS_DROP_ADD(port, val)
+
+#endif
+
+struct rte_port_ring_reader {
+	struct rte_port_in_stats stats;
+
+	struct rte_ring *ring;
+
+	/* Batching of partial bursts */
+	uint32_t rx_burst_sz;
+	uint32_t rx_buf_count;
+	uint64_t rx_timeout;
+	uint64_t rx_deadline;
+	struct rte_mbuf *rx_buf[RTE_PORT_IN_BURST_SIZE_MAX];
+};
+
+static void *
+rte_port_ring_reader_create(void *params, int socket_id)
+{
+	struct rte_port_ring_reader_params *conf =
+			(struct rte_port_ring_reader_params *) params;
+	struct rte_port_ring_reader *port;
+
+	/* Check input parameters */
+	if ((conf == NULL) ||
+	    (conf->ring == NULL) ||
+	    (conf->rx_burst_sz > RTE_PORT_IN_BURST_SIZE_MAX)) {
+		RTE_LOG(ERR, PORT, "%s: Invalid Parameters\n", __func__);
+		return NULL;
+	}
+
+	/* Memory allocation */
+	port = rte_zmalloc_socket("PORT", sizeof(*port),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Failed to allocate port\n", __func__);
+		return NULL;
+	}
+
+	/* Initialization */
+	port->ring = conf->ring;
+	port->rx_burst_sz = conf->rx_burst_sz;
+	port->rx_timeout = conf->rx_timeout;
+
+	return port;
+}
+
+static int
+rte_port_ring_reader_rx(void *port, struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	struct rte_port_ring_reader *p = (struct rte_port_ring_reader *) port;
+	uint32_t burst_sz, count, n;
+
+	if (p->rx_burst_sz == 0) {
+		n = rte_ring_dequeue_burst(p->ring, (void **) pkts, n_pkts);
+		rte_mbuf_history_mark_bulk(pkts, n,
+			RTE_MBUF_HISTORY_OWNER_LCORE, RTE_MBUF_HISTORY_OP_DEQUEUE);
+		RTE_PORT_RING_READER_STATS_PKTS_IN_ADD(p, n);
+		return n;
+	}
+
+	burst_sz = RTE_MIN(n_pkts, p->rx_burst_sz);
+	count = p->rx_buf_count;
+
+	/* Nothing buffered: full bursts go straight to the caller */
+	if (count == 0) {
+		n = rte_ring_dequeue_burst(p->ring, (void **) pkts, burst_sz);
+		rte_mbuf_history_mark_bulk(pkts, n,
+			RTE_MBUF_HISTORY_OWNER_LCORE, RTE_MBUF_HISTORY_OP_DEQUEUE);
+		if (n == burst_sz || n == 0) {
+			RTE_PORT_RING_READER_STATS_PKTS_IN_ADD(p, n);
+			return n;
+		}
+
+		memcpy(p->rx_buf, pkts, n * sizeof(pkts[0]));
+		p->rx_buf_count = n;
+		p->rx_deadline = rte_rdtsc() + p->rx_timeout;
+		return 0;
+	}
+
+	if (count < burst_sz) {
+		n = rte_ring_dequeue_burst(p->ring,
+			(void **) &p->rx_buf[count], burst_sz - count);
+		rte_mbuf_history_mark_bulk(&p->rx_buf[count], n,
+			RTE_MBUF_HISTORY_OWNER_LCORE, RTE_MBUF_HISTORY_OP_DEQUEUE);
+		count += n;
+		if (count < burst_sz && (p->rx_timeout == 0 ||
+		    rte_rdtsc() < p->rx_deadline)) {
+			p->rx_buf_count = count;
+			return 0;
+		}
+	}
+
+	/* Deliver the burst, keeping what the caller has no room for */
+	n = RTE_MIN(count, burst_sz);
+	memcpy(pkts, p->rx_buf, n * sizeof(pkts[0]));
+	memmove(p->rx_buf, &p->rx_buf[n], (count - n) * sizeof(pkts[0]));
+	p->rx_buf_count = count - n;
+	RTE_PORT_RING_READER_STATS_PKTS_IN_ADD(p, n);
+
+	return n;
+}
+
+static int
+rte_port_ring_reader_free(void *port)
+{
+	struct rte_port_ring_reader *p = (struct rte_port_ring_reader *) port;
+
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: port is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	rte_pktmbuf_free_bulk(p->rx_buf, p->rx_buf_count);
+	rte_free(port);
+
+	return 0;
+}
+
+static int
+rte_port_ring_reader_stats_read(void *port,
+		struct rte_port_in_stats *stats, int clear)
+{
+	struct rte_port_ring_reader *p = (struct rte_port_ring_reader *) port;
+
+	if (stats != NULL)
+		memcpy(stats, &p->stats, sizeof(p->stats));
+
+	if (clear)
+		memset(&p->stats, 0, sizeof(p->stats));
+
+	return 0;
+}
+
+/*
+ * Port RING Writer
+ *
+ */
+#ifdef RTE_PORT_STATS_COLLECT
+
+#define RTE_PORT_RING_WRITER_STATS_PKTS_IN_ADD(port, val) \
+	port->stats.n_pkts_in += val
+#define RTE_PORT_RING_WRITER_STATS_PKTS_DROP_ADD(port, val) \
+	port->stats.n_pkts_drop += val
+
+#else
+
+#define RTE_PORT_RING_WRITER_STATS_PKTS_IN_ADD(port, val)
+#define RTE_PORT_RING_WRITER_STATS_PKTS_DROP_ADD(port, val)
+
+#endif
+
+struct rte_port_ring_writer {
+	struct rte_port_out_stats stats;
+
+	struct rte_mbuf *tx_buf[2 * RTE_PORT_IN_BURST_SIZE_MAX];
+	struct rte_ring *ring;
+	uint32_t tx_burst_sz;
+	uint32_t tx_buf_count;
+	uint64_t bsz_mask;
+	uint64_t tx_timeout;
+	uint64_t tx_deadline;
+	uint64_t n_retries; /* 0 for the writer that drops */
+};
+
+static void *
+rte_port_ring_writer_create_internal(struct rte_ring *ring,
+	uint32_t tx_burst_sz, uint64_t tx_timeout, uint64_t n_retries,
+	int socket_id)
+{
+	struct rte_port_ring_writer *port;
+
+	/* Check input parameters */
+	if ((ring == NULL) ||
+	    (tx_burst_sz == 0) ||
+	    (tx_burst_sz > RTE_PORT_IN_BURST_SIZE_MAX)) {
+		RTE_LOG(ERR, PORT, "%s: Invalid Parameters\n", __func__);
+		return NULL;
+	}
+
+	/* Memory allocation */
+	port = rte_zmalloc_socket("PORT", sizeof(*port),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Failed to allocate port\n", __func__);
+		return NULL;
+	}
+
+	/* Initialization */
+	port->ring = ring;
+	port->tx_burst_sz = tx_burst_sz;
+	port->tx_buf_count = 0;
+	port->bsz_mask = 1LLU << (tx_burst_sz - 1);
+	port->tx_timeout = tx_timeout;
+	port->n_retries = n_retries;
+
+	return port;
+}
+
+static void *
+rte_port_ring_writer_create(void *params, int socket_id)
+{
+	struct rte_port_ring_writer_params *conf =
+			(struct rte_port_ring_writer_params *) params;
+
+	if (conf == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Invalid Parameters\n", __func__);
+		return NULL;
+	}
+
+	return rte_port_ring_writer_create_internal(conf->ring,
+		conf->tx_burst_sz, conf->tx_timeout, 0, socket_id);
+}
+
+static void *
+rte_port_ring_writer_nodrop_create(void *params, int socket_id)
+{
+	struct rte_port_ring_writer_nodrop_params *conf =
+			(struct rte_port_ring_writer_nodrop_params *) params;
+
+	if (conf == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Invalid Parameters\n", __func__);
+		return NULL;
+	}
+
+	return rte_port_ring_writer_create_internal(conf->ring,
+		conf->tx_burst_sz, conf->tx_timeout,
+		(conf->n_retries == 0) ? UINT64_MAX : conf->n_retries,
+		socket_id);
+}
+
+/* enqueue packets, retrying as configured, and drop what does not fit */
+static inline void
+ring_writer_enqueue(struct rte_port_ring_writer *p, struct rte_mbuf **pkts,
+	uint32_t n_pkts)
+{
+	uint32_t nb_tx;
+	uint64_t i;
+
+	rte_mbuf_history_mark_bulk(pkts, n_pkts,
+		RTE_MBUF_HISTORY_OWNER_LCORE, RTE_MBUF_HISTORY_OP_ENQUEUE);
+	nb_tx = rte_ring_enqueue_burst(p->ring, (void **) pkts, n_pkts);
+
+	for (i = 0; nb_tx < n_pkts && i < p->n_retries; i++)
+		nb_tx += rte_ring_enqueue_burst(p->ring,
+			(void **) &pkts[nb_tx], n_pkts - nb_tx);
+
+	if (unlikely(nb_tx < n_pkts)) {
+		RTE_PORT_RING_WRITER_STATS_PKTS_DROP_ADD(p, n_pkts - nb_tx);
+		rte_pktmbuf_free_bulk(&pkts[nb_tx], n_pkts - nb_tx);
+	}
+}
+
+static inline void
+send_burst(struct rte_port_ring_writer *p)
+{
+	ring_writer_enqueue(p, p->tx_buf, p->tx_buf_count);
+	p->tx_buf_count = 0;
+}
+
+/* send the buffer if it is full, or if its oldest packet timed out */
+static inline void
+ring_writer_check_send(struct rte_port_ring_writer *p, uint32_t old_count)
+{
+	if (p->tx_buf_count >= p->tx_burst_sz) {
+		send_burst(p);
+		return;
+	}
+
+	if (p->tx_timeout == 0 || p->tx_buf_count == 0)
+		return;
+
+	if (old_count == 0)
+		p->tx_deadline = rte_rdtsc() + p->tx_timeout;
+	else if (rte_rdtsc() >= p->tx_deadline)
+		send_burst(p);
+}
+
+static int
+rte_port_ring_writer_tx(void *port, struct rte_mbuf *pkt)
+{
+	struct rte_port_ring_writer *p = (struct rte_port_ring_writer *) port;
+	uint32_t old_count = p->tx_buf_count;
+
+	p->tx_buf[p->tx_buf_count++] = pkt;
+	RTE_PORT_RING_WRITER_STATS_PKTS_IN_ADD(p, 1);
+	ring_writer_check_send(p, old_count);
+
+	return 0;
+}
+
+static int
+rte_port_ring_writer_tx_bulk(void *port,
+		struct rte_mbuf **pkts,
+		uint64_t pkts_mask)
+{
+	struct rte_port_ring_writer *p =
+		(struct rte_port_ring_writer *) port;
+	uint64_t bsz_mask = p->bsz_mask;
+	uint32_t tx_buf_count = p->tx_buf_count;
+	uint64_t expr = (pkts_mask & (pkts_mask + 1)) |
+			((pkts_mask & bsz_mask) ^ bsz_mask);
+
+	/* Contiguous burst of at least tx_burst_sz packets: send it as is */
+	if (expr == 0) {
+		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
+
+		if (tx_buf_count)
+			send_burst(p);
+
+		RTE_PORT_RING_WRITER_STATS_PKTS_IN_ADD(p, n_pkts);
+		ring_writer_enqueue(p, pkts, n_pkts);
+	} else {
+		for ( ; pkts_mask; ) {
+			uint32_t pkt_index = __builtin_ctzll(pkts_mask);
+			uint64_t pkt_mask = 1LLU << pkt_index;
+			struct rte_mbuf *pkt = pkts[pkt_index];
+
+			p->tx_buf[p->tx_buf_count++] = pkt;
+			RTE_PORT_RING_WRITER_STATS_PKTS_IN_ADD(p, 1);
+			pkts_mask &= ~pkt_mask;
+		}
+
+		ring_writer_check_send(p, tx_buf_count);
+	}
+
+	return 0;
+}
+
+static int
+rte_port_ring_writer_flush(void *port)
+{
+	struct rte_port_ring_writer *p = (struct rte_port_ring_writer *) port;
+
+	if (p->tx_buf_count > 0)
+		send_burst(p);
+
+	return 0;
+}
+
+static int
+rte_port_ring_writer_free(void *port)
+{
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Port is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	rte_port_ring_writer_flush(port);
+	rte_free(port);
+
+	return 0;
+}
+
+static int
+rte_port_ring_writer_stats_read(void *port,
+		struct rte_port_out_stats *stats, int clear)
+{
+	struct rte_port_ring_writer *p = (struct rte_port_ring_writer *) port;
+
+	if (stats != NULL)
+		memcpy(stats, &p->stats, sizeof(p->stats));
+
+	if (clear)
+		memset(&p->stats, 0, sizeof(p->stats));
+
+	return 0;
+}
+
+/*
+ * Summary of port operations
+ */
+struct rte_port_in_ops rte_port_ring_reader_ops = {
+	.f_create = rte_port_ring_reader_create,
+	.f_free = rte_port_ring_reader_free,
+	.f_rx = rte_port_ring_reader_rx,
+	.f_stats = rte_port_ring_reader_stats_read,
+};
+
+struct rte_port_out_ops rte_port_ring_writer_ops = {
+	.f_create = rte_port_ring_writer_create,
+	.f_free = rte_port_ring_writer_free,
+	.f_tx = rte_port_ring_writer_tx,
+	.f_tx_bulk = rte_port_ring_writer_tx_bulk,
+	.f_flush = rte_port_ring_writer_flush,
+	.f_stats = rte_port_ring_writer_stats_read,
+};
+
+struct rte_port_out_ops rte_port_ring_writer_nodrop_ops = {
+	.f_create = rte_port_ring_writer_nodrop_create,
+	.f_free = rte_port_ring_writer_free,
+	.f_tx = rte_port_ring_writer_tx,
+	.f_tx_bulk = rte_port_ring_writer_tx_bulk,
+	.f_flush = rte_port_ring_writer_flush,
+	.f_stats = rte_port_ring_writer_stats_read,
+};
@@ -69,6 +69,8 @@
 #include <stdint.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <unistd.h>
+#include <poll.h>
 #include <sys/queue.h>
 
 #include <rte_common.h>
@@ -86,8 +88,10 @@
 #include <rte_errno.h>
 #include <rte_string_fns.h>
 #include <rte_spinlock.h>
+#include <rte_cycles.h>
 
 #include "rte_ring.h"
+#include "rte_ring_elem.h"
 
 TAILQ_HEAD(rte_ring_list, rte_tailq_entry);
 
@@ -99,12 +103,19 @@ EAL_REGISTER_TAILQ(rte_ring_tailq)
 /* true if x is a power of 2 */
 #define POWEROF2(x) ((((x)-1) & (x)) == 0)
 
-/* return the size of memory occupied by a ring */
+/* return the size of memory occupied by a ring of elements */
 ssize_t
-rte_ring_get_memsize(unsigned count)
+rte_ring_get_memsize_elem(unsigned esize, unsigned count)
 {
 	ssize_t sz;
 
+	/* esize must be a multiple of 4 */
+	if (esize == 0 || (esize & 3) != 0) {
+		RTE_LOG(ERR, RING,
+			"Element size is invalid, must be a multiple of 4\n");
+		return -EINVAL;
+	}
+
 	/* count must be a power of 2 */
 	if ((!POWEROF2(count)) || (count > RTE_RING_SZ_MASK )) {
 		RTE_LOG(ERR, RING,
@@ -113,15 +124,68 @@ rte_ring_get_memsize(unsigned count)
 		return -EINVAL;
 	}
 
-	sz = sizeof(struct rte_ring) + count * sizeof(void *);
+	sz = sizeof(struct rte_ring) + (ssize_t)count * esize;
 	sz = RTE_ALIGN(sz, RTE_CACHE_LINE_SIZE);
 	return sz;
 }
 
+/* return the size of memory occupied by a ring */
+ssize_t
+rte_ring_get_memsize(unsigned count)
+{
+	return rte_ring_get_memsize_elem(sizeof(void *), count);
+}
+
+/* get the synchronization mode of one side of the ring from the flags */
+static int
+get_sync_type(unsigned flags, unsigned st_flag, unsigned rts_flag,
+	unsigned hts_flag, uint32_t *sync_type)
+{
+	switch (flags & (st_flag | rts_flag | hts_flag)) {
+	case 0:
+		*sync_type = RTE_RING_SYNC_MT;
+		break;
+	case RING_F_SP_ENQ:
+	case RING_F_SC_DEQ:
+		*sync_type = RTE_RING_SYNC_ST;
+		break;
+	case RING_F_MP_RTS_ENQ:
+	case RING_F_MC_RTS_DEQ:
+		*sync_type = RTE_RING_SYNC_MT_RTS;
+		break;
+	case RING_F_MP_HTS_ENQ:
+	case RING_F_MC_HTS_DEQ:
+		*sync_type = RTE_RING_SYNC_MT_HTS;
+		break;
+	default:
+		RTE_LOG(ERR, RING,
+			"Conflicting synchronization flags 0x%x\n", flags);
+		return -EINVAL;
+	}
+	return 0;
+}
+
+/* check the flags and get the synchronization mode of both sides */
+static int
+get_sync_types(unsigned flags, uint32_t *prod_st, uint32_t *cons_st)
+{
+	int ret;
+
+	ret = get_sync_type(flags, RING_F_SP_ENQ, RING_F_MP_RTS_ENQ,
+		RING_F_MP_HTS_ENQ, prod_st);
+	if (ret != 0)
+		return ret;
+	return get_sync_type(flags, RING_F_SC_DEQ, RING_F_MC_RTS_DEQ,
+		RING_F_MC_HTS_DEQ, cons_st);
+}
+
 int
 rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 	unsigned flags)
 {
+	uint32_t prod_st, cons_st;
+	int ret;
+
 	/* compilation-time checks */
 	RTE_BUILD_BUG_ON((sizeof(struct rte_ring) &
 			  RTE_CACHE_LINE_MASK) != 0);
@@ -138,25 +202,35 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 			  RTE_CACHE_LINE_MASK) != 0);
 #endif
 
+	ret = get_sync_types(flags, &prod_st, &cons_st);
+	if (ret != 0)
+		return ret;
+
 	/* init the ring structure */
 	memset(r, 0, sizeof(*r));
 	snprintf(r->name, sizeof(r->name), "%s", name);
 	r->flags = flags;
+	r->esize = sizeof(void *);
 	r->prod.watermark = count;
 	r->prod.sp_enqueue = !!(flags & RING_F_SP_ENQ);
 	r->cons.sc_dequeue = !!(flags & RING_F_SC_DEQ);
+	r->prod.sync_type = prod_st;
+	r->cons.sync_type = cons_st;
 	r->prod.size = r->cons.size = count;
 	r->prod.mask = r->cons.mask = count-1;
 	r->prod.head = r->cons.head = 0;
 	r->prod.tail = r->cons.tail = 0;
+	r->prod.rts_head.raw = r->cons.rts_head.raw = 0;
+	r->prod.htd_max = r->cons.htd_max = RTE_MAX(count / 8, 1U);
+	r->notify.fd = -1;
 
 	return 0;
 }
 
-/* create the ring */
+/* create the ring of elements */
 struct rte_ring *
-rte_ring_create(const char *name, unsigned count, int socket_id,
-		unsigned flags)
+rte_ring_create_elem(const char *name, unsigned esize, unsigned count,
+		int socket_id, unsigned flags)
 {
 	char mz_name[RTE_MEMZONE_NAMESIZE];
 	struct rte_ring *r;
@@ -166,11 +240,18 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 	int mz_flags = 0;
 	struct rte_ring_list* ring_list = NULL;
 
+	uint32_t prod_st, cons_st;
+
 	ring_list = RTE_TAILQ_CAST(rte_ring_tailq.head, rte_ring_list);
 
-	ring_size = rte_ring_get_memsize(count);
+	if (get_sync_types(flags, &prod_st, &cons_st) != 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	ring_size = rte_ring_get_memsize_elem(esize, count);
 	if (ring_size < 0) {
-		rte_errno = ring_size;
+		rte_errno = -ring_size;
 		return NULL;
 	}
 
@@ -194,6 +275,7 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 		/* no need to check return value here, we already checked the
 		 * arguments above */
 		rte_ring_init(r, name, count, flags);
+		r->esize = esize;
 
 		te->data = (void *) r;
 
@@ -208,6 +290,15 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 	return r;
 }
 
+/* create the ring */
+struct rte_ring *
+rte_ring_create(const char *name, unsigned count, int socket_id,
+		unsigned flags)
+{
+	return rte_ring_create_elem(name, sizeof(void *), count, socket_id,
+		flags);
+}
+
 /*
  * change the high water mark. If *count* is 0, water marking is
  * disabled
@@ -226,6 +317,366 @@ rte_ring_set_water_mark(struct rte_ring *r, unsigned count)
 	return 0;
 }
 
+/* change the maximum head-tail distance of the RTS producers */
+int
+rte_ring_set_prod_htd_max(struct rte_ring *r, uint32_t v)
+{
+	if (r->prod.sync_type != RTE_RING_SYNC_MT_RTS)
+		return -ENOTSUP;
+	if (v == 0 || v > r->prod.mask)
+		return -EINVAL;
+
+	r->prod.htd_max = v;
+	return 0;
+}
+
+/* change the maximum head-tail distance of the RTS consumers */
+int
+rte_ring_set_cons_htd_max(struct rte_ring *r, uint32_t v)
+{
+	if (r->cons.sync_type != RTE_RING_SYNC_MT_RTS)
+		return -ENOTSUP;
+	if (v == 0 || v > r->cons.mask)
+		return -EINVAL;
+
+	r->cons.htd_max = v;
+	return 0;
+}
+
+static const char *
+sync_type_name(uint32_t sync_type)
+{
+	switch (sync_type) {
+	case RTE_RING_SYNC_MT: return "MT";
+	case RTE_RING_SYNC_ST: return "ST";
+	case RTE_RING_SYNC_MT_RTS: return "MT_RTS";
+	case RTE_RING_SYNC_MT_HTS: return "MT_HTS";
+	default: return "unknown";
+	}
+}
+
+/* enable the wakeup of sleeping consumers */
+int
+rte_ring_notify_register(struct rte_ring *r, int fd)
+{
+	if (fd < 0)
+		return -EINVAL;
+
+	r->notify.armed = 0;
+	r->notify.fd = fd;
+	rte_wmb();
+	r->prod.notify = 1;
+	return 0;
+}
+
+/* disable the wakeup of sleeping consumers */
+void
+rte_ring_notify_unregister(struct rte_ring *r)
+{
+	r->prod.notify = 0;
+	r->notify.armed = 0;
+	r->notify.fd = -1;
+}
+
+/* ask to be woken up by the next producer */
+int
+rte_ring_notify_arm(struct rte_ring *r)
+{
+	if (r->prod.notify == 0)
+		return -ENOTSUP;
+
+	/* the armed flag must be visible before we read the producer
+	 * tail, which is updated by the producers before they read the
+	 * flag: either they see it, or we see their objects */
+	r->notify.armed = 1;
+	rte_mb();
+	if (!rte_ring_empty(r)) {
+		r->notify.armed = 0;
+		return -EAGAIN;
+	}
+	return 0;
+}
+
+/* cancel a wakeup request */
+void
+rte_ring_notify_disarm(struct rte_ring *r)
+{
+	r->notify.armed = 0;
+}
+
+/* sleep until the ring is not empty */
+int
+rte_ring_notify_wait(struct rte_ring *r, int timeout_ms)
+{
+	struct pollfd pfd;
+	uint64_t val;
+	int ret;
+
+	ret = rte_ring_notify_arm(r);
+	if (ret == -EAGAIN)
+		return 0;
+	if (ret != 0)
+		return ret;
+
+	pfd.fd = r->notify.fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	ret = poll(&pfd, 1, timeout_ms);
+	if (ret <= 0) {
+		rte_ring_notify_disarm(r);
+		return (ret == 0) ? -ETIMEDOUT : -errno;
+	}
+
+	/* clear the eventfd counter */
+	if (read(r->notify.fd, &val, sizeof(val)) != sizeof(val))
+		RTE_LOG(DEBUG, RING, "%s: cannot read eventfd\n", r->name);
+	return 0;
+}
+
+/* wake up the consumer waiting for the ring */
+void
+__rte_ring_notify_wake(struct rte_ring *r)
+{
+	uint64_t val = 1;
+
+	/* only the first producer after the arm writes the eventfd */
+	if (rte_atomic32_cmpset(&r->notify.armed, 1, 0) == 0)
+		return;
+
+	if (write(r->notify.fd, &val, sizeof(val)) != sizeof(val))
+		RTE_LOG(DEBUG, RING, "%s: cannot write eventfd\n", r->name);
+}
+
+/* state of the residency timestamp */
+#define SAMPLE_STAMP_FREE  0 /* no object is timestamped */
+#define SAMPLE_STAMP_BUSY  1 /* a producer is writing the timestamp */
+#define SAMPLE_STAMP_READY 2 /* the object at stamp_pos is timestamped */
+
+/* storage of the sampling statistics of a ring */
+struct rte_ring_sample {
+	uint32_t mask;                    /* sample when (calls & mask) == 0 */
+
+	/* one object in flight is timestamped at a time */
+	volatile uint32_t stamp_state __rte_cache_aligned;
+	uint32_t stamp_pos;
+	uint64_t stamp_tsc;
+
+	struct rte_ring_sample_stats lcore[RTE_MAX_LCORE];
+};
+
+static void
+sample_occupancy(const struct rte_ring *r, struct rte_ring_sample_stats *st,
+	uint32_t used)
+{
+	uint64_t b = (uint64_t)used * RTE_RING_OCC_BUCKETS / r->prod.size;
+
+	st->occupancy[RTE_MIN(b, (uint64_t)RTE_RING_OCC_BUCKETS - 1)]++;
+}
+
+/* start collecting statistics */
+int
+rte_ring_sample_enable(struct rte_ring *r, unsigned period_log2)
+{
+	struct rte_ring_sample *s = r->sample;
+
+	if (period_log2 > 31)
+		return -EINVAL;
+
+	if (s == NULL) {
+		s = rte_zmalloc("RING_SAMPLE", sizeof(*s), RTE_CACHE_LINE_SIZE);
+		if (s == NULL) {
+			RTE_LOG(ERR, RING, "Cannot allocate statistics of %s\n",
+				r->name);
+			return -ENOMEM;
+		}
+		r->sample = s;
+	}
+
+	s->mask = (1U << period_log2) - 1;
+	rte_ring_sample_reset(r);
+	rte_wmb();
+	r->prod.sample = s;
+	r->cons.sample = s;
+	return 0;
+}
+
+/* stop collecting statistics; the storage is kept, as other lcores
+ * may still be using it */
+void
+rte_ring_sample_disable(struct rte_ring *r)
+{
+	r->prod.sample = NULL;
+	r->cons.sample = NULL;
+}
+
+/* reset the statistics */
+void
+rte_ring_sample_reset(struct rte_ring *r)
+{
+	struct rte_ring_sample *s = r->sample;
+
+	if (s == NULL)
+		return;
+	memset(s->lcore, 0, sizeof(s->lcore));
+	s->stamp_state = SAMPLE_STAMP_FREE;
+}
+
+/* sum the statistics of all lcores */
+int
+rte_ring_sample_get(const struct rte_ring *r,
+	struct rte_ring_sample_stats *stats)
+{
+	const struct rte_ring_sample *s = r->sample;
+	const struct rte_ring_sample_stats *st;
+	unsigned lcore_id, i;
+
+	if (s == NULL)
+		return -ENOENT;
+
+	memset(stats, 0, sizeof(*stats));
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		st = &s->lcore[lcore_id];
+		stats->enq_calls += st->enq_calls;
+		stats->enq_partial += st->enq_partial;
+		stats->enq_fail += st->enq_fail;
+		stats->deq_calls += st->deq_calls;
+		stats->deq_partial += st->deq_partial;
+		stats->deq_fail += st->deq_fail;
+		for (i = 0; i < RTE_RING_OCC_BUCKETS; i++)
+			stats->occupancy[i] += st->occupancy[i];
+		for (i = 0; i < RTE_RING_RES_BUCKETS; i++)
+			stats->residency[i] += st->residency[i];
+	}
+	return 0;
+}
+
+/* account an enqueue call */
+void
+__rte_ring_sample_enq(struct rte_ring *r, unsigned req, unsigned n,
+	uint32_t free_entries)
+{
+	struct rte_ring_sample *s = r->prod.sample;
+	struct rte_ring_sample_stats *st;
+	unsigned lcore_id = rte_lcore_id();
+
+	if (s == NULL || lcore_id >= RTE_MAX_LCORE)
+		return;
+
+	st = &s->lcore[lcore_id];
+	st->enq_calls++;
+	if (n == 0) {
+		st->enq_fail++;
+		return;
+	}
+	if (n < req)
+		st->enq_partial++;
+	if ((st->enq_calls & s->mask) == 0)
+		sample_occupancy(r, st, r->prod.mask - free_entries + n);
+}
+
+/* timestamp the last object of a sampled enqueue */
+void
+__rte_ring_sample_stamp(struct rte_ring *r, uint32_t pos)
+{
+	struct rte_ring_sample *s = r->prod.sample;
+	unsigned lcore_id = rte_lcore_id();
+
+	if (s == NULL || lcore_id >= RTE_MAX_LCORE)
+		return;
+	if ((s->lcore[lcore_id].enq_calls & s->mask) != 0)
+		return;
+
+	if (s->stamp_state != SAMPLE_STAMP_FREE ||
+	    rte_atomic32_cmpset(&s->stamp_state, SAMPLE_STAMP_FREE,
+				SAMPLE_STAMP_BUSY) == 0)
+		return;
+
+	s->stamp_pos = pos;
+	s->stamp_tsc = rte_rdtsc();
+	rte_wmb();
+	/* the object is not published yet, so no consumer can miss it */
+	s->stamp_state = SAMPLE_STAMP_READY;
+	rte_wmb();
+}
+
+/* account a dequeue call, and the residency time of a timestamped
+ * object if it is part of the dequeued ones */
+void
+__rte_ring_sample_deq(struct rte_ring *r, unsigned req, unsigned n,
+	uint32_t entries, uint32_t head)
+{
+	struct rte_ring_sample *s = r->cons.sample;
+	struct rte_ring_sample_stats *st = NULL;
+	unsigned lcore_id = rte_lcore_id();
+	uint64_t cycles;
+	unsigned b;
+
+	if (s == NULL)
+		return;
+	if (lcore_id < RTE_MAX_LCORE)
+		st = &s->lcore[lcore_id];
+
+	/* only the consumer of the timestamped object releases the stamp,
+	 * even if it is not an EAL thread */
+	if (n != 0 && s->stamp_state == SAMPLE_STAMP_READY) {
+		rte_rmb();
+		if (s->stamp_pos - head < n) {
+			cycles = rte_rdtsc() - s->stamp_tsc;
+			rte_compiler_barrier();
+			s->stamp_state = SAMPLE_STAMP_FREE;
+			if (st != NULL) {
+				b = (cycles == 0) ? 0 :
+					64 - __builtin_clzll(cycles);
+				b = RTE_MIN(b, RTE_RING_RES_BUCKETS - 1U);
+				st->residency[b]++;
+			}
+		}
+	}
+
+	if (st == NULL)
+		return;
+
+	st->deq_calls++;
+	if (n == 0) {
+		st->deq_fail++;
+		return;
+	}
+	if (n < req)
+		st->deq_partial++;
+	if ((st->deq_calls & s->mask) == 0)
+		sample_occupancy(r, st, entries);
+}
+
+/* dump the sampling statistics, skipping empty histogram buckets */
+static void
+ring_dump_sample(FILE *f, const struct rte_ring *r)
+{
+	struct rte_ring_sample_stats st;
+	unsigned i;
+
+	rte_ring_sample_get(r, &st);
+	fprintf(f, "  sample=%s period=%"PRIu32"\n",
+		(r->prod.sample != NULL) ? "on" : "off", r->sample->mask + 1);
+	fprintf(f, "  enq_calls=%"PRIu64" enq_partial=%"PRIu64
+		" enq_fail=%"PRIu64"\n",
+		st.enq_calls, st.enq_partial, st.enq_fail);
+	fprintf(f, "  deq_calls=%"PRIu64" deq_partial=%"PRIu64
+		" deq_fail=%"PRIu64"\n",
+		st.deq_calls, st.deq_partial, st.deq_fail);
+	for (i = 0; i < RTE_RING_OCC_BUCKETS; i++) {
+		if (st.occupancy[i] == 0)
+			continue;
+		fprintf(f, "  occupancy[%u/%u]=%"PRIu64"\n", i,
+			RTE_RING_OCC_BUCKETS, st.occupancy[i]);
+	}
+	for (i = 0; i < RTE_RING_RES_BUCKETS; i++) {
+		if (st.residency[i] == 0)
+			continue;
+		fprintf(f, "  residency[<2^%u cycles]=%"PRIu64"\n", i,
+			st.residency[i]);
+	}
+}
+
 /* dump the status of the ring on the console */
 void
 rte_ring_dump(FILE *f, const struct rte_ring *r)
@@ -238,16 +689,32 @@ rte_ring_dump(FILE *f, const struct rte_ring *r)
 	fprintf(f, "ring <%s>@%p\n", r->name, r);
 	fprintf(f, "  flags=%x\n", r->flags);
 	fprintf(f, "  size=%"PRIu32"\n", r->prod.size);
+	fprintf(f, "  esize=%"PRIu32"\n", r->esize);
+	fprintf(f, "  prod_sync=%s\n", sync_type_name(r->prod.sync_type));
+	fprintf(f, "  cons_sync=%s\n", sync_type_name(r->cons.sync_type));
 	fprintf(f, "  ct=%"PRIu32"\n", r->cons.tail);
-	fprintf(f, "  ch=%"PRIu32"\n", r->cons.head);
+	if (r->cons.sync_type == RTE_RING_SYNC_MT_RTS) {
+		fprintf(f, "  ch=%"PRIu32"\n", r->cons.rts_head.val.pos);
+		fprintf(f, "  cons_htd_max=%"PRIu32"\n", r->cons.htd_max);
+	} else
+		fprintf(f, "  ch=%"PRIu32"\n", r->cons.head);
 	fprintf(f, "  pt=%"PRIu32"\n", r->prod.tail);
-	fprintf(f, "  ph=%"PRIu32"\n", r->prod.head);
+	if (r->prod.sync_type == RTE_RING_SYNC_MT_RTS) {
+		fprintf(f, "  ph=%"PRIu32"\n", r->prod.rts_head.val.pos);
+		fprintf(f, "  prod_htd_max=%"PRIu32"\n", r->prod.htd_max);
+	} else
+		fprintf(f, "  ph=%"PRIu32"\n", r->prod.head);
 	fprintf(f, "  used=%u\n", rte_ring_count(r));
 	fprintf(f, "  avail=%u\n", rte_ring_free_count(r));
 	if (r->prod.watermark == r->prod.size)
 		fprintf(f, "  watermark=0\n");
 	else
 		fprintf(f, "  watermark=%"PRIu32"\n", r->prod.watermark);
+	if (r->prod.notify)
+		fprintf(f, "  notify_fd=%d armed=%"PRIu32"\n", r->notify.fd,
+			r->notify.armed);
+	if (r->sample != NULL)
+		ring_dump_sample(f, r);
 
 	/* sum and dump statistics */
 #ifdef RTE_LIBRTE_RING_DEBUG
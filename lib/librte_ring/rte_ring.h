@@ -81,9 +81,19 @@
  * - Multi- or single-producer enqueue.
  * - Bulk dequeue.
  * - Bulk enqueue.
- *
- * Note: the ring implementation is not preemptable. A lcore must not
- * be interrupted by another task that uses the same ring.
+ * - Zero-copy enqueue and dequeue (see rte_ring_zc.h).
+ * - Elements of any size multiple of 4 bytes instead of pointers
+ *   (see rte_ring_elem.h).
+ * - Optional wakeup of a sleeping consumer through an eventfd
+ *   (see rte_ring_notify_register()).
+ * - Runtime sampling of occupancy and residency time
+ *   (see rte_ring_sample_enable()).
+ *
+ * Note: in the default multi-producers/consumers mode, the ring
+ * implementation is not preemptable. A lcore must not be interrupted by
+ * another task that uses the same ring. The RTS and HTS modes (see
+ * rte_ring_create() flags) are meant for threads that can be preempted,
+ * e.g. when lcores share their CPU with other threads.
  *
  */
 
@@ -126,6 +136,32 @@ struct rte_ring_debug_stats {
 } __rte_cache_aligned;
 #endif
 
+#define RTE_RING_OCC_BUCKETS 16 /**< Buckets of the occupancy histogram. */
+#define RTE_RING_RES_BUCKETS 32 /**< Buckets of the residency histogram. */
+
+/**
+ * Ring statistics collected at runtime, see rte_ring_sample_enable().
+ *
+ * The call counters are updated by every call; the histograms are
+ * updated by one call out of the sampling period.
+ */
+struct rte_ring_sample_stats {
+	uint64_t enq_calls;   /**< Enqueue calls. */
+	uint64_t enq_partial; /**< Enqueues of fewer objects than requested. */
+	uint64_t enq_fail;    /**< Enqueues of no object. */
+	uint64_t deq_calls;   /**< Dequeue calls. */
+	uint64_t deq_partial; /**< Dequeues of fewer objects than requested. */
+	uint64_t deq_fail;    /**< Dequeues of no object. */
+	/** Number of objects in the ring seen by sampled calls. Bucket i
+	 *  counts the occupancies between i/16 and (i+1)/16 of the size. */
+	uint64_t occupancy[RTE_RING_OCC_BUCKETS];
+	/** Time spent in the ring by sampled objects, in TSC cycles.
+	 *  Bucket i counts the times between 2^(i-1) and 2^i - 1. */
+	uint64_t residency[RTE_RING_RES_BUCKETS];
+} __rte_cache_aligned;
+
+struct rte_ring_sample;
+
 #define RTE_RING_NAMESIZE 32 /**< The maximum length of a ring name. */
 #define RTE_RING_MZ_PREFIX "RG_"
 
@@ -134,6 +170,39 @@ struct rte_ring_debug_stats {
                                     *   if RTE_RING_PAUSE_REP not defined. */
 #endif
 
+/**
+ * Synchronization mode of the producers or of the consumers of a ring.
+ */
+enum rte_ring_sync_type {
+	RTE_RING_SYNC_MT = 0,  /**< Multi-thread safe (default mode). */
+	RTE_RING_SYNC_ST = 1,  /**< Single thread only. */
+	RTE_RING_SYNC_MT_RTS,  /**< Multi-thread safe, relaxed tail sync. */
+	RTE_RING_SYNC_MT_HTS,  /**< Multi-thread safe, head/tail sync. */
+};
+
+/**
+ * Head and tail of a ring in HTS mode, updated as a single word.
+ */
+union rte_ring_hts_pos {
+	uint64_t raw;
+	struct {
+		uint32_t head; /**< Head position. */
+		uint32_t tail; /**< Tail position. */
+	} pos;
+};
+
+/**
+ * Head or tail of a ring in RTS mode: a position and its update counter,
+ * updated as a single word.
+ */
+union rte_ring_rts_poscnt {
+	uint64_t raw;
+	struct {
+		uint32_t cnt;  /**< Update counter. */
+		uint32_t pos;  /**< Position. */
+	} val;
+};
+
 /**
  * An RTE ring structure.
  *
@@ -143,10 +212,18 @@ struct rte_ring_debug_stats {
  * field. Thanks to this assumption, we can do subtractions between 2 index
  * values in a modulo-32bit base: that's why the overflow of the indexes is not
  * a problem.
+ *
+ * In RTS mode, the head of a side is stored in *rts_head*, and the *head*
+ * and *tail* words hold the tail update counter and the tail position
+ * (see union rte_ring_rts_poscnt). In all modes, *tail* is the position
+ * read by the other side of the ring.
  */
 struct rte_ring {
 	char name[RTE_RING_NAMESIZE];    /**< Name of the ring. */
 	int flags;                       /**< Flags supplied at creation. */
+	uint32_t esize;                  /**< Size of an element, in bytes. */
+	/** Storage of the sampling statistics, NULL if never enabled. */
+	struct rte_ring_sample *sample;
 
 	/** Ring producer status. */
 	struct prod {
@@ -154,8 +231,21 @@ struct rte_ring {
 		uint32_t sp_enqueue;     /**< True, if single producer. */
 		uint32_t size;           /**< Size of ring. */
 		uint32_t mask;           /**< Mask (size-1) of ring. */
-		volatile uint32_t head;  /**< Producer head. */
-		volatile uint32_t tail;  /**< Producer tail. */
+		union {
+			/** Head and tail as one word, for HTS/RTS modes. */
+			volatile uint64_t raw;
+			struct {
+				volatile uint32_t head;  /**< Producer head. */
+				volatile uint32_t tail;  /**< Producer tail. */
+			};
+		};
+		uint32_t sync_type;      /**< Producer sync mode. */
+		uint32_t htd_max;        /**< Max head-tail distance (RTS). */
+		uint32_t notify;         /**< True if consumers may sleep. */
+		/** Producer head and update counter (RTS). */
+		volatile union rte_ring_rts_poscnt rts_head;
+		/** Sampling statistics if enabled, else NULL. */
+		struct rte_ring_sample *volatile sample;
 	} prod __rte_cache_aligned;
 
 	/** Ring consumer status. */
@@ -163,14 +253,32 @@ struct rte_ring {
 		uint32_t sc_dequeue;     /**< True, if single consumer. */
 		uint32_t size;           /**< Size of the ring. */
 		uint32_t mask;           /**< Mask (size-1) of ring. */
-		volatile uint32_t head;  /**< Consumer head. */
-		volatile uint32_t tail;  /**< Consumer tail. */
+		uint32_t sync_type;      /**< Consumer sync mode. */
+		union {
+			/** Head and tail as one word, for HTS/RTS modes. */
+			volatile uint64_t raw;
+			struct {
+				volatile uint32_t head;  /**< Consumer head. */
+				volatile uint32_t tail;  /**< Consumer tail. */
+			};
+		};
+		uint32_t htd_max;        /**< Max head-tail distance (RTS). */
+		/** Consumer head and update counter (RTS). */
+		volatile union rte_ring_rts_poscnt rts_head;
+		/** Sampling statistics if enabled, else NULL. */
+		struct rte_ring_sample *volatile sample;
 #ifdef RTE_RING_SPLIT_PROD_CONS
 	} cons __rte_cache_aligned;
 #else
 	} cons;
 #endif
 
+	/** Consumer wakeup status, see rte_ring_notify_register(). */
+	struct notify {
+		volatile uint32_t armed; /**< True if a consumer waits. */
+		int fd;                  /**< Eventfd to signal, or -1. */
+	} notify __rte_cache_aligned;
+
 #ifdef RTE_LIBRTE_RING_DEBUG
 	struct rte_ring_debug_stats stats[RTE_MAX_LCORE];
 #endif
@@ -182,6 +290,10 @@ struct rte_ring {
 
 #define RING_F_SP_ENQ 0x0001 /**< The default enqueue is "single-producer". */
 #define RING_F_SC_DEQ 0x0002 /**< The default dequeue is "single-consumer". */
+#define RING_F_MP_RTS_ENQ 0x0008 /**< The default enqueue is "MP RTS". */
+#define RING_F_MC_RTS_DEQ 0x0010 /**< The default dequeue is "MC RTS". */
+#define RING_F_MP_HTS_ENQ 0x0020 /**< The default enqueue is "MP HTS". */
+#define RING_F_MC_HTS_DEQ 0x0040 /**< The default dequeue is "MC HTS". */
 #define RTE_RING_QUOT_EXCEED (1 << 31)  /**< Quota exceed for burst ops */
 #define RTE_RING_SZ_MASK  (unsigned)(0x0fffffff) /**< Ring size mask */
 
@@ -253,8 +365,26 @@ ssize_t rte_ring_get_memsize(unsigned count);
  *    - RING_F_SC_DEQ: If this flag is set, the default behavior when
  *      using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
  *      is "single-consumer". Otherwise, it is "multi-consumers".
+ *    - RING_F_MP_RTS_ENQ: If this flag is set, the default behavior when
+ *      using ``rte_ring_enqueue()`` or ``rte_ring_enqueue_bulk()``
+ *      is "multi-producers with relaxed tail sync" (RTS): the producer
+ *      tail is moved by the last producer to finish, and producers never
+ *      wait for the completion of each other.
+ *    - RING_F_MC_RTS_DEQ: Same as RING_F_MP_RTS_ENQ, for the consumers.
+ *    - RING_F_MP_HTS_ENQ: If this flag is set, the default behavior when
+ *      using ``rte_ring_enqueue()`` or ``rte_ring_enqueue_bulk()``
+ *      is "multi-producers with head/tail sync" (HTS): producers are
+ *      fully serialized, a producer can only start once the previous
+ *      one has completed.
+ *    - RING_F_MC_HTS_DEQ: Same as RING_F_MP_HTS_ENQ, for the consumers.
+ *   Only one synchronization flag can be given for each side. On RTS and
+ *   HTS rings, only the generic functions (``rte_ring_enqueue*()`` and
+ *   ``rte_ring_dequeue*()``) can be used; the ``rte_ring_mp_*()``,
+ *   ``rte_ring_sp_*()``, ``rte_ring_mc_*()`` and ``rte_ring_sc_*()``
+ *   functions must not be called on the side set to RTS or HTS.
  * @return
- *   0 on success, or a negative value on error.
+ *   0 on success, or a negative value on error (-EINVAL on conflicting
+ *   flags).
  */
 int rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 	unsigned flags);
@@ -288,12 +418,29 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
  *    - RING_F_SC_DEQ: If this flag is set, the default behavior when
  *      using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
  *      is "single-consumer". Otherwise, it is "multi-consumers".
+ *    - RING_F_MP_RTS_ENQ: If this flag is set, the default behavior when
+ *      using ``rte_ring_enqueue()`` or ``rte_ring_enqueue_bulk()``
+ *      is "multi-producers with relaxed tail sync" (RTS): the producer
+ *      tail is moved by the last producer to finish, and producers never
+ *      wait for the completion of each other.
+ *    - RING_F_MC_RTS_DEQ: Same as RING_F_MP_RTS_ENQ, for the consumers.
+ *    - RING_F_MP_HTS_ENQ: If this flag is set, the default behavior when
+ *      using ``rte_ring_enqueue()`` or ``rte_ring_enqueue_bulk()``
+ *      is "multi-producers with head/tail sync" (HTS): producers are
+ *      fully serialized, a producer can only start once the previous
+ *      one has completed.
+ *    - RING_F_MC_HTS_DEQ: Same as RING_F_MP_HTS_ENQ, for the consumers.
+ *   Only one synchronization flag can be given for each side. On RTS and
+ *   HTS rings, only the generic functions (``rte_ring_enqueue*()`` and
+ *   ``rte_ring_dequeue*()``) can be used; the ``rte_ring_mp_*()``,
+ *   ``rte_ring_sp_*()``, ``rte_ring_mc_*()`` and ``rte_ring_sc_*()``
+ *   functions must not be called on the side set to RTS or HTS.
  * @return
  *   On success, the pointer to the new allocated ring. NULL on error with
  *    rte_errno set appropriately. Possible errno values include:
  *    - E_RTE_NO_CONFIG - function could not get pointer to rte_config structure
  *    - E_RTE_SECONDARY - function was called from a secondary process instance
- *    - EINVAL - count provided is not a power of 2
+ *    - EINVAL - count provided is not a power of 2, or conflicting flags
  *    - ENOSPC - the maximum number of memzones has already been allocated
  *    - EEXIST - a memzone with the same name already exists
  *    - ENOMEM - no appropriate memory area found in which to create memzone
@@ -321,6 +468,213 @@ struct rte_ring *rte_ring_create(const char *name, unsigned count,
  */
 int rte_ring_set_water_mark(struct rte_ring *r, unsigned count);
 
+/**
+ * Change the maximum distance between the producer head and tail of a
+ * ring in RTS mode.
+ *
+ * A producer waits before moving the head while the distance is above
+ * this value. A small value limits how far the producers can run ahead
+ * of a preempted one; it is set to size/8 at ring creation.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param v
+ *   The new maximum distance, between 1 and the ring size - 1.
+ * @return
+ *   - 0: Success.
+ *   - -ENOTSUP: The producers of the ring are not in RTS mode.
+ *   - -EINVAL: Invalid value.
+ */
+int rte_ring_set_prod_htd_max(struct rte_ring *r, uint32_t v);
+
+/**
+ * Change the maximum distance between the consumer head and tail of a
+ * ring in RTS mode.
+ *
+ * See rte_ring_set_prod_htd_max().
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param v
+ *   The new maximum distance, between 1 and the ring size - 1.
+ * @return
+ *   - 0: Success.
+ *   - -ENOTSUP: The consumers of the ring are not in RTS mode.
+ *   - -EINVAL: Invalid value.
+ */
+int rte_ring_set_cons_htd_max(struct rte_ring *r, uint32_t v);
+
+/**
+ * Enable the wakeup of sleeping consumers through an eventfd.
+ *
+ * Once an eventfd is registered, a consumer that finds the ring empty
+ * can call rte_ring_notify_arm() and sleep on the file descriptor (with
+ * poll(), epoll or read()). The first producer that publishes objects
+ * after that writes to the eventfd; the next ones do not, until the
+ * consumer arms it again. As long as no consumer is armed, the only cost
+ * for the producers is a memory barrier and the read of a flag after
+ * each enqueue.
+ *
+ * This function must be called before the producers start using the
+ * ring. The file descriptor is owned by the application.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param fd
+ *   The eventfd, as returned by eventfd(2).
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid file descriptor.
+ */
+int rte_ring_notify_register(struct rte_ring *r, int fd);
+
+/**
+ * Disable the wakeup of sleeping consumers.
+ *
+ * This function must be called while no producer uses the ring and no
+ * consumer waits for it; the eventfd can be closed afterwards.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ */
+void rte_ring_notify_unregister(struct rte_ring *r);
+
+/**
+ * Ask to be woken up when objects are enqueued in an empty ring.
+ *
+ * On success, the caller can sleep on the registered eventfd; it will
+ * be written by the next producer. If the ring is not empty, the
+ * request is cancelled and -EAGAIN is returned, so that the objects
+ * are dequeued instead of waiting for them.
+ *
+ * A wakeup may be spurious: after reading the eventfd, the consumer
+ * must dequeue and arm again if the ring is still empty.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   - 0: Success; the caller can sleep on the eventfd.
+ *   - -EAGAIN: The ring is not empty.
+ *   - -ENOTSUP: No eventfd is registered on this ring.
+ */
+int rte_ring_notify_arm(struct rte_ring *r);
+
+/**
+ * Cancel a wakeup request done by rte_ring_notify_arm().
+ *
+ * This avoids a useless write to the eventfd when the consumer was
+ * woken up by another event than this ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ */
+void rte_ring_notify_disarm(struct rte_ring *r);
+
+/**
+ * Wait until the ring is not empty.
+ *
+ * This function arms the wakeup, sleeps on the registered eventfd and
+ * clears it. It returns immediately if the ring is not empty.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param timeout_ms
+ *   The maximum time to sleep in milliseconds, or -1 to wait forever.
+ * @return
+ *   - 0: The ring is not empty, or a wakeup was received.
+ *   - -ETIMEDOUT: The timeout expired.
+ *   - -ENOTSUP: No eventfd is registered on this ring.
+ *   - Another negative errno value if poll() failed.
+ */
+int rte_ring_notify_wait(struct rte_ring *r, int timeout_ms);
+
+/**
+ * Start collecting statistics on a ring.
+ *
+ * Once enabled, every enqueue and dequeue counts its call and whether it
+ * moved fewer objects than requested, or none. One call out of
+ * 2^period_log2 per lcore records the ring occupancy in a histogram, and
+ * the time spent in the ring by one of the objects it enqueues, measured
+ * with the TSC when it is dequeued. The counters are per-lcore, so no
+ * atomic operation is added to the data path; calls from non-EAL threads
+ * are not counted.
+ *
+ * When disabled, the cost is one test per call. This function can be
+ * called at any time; the statistics are reset.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param period_log2
+ *   Log2 of the sampling period, between 0 (every call) and 31.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid sampling period.
+ *   - -ENOMEM: Cannot allocate the statistics.
+ */
+int rte_ring_sample_enable(struct rte_ring *r, unsigned period_log2);
+
+/**
+ * Stop collecting statistics on a ring.
+ *
+ * The statistics collected so far can still be read with
+ * rte_ring_sample_get().
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ */
+void rte_ring_sample_disable(struct rte_ring *r);
+
+/**
+ * Reset the statistics of a ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ */
+void rte_ring_sample_reset(struct rte_ring *r);
+
+/**
+ * Read the statistics of a ring, summed over all lcores.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param stats
+ *   A pointer to a structure that is filled with the statistics.
+ * @return
+ *   - 0: Success.
+ *   - -ENOENT: The statistics were never enabled on this ring.
+ */
+int rte_ring_sample_get(const struct rte_ring *r,
+	struct rte_ring_sample_stats *stats);
+
+/**
+ * @internal Account an enqueue call in the sampling statistics.
+ */
+void __rte_ring_sample_enq(struct rte_ring *r, unsigned req, unsigned n,
+	uint32_t free_entries);
+
+/**
+ * @internal Timestamp the last object of a sampled enqueue, before it is
+ * published.
+ */
+void __rte_ring_sample_stamp(struct rte_ring *r, uint32_t pos);
+
+/**
+ * @internal Account a dequeue call in the sampling statistics.
+ */
+void __rte_ring_sample_deq(struct rte_ring *r, unsigned req, unsigned n,
+	uint32_t entries, uint32_t head);
+
+/**
+ * @internal Wake up the consumer waiting for the ring, if any.
+ *
+ * Called by the producers after publishing objects, when
+ * rte_ring_notify_arm() was called by a consumer.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ */
+void __rte_ring_notify_wake(struct rte_ring *r);
+
 /**
  * Dump the status of the ring to the console.
  *
@@ -384,97 +738,188 @@ void rte_ring_dump(FILE *f, const struct rte_ring *r);
 } while (0)
 
 /**
- * @internal Enqueue several objects on the ring (multi-producers safe).
+ * @internal Move the producer head to reserve room for objects
+ * (RTE_RING_SYNC_MT and RTE_RING_SYNC_ST modes).
  *
- * This function uses a "compare and set" instruction to move the
- * producer index atomically.
+ * In multi-producers mode, this function uses a "compare and set"
+ * instruction to move the producer index atomically.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
+ * @param is_sp
+ *   Non-zero if the caller is the only producer of the ring.
  * @param n
- *   The number of objects to add in the ring from the obj_table.
+ *   A pointer to the number of slots to reserve. In
+ *   RTE_RING_QUEUE_VARIABLE mode, it is updated with the number of
+ *   slots actually reserved.
  * @param behavior
- *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
- *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items a possible from ring
+ *   RTE_RING_QUEUE_FIXED:    Reserve a fixed number of slots
+ *   RTE_RING_QUEUE_VARIABLE: Reserve as many slots as possible
+ * @param old_head
+ *   Filled with the producer head before the move.
+ * @param new_head
+ *   Filled with the producer head after the move.
+ * @param free_entries
+ *   Filled with the number of free entries seen before the move.
  * @return
- *   Depend on the behavior value
- *   if behavior = RTE_RING_QUEUE_FIXED
- *   - 0: Success; objects enqueue.
- *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
- *     high water mark is exceeded.
- *   - -ENOBUFS: Not enough room in the ring to enqueue, no object is enqueued.
- *   if behavior = RTE_RING_QUEUE_VARIABLE
- *   - n: Actual number of objects enqueued.
+ *   - 0: Success; slots reserved.
+ *   - -ENOBUFS: Not enough room in the ring; nothing is reserved.
  */
 static inline int __attribute__((always_inline))
-__rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
-			 unsigned n, enum rte_ring_queue_behavior behavior)
+__rte_ring_mt_move_prod_head(struct rte_ring *r, int is_sp, unsigned *n,
+			     enum rte_ring_queue_behavior behavior,
+			     uint32_t *old_head, uint32_t *new_head,
+			     uint32_t *free_entries)
 {
 	uint32_t prod_head, prod_next;
-	uint32_t cons_tail, free_entries;
-	const unsigned max = n;
+	uint32_t cons_tail, entries;
+	const unsigned max = *n;
+	unsigned cnt;
 	int success;
-	unsigned i, rep = 0;
 	uint32_t mask = r->prod.mask;
-	int ret;
 
-	/* move prod.head atomically */
 	do {
 		/* Reset n to the initial burst count */
-		n = max;
+		cnt = max;
 
 		prod_head = r->prod.head;
 		cons_tail = r->cons.tail;
 		/* The subtraction is done between two unsigned 32bits value
 		 * (the result is always modulo 32 bits even if we have
-		 * prod_head > cons_tail). So 'free_entries' is always between 0
+		 * prod_head > cons_tail). So 'entries' is always between 0
 		 * and size(ring)-1. */
-		free_entries = (mask + cons_tail - prod_head);
+		entries = (mask + cons_tail - prod_head);
 
 		/* check that we have enough room in ring */
-		if (unlikely(n > free_entries)) {
-			if (behavior == RTE_RING_QUEUE_FIXED) {
-				__RING_STAT_ADD(r, enq_fail, n);
+		if (unlikely(cnt > entries)) {
+			/* No free entry available */
+			if (behavior == RTE_RING_QUEUE_FIXED ||
+			    unlikely(entries == 0))
 				return -ENOBUFS;
-			}
-			else {
-				/* No free entry available */
-				if (unlikely(free_entries == 0)) {
-					__RING_STAT_ADD(r, enq_fail, n);
-					return 0;
-				}
-
-				n = free_entries;
-			}
+
+			cnt = entries;
 		}
 
-		prod_next = prod_head + n;
-		success = rte_atomic32_cmpset(&r->prod.head, prod_head,
-					      prod_next);
+		prod_next = prod_head + cnt;
+		if (is_sp) {
+			r->prod.head = prod_next;
+			success = 1;
+		} else
+			success = rte_atomic32_cmpset(&r->prod.head, prod_head,
+						      prod_next);
 	} while (unlikely(success == 0));
 
-	/* write entries in ring */
-	ENQUEUE_PTRS();
-	rte_compiler_barrier();
+	*n = cnt;
+	*old_head = prod_head;
+	*new_head = prod_next;
+	*free_entries = entries;
+	return 0;
+}
 
-	/* if we exceed the watermark */
-	if (unlikely(((mask + 1) - free_entries + n) > r->prod.watermark)) {
-		ret = (behavior == RTE_RING_QUEUE_FIXED) ? -EDQUOT :
-				(int)(n | RTE_RING_QUOT_EXCEED);
-		__RING_STAT_ADD(r, enq_quota, n);
-	}
-	else {
-		ret = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : n;
-		__RING_STAT_ADD(r, enq_success, n);
-	}
+/**
+ * @internal Move the consumer head to claim objects from the ring
+ * (RTE_RING_SYNC_MT and RTE_RING_SYNC_ST modes).
+ *
+ * In multi-consumers mode, this function uses a "compare and set"
+ * instruction to move the consumer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param is_sc
+ *   Non-zero if the caller is the only consumer of the ring.
+ * @param n
+ *   A pointer to the number of objects to claim. In
+ *   RTE_RING_QUEUE_VARIABLE mode, it is updated with the number of
+ *   objects actually claimed.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Claim a fixed number of objects
+ *   RTE_RING_QUEUE_VARIABLE: Claim as many objects as possible
+ * @param old_head
+ *   Filled with the consumer head before the move.
+ * @param new_head
+ *   Filled with the consumer head after the move.
+ * @param entries
+ *   Filled with the number of used entries seen before the move.
+ * @return
+ *   - 0: Success; objects claimed.
+ *   - -ENOENT: Not enough entries in the ring; nothing is claimed.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_mt_move_cons_head(struct rte_ring *r, int is_sc, unsigned *n,
+			     enum rte_ring_queue_behavior behavior,
+			     uint32_t *old_head, uint32_t *new_head,
+			     uint32_t *entries)
+{
+	uint32_t cons_head, prod_tail;
+	uint32_t cons_next, used;
+	const unsigned max = *n;
+	unsigned cnt;
+	int success;
+
+	do {
+		/* Restore n as it may change every loop */
+		cnt = max;
+
+		cons_head = r->cons.head;
+		prod_tail = r->prod.tail;
+		/* The subtraction is done between two unsigned 32bits value
+		 * (the result is always modulo 32 bits even if we have
+		 * cons_head > prod_tail). So 'used' is always between 0
+		 * and size(ring)-1. */
+		used = (prod_tail - cons_head);
+
+		/* Set the actual entries for dequeue */
+		if (cnt > used) {
+			if (behavior == RTE_RING_QUEUE_FIXED ||
+			    unlikely(used == 0))
+				return -ENOENT;
+
+			cnt = used;
+		}
+
+		cons_next = cons_head + cnt;
+		if (is_sc) {
+			r->cons.head = cons_next;
+			success = 1;
+		} else
+			success = rte_atomic32_cmpset(&r->cons.head, cons_head,
+						      cons_next);
+	} while (unlikely(success == 0));
+
+	*n = cnt;
+	*old_head = cons_head;
+	*new_head = cons_next;
+	*entries = used;
+	return 0;
+}
+
+/**
+ * @internal Publish a producer or consumer tail (RTE_RING_SYNC_MT and
+ * RTE_RING_SYNC_ST modes).
+ *
+ * In multi-producers (or multi-consumers) mode, the tail can only move
+ * once the operations that reserved slots before us have completed.
+ *
+ * @param tail
+ *   A pointer to the tail to update.
+ * @param old_val
+ *   The head value at the start of our operation.
+ * @param new_val
+ *   The head value at the end of our operation.
+ * @param single
+ *   Non-zero if the caller is the only producer (or consumer).
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_update_tail(volatile uint32_t *tail, uint32_t old_val,
+		       uint32_t new_val, int single)
+{
+	unsigned rep = 0;
 
 	/*
-	 * If there are other enqueues in progress that preceded us,
-	 * we need to wait for them to complete
+	 * If there are other enqueues/dequeues in progress that preceded
+	 * us, we need to wait for them to complete
 	 */
-	while (unlikely(r->prod.tail != prod_head)) {
+	while (!single && unlikely(*tail != old_val)) {
 		rte_pause();
 
 		/* Set RTE_RING_PAUSE_REP_COUNT to avoid spin too long waiting
@@ -486,12 +931,426 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 			sched_yield();
 		}
 	}
-	r->prod.tail = prod_next;
-	return ret;
+	*tail = new_val;
 }
 
 /**
- * @internal Enqueue several objects on a ring (NOT multi-producers safe).
+ * @internal Move the head of one side of a ring in HTS mode.
+ *
+ * A head can only move when it is equal to the tail, i.e. when no other
+ * operation of the same side is in progress. Head and tail are then
+ * updated with a single 64 bits "compare and set", so that at most one
+ * enqueue (resp. dequeue) is in flight at any time.
+ *
+ * @param ht
+ *   A pointer to the head/tail word of the side to move.
+ * @param other_tail
+ *   A pointer to the tail of the other side of the ring.
+ * @param capacity
+ *   The mask of the ring for the producer side, 0 for the consumer side.
+ * @param n
+ *   A pointer to the number of entries to move. In
+ *   RTE_RING_QUEUE_VARIABLE mode, it is updated with the number of
+ *   entries actually moved.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED or RTE_RING_QUEUE_VARIABLE.
+ * @param old_head
+ *   Filled with the head before the move.
+ * @param new_head
+ *   Filled with the head after the move.
+ * @param entries
+ *   Filled with the number of free (producer) or used (consumer)
+ *   entries seen before the move.
+ * @return
+ *   - 0: Success.
+ *   - -1: Not enough entries; the head is not moved.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_hts_move_head(volatile uint64_t *ht,
+			 const volatile uint32_t *other_tail,
+			 uint32_t capacity, unsigned *n,
+			 enum rte_ring_queue_behavior behavior,
+			 uint32_t *old_head, uint32_t *new_head,
+			 uint32_t *entries)
+{
+	union rte_ring_hts_pos op, np;
+	const unsigned max = *n;
+	unsigned cnt;
+	uint32_t avail;
+
+	do {
+		cnt = max;
+
+		/* wait for the previous operation to complete */
+		op.raw = *ht;
+		while (unlikely(op.pos.head != op.pos.tail)) {
+			rte_pause();
+			op.raw = *ht;
+		}
+
+		avail = capacity + *other_tail - op.pos.head;
+		if (unlikely(cnt > avail)) {
+			if (behavior == RTE_RING_QUEUE_FIXED ||
+			    unlikely(avail == 0))
+				return -1;
+
+			cnt = avail;
+		}
+
+		np.pos.tail = op.pos.tail;
+		np.pos.head = op.pos.head + cnt;
+	} while (unlikely(rte_atomic64_cmpset(ht, op.raw, np.raw) == 0));
+
+	*n = cnt;
+	*old_head = op.pos.head;
+	*new_head = np.pos.head;
+	*entries = avail;
+	return 0;
+}
+
+/**
+ * @internal Move the head of one side of a ring in RTS mode.
+ *
+ * Any number of operations can be in progress at the same time, as long
+ * as the distance between the head and the tail stays below *htd_max*.
+ *
+ * @param head
+ *   A pointer to the RTS head of the side to move.
+ * @param tail
+ *   A pointer to the tail position of the side to move.
+ * @param htd_max
+ *   The maximum head-tail distance of the side to move.
+ * @param other_tail
+ *   A pointer to the tail of the other side of the ring.
+ * @param capacity
+ *   The mask of the ring for the producer side, 0 for the consumer side.
+ * @param n
+ *   A pointer to the number of entries to move. In
+ *   RTE_RING_QUEUE_VARIABLE mode, it is updated with the number of
+ *   entries actually moved.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED or RTE_RING_QUEUE_VARIABLE.
+ * @param old_head
+ *   Filled with the head before the move.
+ * @param new_head
+ *   Filled with the head after the move.
+ * @param entries
+ *   Filled with the number of free (producer) or used (consumer)
+ *   entries seen before the move.
+ * @return
+ *   - 0: Success.
+ *   - -1: Not enough entries; the head is not moved.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_rts_move_head(volatile union rte_ring_rts_poscnt *head,
+			 const volatile uint32_t *tail, uint32_t htd_max,
+			 const volatile uint32_t *other_tail,
+			 uint32_t capacity, unsigned *n,
+			 enum rte_ring_queue_behavior behavior,
+			 uint32_t *old_head, uint32_t *new_head,
+			 uint32_t *entries)
+{
+	union rte_ring_rts_poscnt oh, nh;
+	const unsigned max = *n;
+	unsigned cnt;
+	uint32_t avail;
+
+	do {
+		cnt = max;
+
+		/* wait for the tail to catch up with the head */
+		oh.raw = head->raw;
+		while (unlikely(oh.val.pos - *tail > htd_max)) {
+			rte_pause();
+			oh.raw = head->raw;
+		}
+
+		avail = capacity + *other_tail - oh.val.pos;
+		if (unlikely(cnt > avail)) {
+			if (behavior == RTE_RING_QUEUE_FIXED ||
+			    unlikely(avail == 0))
+				return -1;
+
+			cnt = avail;
+		}
+
+		nh.val.pos = oh.val.pos + cnt;
+		nh.val.cnt = oh.val.cnt + 1;
+	} while (unlikely(rte_atomic64_cmpset(&head->raw, oh.raw,
+					      nh.raw) == 0));
+
+	*n = cnt;
+	*old_head = oh.val.pos;
+	*new_head = nh.val.pos;
+	*entries = avail;
+	return 0;
+}
+
+/**
+ * @internal Publish a tail in RTS mode.
+ *
+ * The tail counter is incremented by every finished operation, but the
+ * tail position only moves when the last operation in progress finishes,
+ * so a thread never waits for the completion of the others.
+ *
+ * @param tail
+ *   A pointer to the tail word (counter and position) of the side.
+ * @param head
+ *   A pointer to the RTS head of the side.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_rts_update_tail(volatile uint64_t *tail,
+			   const volatile union rte_ring_rts_poscnt *head)
+{
+	union rte_ring_rts_poscnt h, ot, nt;
+
+	ot.raw = *tail;
+	do {
+		h.raw = head->raw;
+		nt.raw = ot.raw;
+		if (++nt.val.cnt == h.val.cnt)
+			nt.val.pos = h.val.pos;
+		if (likely(rte_atomic64_cmpset(tail, ot.raw, nt.raw) != 0))
+			break;
+		ot.raw = *tail;
+	} while (1);
+}
+
+/**
+ * @internal Move the producer head to reserve room for objects.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param st
+ *   The producer synchronization mode (enum rte_ring_sync_type).
+ * @param n
+ *   A pointer to the number of slots to reserve. In
+ *   RTE_RING_QUEUE_VARIABLE mode, it is updated with the number of
+ *   slots actually reserved.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Reserve a fixed number of slots
+ *   RTE_RING_QUEUE_VARIABLE: Reserve as many slots as possible
+ * @param old_head
+ *   Filled with the producer head before the move.
+ * @param new_head
+ *   Filled with the producer head after the move.
+ * @param free_entries
+ *   Filled with the number of free entries seen before the move.
+ * @return
+ *   - 0: Success; slots reserved.
+ *   - -ENOBUFS: Not enough room in the ring; nothing is reserved.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_move_prod_head(struct rte_ring *r, unsigned st, unsigned *n,
+			  enum rte_ring_queue_behavior behavior,
+			  uint32_t *old_head, uint32_t *new_head,
+			  uint32_t *free_entries)
+{
+	const unsigned req = *n;
+	int ret;
+
+	switch (st) {
+	case RTE_RING_SYNC_MT_RTS:
+		ret = __rte_ring_rts_move_head(&r->prod.rts_head,
+				&r->prod.tail, r->prod.htd_max, &r->cons.tail,
+				r->prod.mask, n, behavior, old_head, new_head,
+				free_entries);
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		ret = __rte_ring_hts_move_head(&r->prod.raw, &r->cons.tail,
+				r->prod.mask, n, behavior, old_head, new_head,
+				free_entries);
+		break;
+	default:
+		ret = __rte_ring_mt_move_prod_head(r, st == RTE_RING_SYNC_ST,
+				n, behavior, old_head, new_head, free_entries);
+		break;
+	}
+
+	if (unlikely(r->prod.sample != NULL)) {
+		if (ret == 0)
+			__rte_ring_sample_enq(r, req, *n, *free_entries);
+		else
+			__rte_ring_sample_enq(r, req, 0, 0);
+	}
+	return (ret == 0) ? 0 : -ENOBUFS;
+}
+
+/**
+ * @internal Move the consumer head to claim objects from the ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param st
+ *   The consumer synchronization mode (enum rte_ring_sync_type).
+ * @param n
+ *   A pointer to the number of objects to claim. In
+ *   RTE_RING_QUEUE_VARIABLE mode, it is updated with the number of
+ *   objects actually claimed.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Claim a fixed number of objects
+ *   RTE_RING_QUEUE_VARIABLE: Claim as many objects as possible
+ * @param old_head
+ *   Filled with the consumer head before the move.
+ * @param new_head
+ *   Filled with the consumer head after the move.
+ * @param entries
+ *   Filled with the number of used entries seen before the move.
+ * @return
+ *   - 0: Success; objects claimed.
+ *   - -ENOENT: Not enough entries in the ring; nothing is claimed.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_move_cons_head(struct rte_ring *r, unsigned st, unsigned *n,
+			  enum rte_ring_queue_behavior behavior,
+			  uint32_t *old_head, uint32_t *new_head,
+			  uint32_t *entries)
+{
+	const unsigned req = *n;
+	int ret;
+
+	switch (st) {
+	case RTE_RING_SYNC_MT_RTS:
+		ret = __rte_ring_rts_move_head(&r->cons.rts_head,
+				&r->cons.tail, r->cons.htd_max, &r->prod.tail,
+				0, n, behavior, old_head, new_head, entries);
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		ret = __rte_ring_hts_move_head(&r->cons.raw, &r->prod.tail,
+				0, n, behavior, old_head, new_head, entries);
+		break;
+	default:
+		ret = __rte_ring_mt_move_cons_head(r, st == RTE_RING_SYNC_ST,
+				n, behavior, old_head, new_head, entries);
+		break;
+	}
+
+	if (unlikely(r->cons.sample != NULL)) {
+		if (ret == 0)
+			__rte_ring_sample_deq(r, req, *n, *entries, *old_head);
+		else
+			__rte_ring_sample_deq(r, req, 0, 0, 0);
+	}
+	return (ret == 0) ? 0 : -ENOENT;
+}
+
+/**
+ * @internal Wake up a sleeping consumer after the producer tail was
+ * updated, if the eventfd notification is enabled.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_notify_check(struct rte_ring *r)
+{
+	if (likely(r->prod.notify == 0))
+		return;
+
+	/* the tail update must be visible before we read the armed flag,
+	 * which is set by the consumer before it checks the tail */
+	rte_mb();
+	if (unlikely(r->notify.armed != 0))
+		__rte_ring_notify_wake(r);
+}
+
+/**
+ * @internal Publish the producer tail once the objects are written.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param st
+ *   The producer synchronization mode (enum rte_ring_sync_type).
+ * @param old_head
+ *   The producer head at the start of our operation.
+ * @param new_head
+ *   The producer head at the end of our operation.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_update_prod_tail(struct rte_ring *r, unsigned st,
+			    uint32_t old_head, uint32_t new_head)
+{
+	if (unlikely(r->prod.sample != NULL) && new_head != old_head)
+		__rte_ring_sample_stamp(r, new_head - 1);
+
+	switch (st) {
+	case RTE_RING_SYNC_MT_RTS:
+		__rte_ring_rts_update_tail(&r->prod.raw, &r->prod.rts_head);
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		/* we are the only producer in flight */
+		r->prod.tail = new_head;
+		break;
+	default:
+		__rte_ring_update_tail(&r->prod.tail, old_head, new_head,
+				       st == RTE_RING_SYNC_ST);
+	}
+	__rte_ring_notify_check(r);
+}
+
+/**
+ * @internal Publish the consumer tail once the objects are read.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param st
+ *   The consumer synchronization mode (enum rte_ring_sync_type).
+ * @param old_head
+ *   The consumer head at the start of our operation.
+ * @param new_head
+ *   The consumer head at the end of our operation.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_update_cons_tail(struct rte_ring *r, unsigned st,
+			    uint32_t old_head, uint32_t new_head)
+{
+	switch (st) {
+	case RTE_RING_SYNC_MT_RTS:
+		__rte_ring_rts_update_tail(&r->cons.raw, &r->cons.rts_head);
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		/* we are the only consumer in flight */
+		r->cons.tail = new_head;
+		break;
+	default:
+		__rte_ring_update_tail(&r->cons.tail, old_head, new_head,
+				       st == RTE_RING_SYNC_ST);
+	}
+}
+
+/**
+ * @internal Compute the enqueue return value and account statistics,
+ * checking the high water mark.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of objects enqueued.
+ * @param free_entries
+ *   The number of free entries seen when the slots were reserved.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED or RTE_RING_QUEUE_VARIABLE.
+ * @return
+ *   The value to return to the caller of the enqueue function.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_enqueue_ret(struct rte_ring *r, unsigned n, uint32_t free_entries,
+		       enum rte_ring_queue_behavior behavior)
+{
+	/* if we exceed the watermark */
+	if (unlikely(((r->prod.mask + 1) - free_entries + n) >
+		     r->prod.watermark)) {
+		__RING_STAT_ADD(r, enq_quota, n);
+		return (behavior == RTE_RING_QUEUE_FIXED) ? -EDQUOT :
+				(int)(n | RTE_RING_QUOT_EXCEED);
+	}
+
+	__RING_STAT_ADD(r, enq_success, n);
+	return (behavior == RTE_RING_QUEUE_FIXED) ? 0 : (int)n;
+}
+
+/**
+ * @internal Enqueue several objects on the ring.
  *
  * @param r
  *   A pointer to the ring structure.
@@ -502,6 +1361,8 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  * @param behavior
  *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
  *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items a possible from ring
+ * @param st
+ *   The producer synchronization mode (enum rte_ring_sync_type).
  * @return
  *   Depend on the behavior value
  *   if behavior = RTE_RING_QUEUE_FIXED
@@ -513,69 +1374,34 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  *   - n: Actual number of objects enqueued.
  */
 static inline int __attribute__((always_inline))
-__rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
-			 unsigned n, enum rte_ring_queue_behavior behavior)
+__rte_ring_do_enqueue(struct rte_ring *r, void * const *obj_table,
+		      unsigned n, enum rte_ring_queue_behavior behavior,
+		      unsigned st)
 {
-	uint32_t prod_head, cons_tail;
-	uint32_t prod_next, free_entries;
-	unsigned i;
+	uint32_t prod_head, prod_next, free_entries;
 	uint32_t mask = r->prod.mask;
+	unsigned i;
 	int ret;
 
-	prod_head = r->prod.head;
-	cons_tail = r->cons.tail;
-	/* The subtraction is done between two unsigned 32bits value
-	 * (the result is always modulo 32 bits even if we have
-	 * prod_head > cons_tail). So 'free_entries' is always between 0
-	 * and size(ring)-1. */
-	free_entries = mask + cons_tail - prod_head;
-
-	/* check that we have enough room in ring */
-	if (unlikely(n > free_entries)) {
-		if (behavior == RTE_RING_QUEUE_FIXED) {
-			__RING_STAT_ADD(r, enq_fail, n);
-			return -ENOBUFS;
-		}
-		else {
-			/* No free entry available */
-			if (unlikely(free_entries == 0)) {
-				__RING_STAT_ADD(r, enq_fail, n);
-				return 0;
-			}
-
-			n = free_entries;
-		}
+	if (__rte_ring_move_prod_head(r, st, &n, behavior, &prod_head,
+				      &prod_next, &free_entries) != 0) {
+		__RING_STAT_ADD(r, enq_fail, n);
+		return (behavior == RTE_RING_QUEUE_FIXED) ? -ENOBUFS : 0;
 	}
 
-	prod_next = prod_head + n;
-	r->prod.head = prod_next;
-
 	/* write entries in ring */
 	ENQUEUE_PTRS();
 	rte_compiler_barrier();
 
-	/* if we exceed the watermark */
-	if (unlikely(((mask + 1) - free_entries + n) > r->prod.watermark)) {
-		ret = (behavior == RTE_RING_QUEUE_FIXED) ? -EDQUOT :
-			(int)(n | RTE_RING_QUOT_EXCEED);
-		__RING_STAT_ADD(r, enq_quota, n);
-	}
-	else {
-		ret = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : n;
-		__RING_STAT_ADD(r, enq_success, n);
-	}
-
-	r->prod.tail = prod_next;
+	ret = __rte_ring_enqueue_ret(r, n, free_entries, behavior);
+	__rte_ring_update_prod_tail(r, st, prod_head, prod_next);
 	return ret;
 }
 
 /**
- * @internal Dequeue several objects from a ring (multi-consumers safe). When
- * the request objects are more than the available objects, only dequeue the
- * actual number of objects
- *
- * This function uses a "compare and set" instruction to move the
- * consumer index atomically.
+ * @internal Dequeue several objects from the ring. When the request
+ * objects are more than the available objects, only dequeue the actual
+ * number of objects
  *
  * @param r
  *   A pointer to the ring structure.
@@ -586,6 +1412,8 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  * @param behavior
  *   RTE_RING_QUEUE_FIXED:    Dequeue a fixed number of items from a ring
  *   RTE_RING_QUEUE_VARIABLE: Dequeue as many items a possible from ring
+ * @param st
+ *   The consumer synchronization mode (enum rte_ring_sync_type).
  * @return
  *   Depend on the behavior value
  *   if behavior = RTE_RING_QUEUE_FIXED
@@ -595,76 +1423,125 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  *   if behavior = RTE_RING_QUEUE_VARIABLE
  *   - n: Actual number of objects dequeued.
  */
-
 static inline int __attribute__((always_inline))
-__rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
-		 unsigned n, enum rte_ring_queue_behavior behavior)
+__rte_ring_do_dequeue(struct rte_ring *r, void **obj_table,
+		      unsigned n, enum rte_ring_queue_behavior behavior,
+		      unsigned st)
 {
-	uint32_t cons_head, prod_tail;
-	uint32_t cons_next, entries;
-	const unsigned max = n;
-	int success;
-	unsigned i, rep = 0;
+	uint32_t cons_head, cons_next, entries;
 	uint32_t mask = r->prod.mask;
+	unsigned i;
 
-	/* move cons.head atomically */
-	do {
-		/* Restore n as it may change every loop */
-		n = max;
-
-		cons_head = r->cons.head;
-		prod_tail = r->prod.tail;
-		/* The subtraction is done between two unsigned 32bits value
-		 * (the result is always modulo 32 bits even if we have
-		 * cons_head > prod_tail). So 'entries' is always between 0
-		 * and size(ring)-1. */
-		entries = (prod_tail - cons_head);
-
-		/* Set the actual entries for dequeue */
-		if (n > entries) {
-			if (behavior == RTE_RING_QUEUE_FIXED) {
-				__RING_STAT_ADD(r, deq_fail, n);
-				return -ENOENT;
-			}
-			else {
-				if (unlikely(entries == 0)){
-					__RING_STAT_ADD(r, deq_fail, n);
-					return 0;
-				}
-
-				n = entries;
-			}
-		}
-
-		cons_next = cons_head + n;
-		success = rte_atomic32_cmpset(&r->cons.head, cons_head,
-					      cons_next);
-	} while (unlikely(success == 0));
+	if (__rte_ring_move_cons_head(r, st, &n, behavior, &cons_head,
+				      &cons_next, &entries) != 0) {
+		__RING_STAT_ADD(r, deq_fail, n);
+		return (behavior == RTE_RING_QUEUE_FIXED) ? -ENOENT : 0;
+	}
 
 	/* copy in table */
 	DEQUEUE_PTRS();
 	rte_compiler_barrier();
 
-	/*
-	 * If there are other dequeues in progress that preceded us,
-	 * we need to wait for them to complete
-	 */
-	while (unlikely(r->cons.tail != cons_head)) {
-		rte_pause();
-
-		/* Set RTE_RING_PAUSE_REP_COUNT to avoid spin too long waiting
-		 * for other thread finish. It gives pre-empted thread a chance
-		 * to proceed and finish with ring dequeue operation. */
-		if (RTE_RING_PAUSE_REP_COUNT &&
-		    ++rep == RTE_RING_PAUSE_REP_COUNT) {
-			rep = 0;
-			sched_yield();
-		}
-	}
 	__RING_STAT_ADD(r, deq_success, n);
-	r->cons.tail = cons_next;
+	__rte_ring_update_cons_tail(r, st, cons_head, cons_next);
+	return behavior == RTE_RING_QUEUE_FIXED ? 0 : (int)n;
+}
+
+/**
+ * @internal Enqueue several objects on the ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items a possible from ring
+ * @return
+ *   Depend on the behavior value
+ *   if behavior = RTE_RING_QUEUE_FIXED
+ *   - 0: Success; objects enqueue.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no object is enqueued.
+ *   if behavior = RTE_RING_QUEUE_VARIABLE
+ *   - n: Actual number of objects enqueued.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
+			 unsigned n, enum rte_ring_queue_behavior behavior)
+{
+	return __rte_ring_do_enqueue(r, obj_table, n, behavior,
+				     RTE_RING_SYNC_MT);
+}
+
+/**
+ * @internal Enqueue several objects on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items a possible from ring
+ * @return
+ *   Depend on the behavior value
+ *   if behavior = RTE_RING_QUEUE_FIXED
+ *   - 0: Success; objects enqueue.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no object is enqueued.
+ *   if behavior = RTE_RING_QUEUE_VARIABLE
+ *   - n: Actual number of objects enqueued.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
+			 unsigned n, enum rte_ring_queue_behavior behavior)
+{
+	return __rte_ring_do_enqueue(r, obj_table, n, behavior,
+				     RTE_RING_SYNC_ST);
+}
 
-	return behavior == RTE_RING_QUEUE_FIXED ? 0 : n;
+/**
+ * @internal Dequeue several objects from a ring (multi-consumers safe). When
+ * the request objects are more than the available objects, only dequeue the
+ * actual number of objects
+ *
+ * This function uses a "compare and set" instruction to move the
+ * consumer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Dequeue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Dequeue as many items a possible from ring
+ * @return
+ *   Depend on the behavior value
+ *   if behavior = RTE_RING_QUEUE_FIXED
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *     dequeued.
+ *   if behavior = RTE_RING_QUEUE_VARIABLE
+ *   - n: Actual number of objects dequeued.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
+		 unsigned n, enum rte_ring_queue_behavior behavior)
+{
+	return __rte_ring_do_dequeue(r, obj_table, n, behavior,
+				     RTE_RING_SYNC_MT);
 }
 
 /**
@@ -694,44 +1571,8 @@ static inline int __attribute__((always_inline))
 __rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
 		 unsigned n, enum rte_ring_queue_behavior behavior)
 {
-	uint32_t cons_head, prod_tail;
-	uint32_t cons_next, entries;
-	unsigned i;
-	uint32_t mask = r->prod.mask;
-
-	cons_head = r->cons.head;
-	prod_tail = r->prod.tail;
-	/* The subtraction is done between two unsigned 32bits value
-	 * (the result is always modulo 32 bits even if we have
-	 * cons_head > prod_tail). So 'entries' is always between 0
-	 * and size(ring)-1. */
-	entries = prod_tail - cons_head;
-
-	if (n > entries) {
-		if (behavior == RTE_RING_QUEUE_FIXED) {
-			__RING_STAT_ADD(r, deq_fail, n);
-			return -ENOENT;
-		}
-		else {
-			if (unlikely(entries == 0)){
-				__RING_STAT_ADD(r, deq_fail, n);
-				return 0;
-			}
-
-			n = entries;
-		}
-	}
-
-	cons_next = cons_head + n;
-	r->cons.head = cons_next;
-
-	/* copy in table */
-	DEQUEUE_PTRS();
-	rte_compiler_barrier();
-
-	__RING_STAT_ADD(r, deq_success, n);
-	r->cons.tail = cons_next;
-	return behavior == RTE_RING_QUEUE_FIXED ? 0 : n;
+	return __rte_ring_do_dequeue(r, obj_table, n, behavior,
+				     RTE_RING_SYNC_ST);
 }
 
 /**
@@ -784,9 +1625,8 @@ rte_ring_sp_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
 /**
  * Enqueue several objects on a ring.
  *
- * This function calls the multi-producer or the single-producer
- * version depending on the default behavior that was specified at
- * ring creation time (see flags).
+ * This function uses the producer synchronization mode that was
+ * specified at ring creation time (see flags).
  *
  * @param r
  *   A pointer to the ring structure.
@@ -804,10 +1644,8 @@ static inline int __attribute__((always_inline))
 rte_ring_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
 		      unsigned n)
 {
-	if (r->prod.sp_enqueue)
-		return rte_ring_sp_enqueue_bulk(r, obj_table, n);
-	else
-		return rte_ring_mp_enqueue_bulk(r, obj_table, n);
+	return __rte_ring_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED,
+				     r->prod.sync_type);
 }
 
 /**
@@ -854,9 +1692,8 @@ rte_ring_sp_enqueue(struct rte_ring *r, void *obj)
 /**
  * Enqueue one object on a ring.
  *
- * This function calls the multi-producer or the single-producer
- * version, depending on the default behaviour that was specified at
- * ring creation time (see flags).
+ * This function uses the producer synchronization mode that was
+ * specified at ring creation time (see flags).
  *
  * @param r
  *   A pointer to the ring structure.
@@ -871,10 +1708,7 @@ rte_ring_sp_enqueue(struct rte_ring *r, void *obj)
 static inline int __attribute__((always_inline))
 rte_ring_enqueue(struct rte_ring *r, void *obj)
 {
-	if (r->prod.sp_enqueue)
-		return rte_ring_sp_enqueue(r, obj);
-	else
-		return rte_ring_mp_enqueue(r, obj);
+	return rte_ring_enqueue_bulk(r, &obj, 1);
 }
 
 /**
@@ -924,9 +1758,8 @@ rte_ring_sc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
 /**
  * Dequeue several objects from a ring.
  *
- * This function calls the multi-consumers or the single-consumer
- * version, depending on the default behaviour that was specified at
- * ring creation time (see flags).
+ * This function uses the consumer synchronization mode that was
+ * specified at ring creation time (see flags).
  *
  * @param r
  *   A pointer to the ring structure.
@@ -942,10 +1775,8 @@ rte_ring_sc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
 static inline int __attribute__((always_inline))
 rte_ring_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
 {
-	if (r->cons.sc_dequeue)
-		return rte_ring_sc_dequeue_bulk(r, obj_table, n);
-	else
-		return rte_ring_mc_dequeue_bulk(r, obj_table, n);
+	return __rte_ring_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED,
+				     r->cons.sync_type);
 }
 
 /**
@@ -990,9 +1821,8 @@ rte_ring_sc_dequeue(struct rte_ring *r, void **obj_p)
 /**
  * Dequeue one object from a ring.
  *
- * This function calls the multi-consumers or the single-consumer
- * version depending on the default behaviour that was specified at
- * ring creation time (see flags).
+ * This function uses the consumer synchronization mode that was
+ * specified at ring creation time (see flags).
  *
  * @param r
  *   A pointer to the ring structure.
@@ -1006,10 +1836,7 @@ rte_ring_sc_dequeue(struct rte_ring *r, void **obj_p)
 static inline int __attribute__((always_inline))
 rte_ring_dequeue(struct rte_ring *r, void **obj_p)
 {
-	if (r->cons.sc_dequeue)
-		return rte_ring_sc_dequeue(r, obj_p);
-	else
-		return rte_ring_mc_dequeue(r, obj_p);
+	return rte_ring_dequeue_bulk(r, obj_p, 1);
 }
 
 /**
@@ -1142,9 +1969,8 @@ rte_ring_sp_enqueue_burst(struct rte_ring *r, void * const *obj_table,
 /**
  * Enqueue several objects on a ring.
  *
- * This function calls the multi-producer or the single-producer
- * version depending on the default behavior that was specified at
- * ring creation time (see flags).
+ * This function uses the producer synchronization mode that was
+ * specified at ring creation time (see flags).
  *
  * @param r
  *   A pointer to the ring structure.
@@ -1159,10 +1985,8 @@ static inline unsigned __attribute__((always_inline))
 rte_ring_enqueue_burst(struct rte_ring *r, void * const *obj_table,
 		      unsigned n)
 {
-	if (r->prod.sp_enqueue)
-		return rte_ring_sp_enqueue_burst(r, obj_table, n);
-	else
-		return rte_ring_mp_enqueue_burst(r, obj_table, n);
+	return __rte_ring_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE,
+				     r->prod.sync_type);
 }
 
 /**
@@ -1211,9 +2035,8 @@ rte_ring_sc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
 /**
  * Dequeue multiple objects from a ring up to a maximum number.
  *
- * This function calls the multi-consumers or the single-consumer
- * version, depending on the default behaviour that was specified at
- * ring creation time (see flags).
+ * This function uses the consumer synchronization mode that was
+ * specified at ring creation time (see flags).
  *
  * @param r
  *   A pointer to the ring structure.
@@ -1227,10 +2050,8 @@ rte_ring_sc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
 static inline unsigned __attribute__((always_inline))
 rte_ring_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
 {
-	if (r->cons.sc_dequeue)
-		return rte_ring_sc_dequeue_burst(r, obj_table, n);
-	else
-		return rte_ring_mc_dequeue_burst(r, obj_table, n);
+	return __rte_ring_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE,
+				     r->cons.sync_type);
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,795 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_RING_ELEM_H_
+#define _RTE_RING_ELEM_H_
+
+/**
+ * @file
+ * RTE Ring of fixed-size elements
+ *
+ * These functions store objects of a fixed size in the ring, instead of
+ * pointers to the objects. This avoids an allocation and an indirection
+ * per object when small descriptors (for instance a pointer and some
+ * metadata, or a 128-bit token) are passed between cores.
+ *
+ * The element size is given at creation time to rte_ring_create_elem(),
+ * it must be a multiple of 4 bytes. The same size must be passed as the
+ * *esize* argument of every enqueue and dequeue function; it should be
+ * a compile-time constant so that the copy loops are specialized for it.
+ * The copies of 8, 16 and 32 bytes elements are done with wide moves,
+ * the other sizes are copied by 32-bit words.
+ *
+ * A ring created by rte_ring_create() is a ring of elements of
+ * sizeof(void *) bytes, so the functions of this file can be used on it.
+ * On the other hand, the functions of rte_ring.h and rte_ring_zc.h must
+ * only be used on rings whose elements are pointers.
+ *
+ * The synchronization modes (see the flags of rte_ring_create_elem())
+ * apply to rings of elements like to rings of pointers.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+#include <rte_ring.h>
+
+/**
+ * Calculate the memory size needed for a ring of elements.
+ *
+ * This function returns the number of bytes needed for a ring, given
+ * the size of its elements and the number of elements in it. This value
+ * is the sum of the size of the structure rte_ring and the size of the
+ * memory needed by the elements. The value is aligned to a cache line
+ * size.
+ *
+ * @param esize
+ *   The size of a ring element, in bytes. It must be a multiple of 4.
+ * @param count
+ *   The number of elements in the ring (must be a power of 2).
+ * @return
+ *   - The memory size needed for the ring on success.
+ *   - -EINVAL if esize is not a multiple of 4 or count is not a power
+ *     of 2.
+ */
+ssize_t rte_ring_get_memsize_elem(unsigned esize, unsigned count);
+
+/**
+ * Create a new ring of elements named *name* in memory.
+ *
+ * This function behaves like rte_ring_create(), but the ring stores
+ * elements of *esize* bytes instead of pointers. The real usable ring
+ * size is *count-1* elements.
+ *
+ * @param name
+ *   The name of the ring.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be a multiple of 4.
+ * @param count
+ *   The size of the ring (must be a power of 2).
+ * @param socket_id
+ *   The *socket_id* argument is the socket identifier in case of
+ *   NUMA. The value can be *SOCKET_ID_ANY* if there is no NUMA
+ *   constraint for the reserved zone.
+ * @param flags
+ *   The same flags as rte_ring_create().
+ * @return
+ *   On success, the pointer to the new allocated ring. NULL on error with
+ *    rte_errno set appropriately. Possible errno values include:
+ *    - E_RTE_NO_CONFIG - function could not get pointer to rte_config structure
+ *    - E_RTE_SECONDARY - function was called from a secondary process instance
+ *    - EINVAL - esize is not a multiple of 4, count is not a power of 2,
+ *      or conflicting flags
+ *    - ENOSPC - the maximum number of memzones has already been allocated
+ *    - EEXIST - a memzone with the same name already exists
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ */
+struct rte_ring *rte_ring_create_elem(const char *name, unsigned esize,
+	unsigned count, int socket_id, unsigned flags);
+
+/**
+ * @internal Copy a contiguous run of elements.
+ *
+ * The 8, 16 and 32 bytes cases are copied with one move per element,
+ * unrolled like ENQUEUE_PTRS(); other sizes are copied by 32-bit words.
+ *
+ * @param dst
+ *   Destination of the copy.
+ * @param src
+ *   Source of the copy.
+ * @param esize
+ *   The size of an element, a multiple of 4.
+ * @param n
+ *   The number of elements to copy.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_copy_elems(void *dst, const void *src, uint32_t esize, uint32_t n)
+{
+	uint8_t *d = (uint8_t *)dst;
+	const uint8_t *s = (const uint8_t *)src;
+	uint32_t i;
+
+	switch (esize) {
+	case 8:
+		for (i = 0; i < (n & ~0x3U); i += 4) {
+			memcpy(d + i * 8, s + i * 8, 8);
+			memcpy(d + i * 8 + 8, s + i * 8 + 8, 8);
+			memcpy(d + i * 8 + 16, s + i * 8 + 16, 8);
+			memcpy(d + i * 8 + 24, s + i * 8 + 24, 8);
+		}
+		for (; i < n; i++)
+			memcpy(d + i * 8, s + i * 8, 8);
+		break;
+	case 16:
+		for (i = 0; i < (n & ~0x1U); i += 2) {
+			memcpy(d + i * 16, s + i * 16, 16);
+			memcpy(d + i * 16 + 16, s + i * 16 + 16, 16);
+		}
+		if (i < n)
+			memcpy(d + i * 16, s + i * 16, 16);
+		break;
+	case 32:
+		for (i = 0; i < n; i++)
+			memcpy(d + i * 32, s + i * 32, 32);
+		break;
+	default:
+		n *= esize / 4;
+		for (i = 0; i < n; i++)
+			memcpy(d + i * 4, s + i * 4, 4);
+		break;
+	}
+}
+
+/**
+ * @internal Write elements in the ring storage, from the producer head.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_enqueue_elems(struct rte_ring *r, uint32_t prod_head,
+		const void *obj_table, uint32_t esize, uint32_t n)
+{
+	const uint32_t size = r->prod.size;
+	uint32_t idx = prod_head & r->prod.mask;
+	uint8_t *ring = (uint8_t *)&r->ring[0];
+	const uint8_t *obj = (const uint8_t *)obj_table;
+	uint32_t n1;
+
+	if (likely(idx + n <= size)) {
+		__rte_ring_copy_elems(ring + idx * esize, obj, esize, n);
+	} else {
+		n1 = size - idx;
+		__rte_ring_copy_elems(ring + idx * esize, obj, esize, n1);
+		__rte_ring_copy_elems(ring, obj + n1 * esize, esize, n - n1);
+	}
+}
+
+/**
+ * @internal Read elements from the ring storage, from the consumer head.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_dequeue_elems(struct rte_ring *r, uint32_t cons_head,
+		void *obj_table, uint32_t esize, uint32_t n)
+{
+	const uint32_t size = r->prod.size;
+	uint32_t idx = cons_head & r->prod.mask;
+	const uint8_t *ring = (const uint8_t *)&r->ring[0];
+	uint8_t *obj = (uint8_t *)obj_table;
+	uint32_t n1;
+
+	if (likely(idx + n <= size)) {
+		__rte_ring_copy_elems(obj, ring + idx * esize, esize, n);
+	} else {
+		n1 = size - idx;
+		__rte_ring_copy_elems(obj, ring + idx * esize, esize, n1);
+		__rte_ring_copy_elems(obj + n1 * esize, ring, esize, n - n1);
+	}
+}
+
+/**
+ * @internal Enqueue several elements on the ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items a possible from ring
+ * @param st
+ *   The producer synchronization mode (enum rte_ring_sync_type).
+ * @return
+ *   Depend on the behavior value
+ *   if behavior = RTE_RING_QUEUE_FIXED
+ *   - 0: Success; elements enqueued.
+ *   - -EDQUOT: Quota exceeded. The elements have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no element is
+ *     enqueued.
+ *   if behavior = RTE_RING_QUEUE_VARIABLE
+ *   - n: Actual number of elements enqueued.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_do_enqueue_elem(struct rte_ring *r, const void *obj_table,
+			   unsigned esize, unsigned n,
+			   enum rte_ring_queue_behavior behavior, unsigned st)
+{
+	uint32_t prod_head, prod_next, free_entries;
+	unsigned nb = n;
+	int ret;
+
+	if (__rte_ring_move_prod_head(r, st, &nb, behavior, &prod_head,
+				      &prod_next, &free_entries) != 0) {
+		__RING_STAT_ADD(r, enq_fail, nb);
+		return (behavior == RTE_RING_QUEUE_FIXED) ? -ENOBUFS : 0;
+	}
+	if (behavior == RTE_RING_QUEUE_VARIABLE)
+		n = nb;
+
+	__rte_ring_enqueue_elems(r, prod_head, obj_table, esize, n);
+	rte_compiler_barrier();
+
+	ret = __rte_ring_enqueue_ret(r, n, free_entries, behavior);
+	__rte_ring_update_prod_tail(r, st, prod_head, prod_next);
+	return ret;
+}
+
+/**
+ * @internal Dequeue several elements from the ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Dequeue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Dequeue as many items a possible from ring
+ * @param st
+ *   The consumer synchronization mode (enum rte_ring_sync_type).
+ * @return
+ *   Depend on the behavior value
+ *   if behavior = RTE_RING_QUEUE_FIXED
+ *   - 0: Success; elements dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no element is
+ *     dequeued.
+ *   if behavior = RTE_RING_QUEUE_VARIABLE
+ *   - n: Actual number of elements dequeued.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_do_dequeue_elem(struct rte_ring *r, void *obj_table,
+			   unsigned esize, unsigned n,
+			   enum rte_ring_queue_behavior behavior, unsigned st)
+{
+	uint32_t cons_head, cons_next, entries;
+	unsigned nb = n;
+
+	if (__rte_ring_move_cons_head(r, st, &nb, behavior, &cons_head,
+				      &cons_next, &entries) != 0) {
+		__RING_STAT_ADD(r, deq_fail, nb);
+		return (behavior == RTE_RING_QUEUE_FIXED) ? -ENOENT : 0;
+	}
+	if (behavior == RTE_RING_QUEUE_VARIABLE)
+		n = nb;
+
+	__rte_ring_dequeue_elems(r, cons_head, obj_table, esize, n);
+	rte_compiler_barrier();
+
+	__RING_STAT_ADD(r, deq_success, n);
+	__rte_ring_update_cons_tail(r, st, cons_head, cons_next);
+	return behavior == RTE_RING_QUEUE_FIXED ? 0 : (int)n;
+}
+
+/**
+ * Enqueue several elements on the ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; elements enqueued.
+ *   - -EDQUOT: Quota exceeded. The elements have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no element is
+ *     enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+		unsigned esize, unsigned n)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+					  RTE_RING_QUEUE_FIXED, RTE_RING_SYNC_MT);
+}
+
+/**
+ * Enqueue several elements on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; elements enqueued.
+ *   - -EDQUOT: Quota exceeded. The elements have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no element is
+ *     enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sp_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+		unsigned esize, unsigned n)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+					  RTE_RING_QUEUE_FIXED, RTE_RING_SYNC_ST);
+}
+
+/**
+ * Enqueue several elements on a ring.
+ *
+ * This function uses the producer synchronization mode that was
+ * specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; elements enqueued.
+ *   - -EDQUOT: Quota exceeded. The elements have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no element is
+ *     enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+		unsigned esize, unsigned n)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+					  RTE_RING_QUEUE_FIXED, r->prod.sync_type);
+}
+
+/**
+ * Enqueue one element on the ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the element to be added.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @return
+ *   - 0: Success; element enqueued.
+ *   - -EDQUOT: Quota exceeded. The element has been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no element is
+ *     enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_enqueue_elem(struct rte_ring *r, const void *obj, unsigned esize)
+{
+	return rte_ring_mp_enqueue_bulk_elem(r, obj, esize, 1);
+}
+
+/**
+ * Enqueue one element on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the element to be added.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @return
+ *   - 0: Success; element enqueued.
+ *   - -EDQUOT: Quota exceeded. The element has been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no element is
+ *     enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sp_enqueue_elem(struct rte_ring *r, const void *obj, unsigned esize)
+{
+	return rte_ring_sp_enqueue_bulk_elem(r, obj, esize, 1);
+}
+
+/**
+ * Enqueue one element on a ring.
+ *
+ * This function uses the producer synchronization mode that was
+ * specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the element to be added.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @return
+ *   - 0: Success; element enqueued.
+ *   - -EDQUOT: Quota exceeded. The element has been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no element is
+ *     enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue_elem(struct rte_ring *r, const void *obj, unsigned esize)
+{
+	return rte_ring_enqueue_bulk_elem(r, obj, esize, 1);
+}
+
+/**
+ * Dequeue several elements from a ring (multi-consumers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * consumer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @return
+ *   - 0: Success; elements dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no element is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mc_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n)
+{
+	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+					  RTE_RING_QUEUE_FIXED, RTE_RING_SYNC_MT);
+}
+
+/**
+ * Dequeue several elements from a ring (NOT multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @return
+ *   - 0: Success; elements dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no element is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sc_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n)
+{
+	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+					  RTE_RING_QUEUE_FIXED, RTE_RING_SYNC_ST);
+}
+
+/**
+ * Dequeue several elements from a ring.
+ *
+ * This function uses the consumer synchronization mode that was
+ * specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @return
+ *   - 0: Success; elements dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no element is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n)
+{
+	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+					  RTE_RING_QUEUE_FIXED, r->cons.sync_type);
+}
+
+/**
+ * Dequeue one element from a ring (multi-consumers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * consumer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the element that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @return
+ *   - 0: Success; element dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no element is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mc_dequeue_elem(struct rte_ring *r, void *obj, unsigned esize)
+{
+	return rte_ring_mc_dequeue_bulk_elem(r, obj, esize, 1);
+}
+
+/**
+ * Dequeue one element from a ring (NOT multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the element that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @return
+ *   - 0: Success; element dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no element is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sc_dequeue_elem(struct rte_ring *r, void *obj, unsigned esize)
+{
+	return rte_ring_sc_dequeue_bulk_elem(r, obj, esize, 1);
+}
+
+/**
+ * Dequeue one element from a ring.
+ *
+ * This function uses the consumer synchronization mode that was
+ * specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the element that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @return
+ *   - 0: Success; element dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no element is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_dequeue_elem(struct rte_ring *r, void *obj, unsigned esize)
+{
+	return rte_ring_dequeue_bulk_elem(r, obj, esize, 1);
+}
+
+/**
+ * Enqueue several elements on the ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of elements enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mp_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+		unsigned esize, unsigned n)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+					  RTE_RING_QUEUE_VARIABLE, RTE_RING_SYNC_MT);
+}
+
+/**
+ * Enqueue several elements on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of elements enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_sp_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+		unsigned esize, unsigned n)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+					  RTE_RING_QUEUE_VARIABLE, RTE_RING_SYNC_ST);
+}
+
+/**
+ * Enqueue several elements on a ring.
+ *
+ * This function uses the producer synchronization mode that was
+ * specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of elements enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+		unsigned esize, unsigned n)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+					  RTE_RING_QUEUE_VARIABLE, r->prod.sync_type);
+}
+
+/**
+ * Dequeue up to *n* elements from a ring (multi-consumers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * consumer index atomically.
+ *
+ * When the requested elements are more than the available elements,
+ * only dequeue the actual number of elements.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @return
+ *   - n: Actual number of elements dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mc_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n)
+{
+	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+					  RTE_RING_QUEUE_VARIABLE, RTE_RING_SYNC_MT);
+}
+
+/**
+ * Dequeue up to *n* elements from a ring (NOT multi-consumers safe).
+ *
+ * When the requested elements are more than the available elements,
+ * only dequeue the actual number of elements.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @return
+ *   - n: Actual number of elements dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_sc_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n)
+{
+	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+					  RTE_RING_QUEUE_VARIABLE, RTE_RING_SYNC_ST);
+}
+
+/**
+ * Dequeue up to *n* elements from a ring.
+ *
+ * This function uses the consumer synchronization mode that was
+ * specified at ring creation time (see flags).
+ *
+ * When the requested elements are more than the available elements,
+ * only dequeue the actual number of elements.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be the size given to
+ *   rte_ring_create_elem().
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @return
+ *   - n: Actual number of elements dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n)
+{
+	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+					  RTE_RING_QUEUE_VARIABLE, r->cons.sync_type);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_ELEM_H_ */
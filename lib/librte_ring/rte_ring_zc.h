@@ -0,0 +1,658 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_RING_ZC_H_
+#define _RTE_RING_ZC_H_
+
+/**
+ * @file
+ * RTE Ring zero-copy API
+ *
+ * These functions give direct access to the ring storage, so that the
+ * producer can write its objects in place and the consumer can read
+ * them in place, without an intermediate table of pointers.
+ *
+ * An enqueue is split in two phases: *reserve* moves the producer head
+ * and returns pointers to the reserved slots, then *commit* publishes
+ * them to the consumers. In the same way, a dequeue is split in *peek*,
+ * which claims objects and returns pointers to them, and *consume*,
+ * which gives the slots back to the producers.
+ *
+ * The reserved region may wrap at the end of the ring storage, in that
+ * case it is described by two runs of slots (see struct rte_ring_zc_data).
+ *
+ * On multi-producers (resp. multi-consumers) rings, the other producers
+ * (resp. consumers) wait for the commit (resp. consume) of the previous
+ * reservations before they can publish their own. The time between the
+ * two phases must be kept as short as possible. In the default and RTS
+ * modes, the whole region must be committed (resp. consumed). On
+ * single-producer (resp. single-consumer) and HTS rings, the caller may
+ * commit (resp. consume) fewer slots than reserved; a consumer can then
+ * look at the objects at the head of the ring and decide to leave them
+ * there.
+ *
+ * A reservation must be committed (resp. consumed) before any other
+ * enqueue (resp. dequeue) is done by the same thread on the same ring.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rte_ring.h>
+
+/**
+ * A ring region returned by the zero-copy functions.
+ */
+struct rte_ring_zc_data {
+	void **ptr1;         /**< First run of slots. */
+	void **ptr2;         /**< Second run of slots at the start of the ring
+	                          storage, NULL if the region does not wrap. */
+	unsigned n1;         /**< Number of slots in the first run. */
+	unsigned n;          /**< Total number of slots in the region. */
+	uint32_t head;       /**< @internal Head before the reservation. */
+	uint32_t next;       /**< @internal Head after the reservation. */
+	uint32_t entries;    /**< @internal Free (enqueue) or used (dequeue)
+	                          entries seen at reservation time. */
+};
+
+/**
+ * @internal Fill the region descriptor for *n* slots starting at *head*.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_zc_fill(struct rte_ring *r, uint32_t head, unsigned n,
+		   struct rte_ring_zc_data *zcd)
+{
+	const uint32_t size = r->prod.size;
+	uint32_t idx = head & r->prod.mask;
+
+	zcd->ptr1 = &r->ring[idx];
+	zcd->n = n;
+	if (likely(idx + n <= size)) {
+		zcd->n1 = n;
+		zcd->ptr2 = NULL;
+	} else {
+		zcd->n1 = size - idx;
+		zcd->ptr2 = &r->ring[0];
+	}
+}
+
+/**
+ * @internal Reserve slots on the ring for a zero-copy enqueue.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of slots to reserve.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Reserve a fixed number of slots
+ *   RTE_RING_QUEUE_VARIABLE: Reserve as many slots as possible
+ * @param st
+ *   The producer synchronization mode (enum rte_ring_sync_type).
+ * @param zcd
+ *   The region descriptor to fill.
+ * @return
+ *   Depend on the behavior value
+ *   if behavior = RTE_RING_QUEUE_FIXED
+ *   - 0: Success; slots reserved.
+ *   - -ENOBUFS: Not enough room in the ring; nothing is reserved.
+ *   if behavior = RTE_RING_QUEUE_VARIABLE
+ *   - n: Actual number of slots reserved.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_do_enqueue_reserve(struct rte_ring *r, unsigned n,
+			      enum rte_ring_queue_behavior behavior,
+			      unsigned st, struct rte_ring_zc_data *zcd)
+{
+	if (__rte_ring_move_prod_head(r, st, &n, behavior, &zcd->head,
+				      &zcd->next, &zcd->entries) != 0) {
+		__RING_STAT_ADD(r, enq_fail, n);
+		zcd->n = 0;
+		return (behavior == RTE_RING_QUEUE_FIXED) ? -ENOBUFS : 0;
+	}
+
+	__rte_ring_zc_fill(r, zcd->head, n, zcd);
+	return (behavior == RTE_RING_QUEUE_FIXED) ? 0 : (int)n;
+}
+
+/**
+ * @internal Publish the slots filled after a zero-copy reservation.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param zcd
+ *   The region descriptor filled at reservation time.
+ * @param n
+ *   The number of slots to publish.
+ * @param st
+ *   The producer synchronization mode (enum rte_ring_sync_type).
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_do_enqueue_commit(struct rte_ring *r,
+			     const struct rte_ring_zc_data *zcd,
+			     unsigned n, unsigned st)
+{
+	uint32_t prod_next = zcd->next;
+	int ret;
+
+	/* a serialized producer can give back the slots it did not fill */
+	if ((st == RTE_RING_SYNC_ST || st == RTE_RING_SYNC_MT_HTS) &&
+	    n < zcd->n) {
+		prod_next = zcd->head + n;
+		r->prod.head = prod_next;
+	}
+
+	rte_compiler_barrier();
+	ret = __rte_ring_enqueue_ret(r, n, zcd->entries, RTE_RING_QUEUE_FIXED);
+	__rte_ring_update_prod_tail(r, st, zcd->head, prod_next);
+	return ret;
+}
+
+/**
+ * @internal Claim objects from the ring for a zero-copy dequeue.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of objects to claim.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Claim a fixed number of objects
+ *   RTE_RING_QUEUE_VARIABLE: Claim as many objects as possible
+ * @param st
+ *   The consumer synchronization mode (enum rte_ring_sync_type).
+ * @param zcd
+ *   The region descriptor to fill.
+ * @return
+ *   Depend on the behavior value
+ *   if behavior = RTE_RING_QUEUE_FIXED
+ *   - 0: Success; objects claimed.
+ *   - -ENOENT: Not enough entries in the ring; nothing is claimed.
+ *   if behavior = RTE_RING_QUEUE_VARIABLE
+ *   - n: Actual number of objects claimed.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_do_dequeue_peek(struct rte_ring *r, unsigned n,
+			   enum rte_ring_queue_behavior behavior,
+			   unsigned st, struct rte_ring_zc_data *zcd)
+{
+	if (__rte_ring_move_cons_head(r, st, &n, behavior, &zcd->head,
+				      &zcd->next, &zcd->entries) != 0) {
+		__RING_STAT_ADD(r, deq_fail, n);
+		zcd->n = 0;
+		return (behavior == RTE_RING_QUEUE_FIXED) ? -ENOENT : 0;
+	}
+
+	__rte_ring_zc_fill(r, zcd->head, n, zcd);
+	return (behavior == RTE_RING_QUEUE_FIXED) ? 0 : (int)n;
+}
+
+/**
+ * @internal Release the slots read after a zero-copy claim.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param zcd
+ *   The region descriptor filled at claim time.
+ * @param n
+ *   The number of objects to remove from the ring.
+ * @param st
+ *   The consumer synchronization mode (enum rte_ring_sync_type).
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_do_dequeue_consume(struct rte_ring *r,
+			      const struct rte_ring_zc_data *zcd,
+			      unsigned n, unsigned st)
+{
+	uint32_t cons_next = zcd->next;
+
+	/* a serialized consumer can leave the objects it did not use */
+	if ((st == RTE_RING_SYNC_ST || st == RTE_RING_SYNC_MT_HTS) &&
+	    n < zcd->n) {
+		cons_next = zcd->head + n;
+		r->cons.head = cons_next;
+	}
+
+	rte_compiler_barrier();
+	__RING_STAT_ADD(r, deq_success, n);
+	__rte_ring_update_cons_tail(r, st, zcd->head, cons_next);
+}
+
+/**
+ * Reserve several slots on a ring for a zero-copy enqueue
+ * (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of slots to reserve.
+ * @param zcd
+ *   The region descriptor to fill with the reserved slots.
+ * @return
+ *   - 0: Success; slots reserved.
+ *   - -ENOBUFS: Not enough room in the ring; nothing is reserved.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_enqueue_reserve_bulk(struct rte_ring *r, unsigned n,
+				 struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_enqueue_reserve(r, n, RTE_RING_QUEUE_FIXED,
+					     RTE_RING_SYNC_MT, zcd);
+}
+
+/**
+ * Reserve several slots on a ring for a zero-copy enqueue
+ * (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of slots to reserve.
+ * @param zcd
+ *   The region descriptor to fill with the reserved slots.
+ * @return
+ *   - 0: Success; slots reserved.
+ *   - -ENOBUFS: Not enough room in the ring; nothing is reserved.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sp_enqueue_reserve_bulk(struct rte_ring *r, unsigned n,
+				 struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_enqueue_reserve(r, n, RTE_RING_QUEUE_FIXED,
+					     RTE_RING_SYNC_ST, zcd);
+}
+
+/**
+ * Reserve several slots on a ring for a zero-copy enqueue.
+ *
+ * This function uses the producer synchronization mode that was
+ * specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of slots to reserve.
+ * @param zcd
+ *   The region descriptor to fill with the reserved slots.
+ * @return
+ *   - 0: Success; slots reserved.
+ *   - -ENOBUFS: Not enough room in the ring; nothing is reserved.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue_reserve_bulk(struct rte_ring *r, unsigned n,
+			      struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_enqueue_reserve(r, n, RTE_RING_QUEUE_FIXED,
+					     r->prod.sync_type, zcd);
+}
+
+/**
+ * Reserve up to *n* slots on a ring for a zero-copy enqueue
+ * (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The maximum number of slots to reserve.
+ * @param zcd
+ *   The region descriptor to fill with the reserved slots.
+ * @return
+ *   - n: Actual number of slots reserved, 0 if the ring is full.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mp_enqueue_reserve_burst(struct rte_ring *r, unsigned n,
+				  struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_enqueue_reserve(r, n, RTE_RING_QUEUE_VARIABLE,
+					     RTE_RING_SYNC_MT, zcd);
+}
+
+/**
+ * Reserve up to *n* slots on a ring for a zero-copy enqueue
+ * (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The maximum number of slots to reserve.
+ * @param zcd
+ *   The region descriptor to fill with the reserved slots.
+ * @return
+ *   - n: Actual number of slots reserved, 0 if the ring is full.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_sp_enqueue_reserve_burst(struct rte_ring *r, unsigned n,
+				  struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_enqueue_reserve(r, n, RTE_RING_QUEUE_VARIABLE,
+					     RTE_RING_SYNC_ST, zcd);
+}
+
+/**
+ * Reserve up to *n* slots on a ring for a zero-copy enqueue.
+ *
+ * This function uses the producer synchronization mode that was
+ * specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The maximum number of slots to reserve.
+ * @param zcd
+ *   The region descriptor to fill with the reserved slots.
+ * @return
+ *   - n: Actual number of slots reserved, 0 if the ring is full.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_enqueue_reserve_burst(struct rte_ring *r, unsigned n,
+			       struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_enqueue_reserve(r, n, RTE_RING_QUEUE_VARIABLE,
+					     r->prod.sync_type, zcd);
+}
+
+/**
+ * Commit the slots of a zero-copy enqueue (multi-producers safe).
+ *
+ * The objects written in the region returned by the reserve function
+ * become visible to the consumers.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param zcd
+ *   The region descriptor returned by the reserve function. All the
+ *   reserved slots are committed.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_enqueue_commit(struct rte_ring *r,
+			   const struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_enqueue_commit(r, zcd, zcd->n, RTE_RING_SYNC_MT);
+}
+
+/**
+ * Commit the slots of a zero-copy enqueue (NOT multi-producers safe).
+ *
+ * The first *n* objects written in the region returned by the reserve
+ * function become visible to the consumer, the remaining slots are
+ * given back to the ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param zcd
+ *   The region descriptor returned by the reserve function.
+ * @param n
+ *   The number of slots to commit, at most zcd->n.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sp_enqueue_commit(struct rte_ring *r,
+			   const struct rte_ring_zc_data *zcd, unsigned n)
+{
+	return __rte_ring_do_enqueue_commit(r, zcd, n, RTE_RING_SYNC_ST);
+}
+
+/**
+ * Commit the slots of a zero-copy enqueue.
+ *
+ * This function uses the producer synchronization mode that was
+ * specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param zcd
+ *   The region descriptor returned by the reserve function.
+ * @param n
+ *   The number of slots to commit. It must be zcd->n on a
+ *   multi-producers ring in default or RTS mode, and at most zcd->n
+ *   otherwise.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue_commit(struct rte_ring *r,
+			const struct rte_ring_zc_data *zcd, unsigned n)
+{
+	return __rte_ring_do_enqueue_commit(r, zcd, n, r->prod.sync_type);
+}
+
+/**
+ * Claim several objects from a ring for a zero-copy dequeue
+ * (multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of objects to claim.
+ * @param zcd
+ *   The region descriptor to fill with the claimed objects.
+ * @return
+ *   - 0: Success; objects claimed.
+ *   - -ENOENT: Not enough entries in the ring; nothing is claimed.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mc_dequeue_peek_bulk(struct rte_ring *r, unsigned n,
+			      struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_dequeue_peek(r, n, RTE_RING_QUEUE_FIXED,
+					  RTE_RING_SYNC_MT, zcd);
+}
+
+/**
+ * Claim several objects from a ring for a zero-copy dequeue
+ * (NOT multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of objects to claim.
+ * @param zcd
+ *   The region descriptor to fill with the claimed objects.
+ * @return
+ *   - 0: Success; objects claimed.
+ *   - -ENOENT: Not enough entries in the ring; nothing is claimed.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sc_dequeue_peek_bulk(struct rte_ring *r, unsigned n,
+			      struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_dequeue_peek(r, n, RTE_RING_QUEUE_FIXED,
+					  RTE_RING_SYNC_ST, zcd);
+}
+
+/**
+ * Claim several objects from a ring for a zero-copy dequeue.
+ *
+ * This function uses the consumer synchronization mode that was
+ * specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of objects to claim.
+ * @param zcd
+ *   The region descriptor to fill with the claimed objects.
+ * @return
+ *   - 0: Success; objects claimed.
+ *   - -ENOENT: Not enough entries in the ring; nothing is claimed.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_dequeue_peek_bulk(struct rte_ring *r, unsigned n,
+			   struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_dequeue_peek(r, n, RTE_RING_QUEUE_FIXED,
+					  r->cons.sync_type, zcd);
+}
+
+/**
+ * Claim up to *n* objects from a ring for a zero-copy dequeue
+ * (multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The maximum number of objects to claim.
+ * @param zcd
+ *   The region descriptor to fill with the claimed objects.
+ * @return
+ *   - n: Actual number of objects claimed, 0 if the ring is empty.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mc_dequeue_peek_burst(struct rte_ring *r, unsigned n,
+			       struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_dequeue_peek(r, n, RTE_RING_QUEUE_VARIABLE,
+					  RTE_RING_SYNC_MT, zcd);
+}
+
+/**
+ * Claim up to *n* objects from a ring for a zero-copy dequeue
+ * (NOT multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The maximum number of objects to claim.
+ * @param zcd
+ *   The region descriptor to fill with the claimed objects.
+ * @return
+ *   - n: Actual number of objects claimed, 0 if the ring is empty.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_sc_dequeue_peek_burst(struct rte_ring *r, unsigned n,
+			       struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_dequeue_peek(r, n, RTE_RING_QUEUE_VARIABLE,
+					  RTE_RING_SYNC_ST, zcd);
+}
+
+/**
+ * Claim up to *n* objects from a ring for a zero-copy dequeue.
+ *
+ * This function uses the consumer synchronization mode that was
+ * specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The maximum number of objects to claim.
+ * @param zcd
+ *   The region descriptor to fill with the claimed objects.
+ * @return
+ *   - n: Actual number of objects claimed, 0 if the ring is empty.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_dequeue_peek_burst(struct rte_ring *r, unsigned n,
+			    struct rte_ring_zc_data *zcd)
+{
+	return __rte_ring_do_dequeue_peek(r, n, RTE_RING_QUEUE_VARIABLE,
+					  r->cons.sync_type, zcd);
+}
+
+/**
+ * Remove the objects of a zero-copy dequeue from the ring
+ * (multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param zcd
+ *   The region descriptor returned by the peek function. All the
+ *   claimed objects are removed.
+ */
+static inline void __attribute__((always_inline))
+rte_ring_mc_dequeue_consume(struct rte_ring *r,
+			    const struct rte_ring_zc_data *zcd)
+{
+	__rte_ring_do_dequeue_consume(r, zcd, zcd->n, RTE_RING_SYNC_MT);
+}
+
+/**
+ * Remove the objects of a zero-copy dequeue from the ring
+ * (NOT multi-consumers safe).
+ *
+ * The first *n* objects of the region returned by the peek function
+ * are removed, the other ones stay at the head of the ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param zcd
+ *   The region descriptor returned by the peek function.
+ * @param n
+ *   The number of objects to remove, at most zcd->n.
+ */
+static inline void __attribute__((always_inline))
+rte_ring_sc_dequeue_consume(struct rte_ring *r,
+			    const struct rte_ring_zc_data *zcd, unsigned n)
+{
+	__rte_ring_do_dequeue_consume(r, zcd, n, RTE_RING_SYNC_ST);
+}
+
+/**
+ * Remove the objects of a zero-copy dequeue from the ring.
+ *
+ * This function uses the consumer synchronization mode that was
+ * specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param zcd
+ *   The region descriptor returned by the peek function.
+ * @param n
+ *   The number of objects to remove. It must be zcd->n on a
+ *   multi-consumers ring in default or RTS mode, and at most zcd->n
+ *   otherwise.
+ */
+static inline void __attribute__((always_inline))
+rte_ring_dequeue_consume(struct rte_ring *r,
+			 const struct rte_ring_zc_data *zcd, unsigned n)
+{
+	__rte_ring_do_dequeue_consume(r, zcd, n, r->cons.sync_type);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_ZC_H_ */